@@ -0,0 +1,179 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "profiler.hpp"
+
+namespace bench {
+
+/**
+ * @brief Settings shared by every benchmark, set from the command line
+ */
+struct config {
+	size_t rows = 10000;    // Size of generated inventories and containers
+	size_t samples = 20;    // Timed samples per measurement
+	size_t warmup = 1;      // Untimed calls before the samples
+	bool counters = false;  // Read hardware counters with perf_event_open
+	uint64_t seed = 42;     // Seed for all generated data, for reproducibility
+	std::string filter;     // Only run measurements containing this substring
+};
+
+/**
+ * @brief Timing summary of a single measurement
+ *
+ * Every sample runs the measured function once, which performs
+ * @c ops_per_sample operations. Statistics are taken over the per-operation
+ * time of each sample.
+ */
+struct result {
+	std::string name;
+	size_t ops_per_sample;
+	size_t samples;
+
+	double ns_per_op;   // Mean over all samples
+	double ops_per_sec;
+	double min_ns;
+	double p50_ns;
+	double p99_ns;
+	double max_ns;
+	double stddev_ns;
+
+	// Hardware counters per operation, if enabled and available
+	perf_counters counters;
+	double counter_per_op(perf_counters::counter c) const;
+};
+
+/**
+ * @brief Runs measurements and collects their results
+ */
+class runner {
+public:
+	runner(const bench::config& config) : m_config(config) {}
+
+	/**
+	 * @brief Times a function performing @p ops operations per call
+	 *
+	 * The function is called untimed to warm caches, then once per sample.
+	 * Skipped if the name does not match the configured filter.
+	 */
+	template <typename FUNC_T>
+	void measure(const std::string& name, size_t ops, FUNC_T function);
+
+	/**
+	 * @brief Records samples timed by the benchmark itself
+	 *
+	 * For latencies that a whole-function timing would average away, such as
+	 * the occasional slow operation among many fast ones.
+	 *
+	 * @param samples_ns   Time of each sample, each performing @p ops operations
+	 */
+	void record(const std::string& name, size_t ops, const std::vector<double>& samples_ns);
+
+	/**
+	 * @brief Checks if a measurement would be run with the current filter
+	 */
+	bool selected(const std::string& name) const;
+
+	const bench::config& config() const { return m_config; }
+	const std::vector<result>& results() const { return m_results; }
+
+private:
+	void add_result(const std::string& name, size_t ops, const profiler_stats& stats_ms,
+	                const perf_counters& counters);
+
+	bench::config m_config;
+	std::vector<result> m_results;
+};
+
+using benchmark_fn = void (*)(runner&);
+
+/**
+ * @brief All benchmarks registered with @c BENCHMARK, in registration order
+ */
+std::vector<std::pair<std::string, benchmark_fn>>& registry();
+
+struct registration {
+	registration(const char* name, benchmark_fn function) {
+		registry().emplace_back(name, function);
+	}
+};
+
+/**
+ * @brief Defines and registers a benchmark function taking @c runner
+ */
+#define BENCHMARK(NAME) \
+	static void benchmark_##NAME(bench::runner& runner); \
+	static bench::registration NAME##_registration(#NAME, benchmark_##NAME); \
+	static void benchmark_##NAME(bench::runner& runner)
+
+/**
+ * @brief Prevents the compiler from optimizing away a computed value
+ */
+template <typename T>
+inline void do_not_optimize(const T& value) {
+	asm volatile("" : : "g"(&value) : "memory");
+}
+
+/**
+ * @brief Output stream that formats everything and then discards it
+ *
+ * Used to time REPL commands without measuring terminal or pipe I/O.
+ */
+class null_ostream : public std::ostream {
+public:
+	null_ostream() : std::ostream(&m_buffer) {}
+
+private:
+	class null_buffer : public std::streambuf {
+	protected:
+		int overflow(int c) override { return c; }
+		std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+	};
+
+	null_buffer m_buffer;
+};
+
+/**
+ * @brief Writes results as JSON, one result object per line
+ */
+void write_json(std::ostream& out, const config& config, const std::vector<result>& results);
+
+/**
+ * @brief Reads the name and ns/op of each result from JSON written by write_json
+ */
+std::vector<std::pair<std::string, double>> read_baseline(std::istream& in);
+
+/**
+ * @brief Prints the change of each result against a baseline
+ *
+ * @param threshold   Relative slowdown counted as a regression, e.g. 0.1
+ *
+ * @returns The number of regressions found
+ */
+size_t compare_baseline(std::ostream& out, const std::vector<result>& results,
+                        const std::vector<std::pair<std::string, double>>& baseline,
+                        double threshold);
+
+template <typename FUNC_T>
+void runner::measure(const std::string& name, size_t ops, FUNC_T function) {
+	if (!selected(name) || ops == 0) {
+		return;
+	}
+
+	auto prof = make_profiler(function);
+
+	prof.warmup(m_config.warmup)
+	    .iterations(m_config.samples)
+	    .hardware_counters(m_config.counters)
+	    .run();
+
+	add_result(name, ops, prof.realtime_stats(), prof.counters());
+}
+
+} // namespace bench
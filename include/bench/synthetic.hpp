@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+/**
+ * @brief A generated inventory CSV along with keys for querying it
+ */
+struct synthetic_inventory {
+	std::string csv;
+	std::vector<std::string> ids;        // Every inventory id, in row order
+	std::vector<std::string> categories; // Every category name listInventory accepts
+};
+
+/**
+ * @brief Generates an Amazon-style inventory CSV with @p rows products
+ *
+ * Output is fully determined by @p seed.
+ */
+synthetic_inventory make_inventory(size_t rows, uint64_t seed);
+
+/**
+ * @brief Generates a random 32 character hex id, like the dataset's "Uniq Id"
+ */
+std::string random_id(std::mt19937_64& rng);
+
+} // namespace bench
@@ -1,43 +1,51 @@
 #pragma once
 
-#include <fstream>
+#include <memory>
 
 #include "CSVReader.hpp"
+#include "read_ahead.hpp"
 
 namespace CSV {
 
+/**
+ * @brief Reads CSV data from a file, the next blocks read ahead while the
+ * current one is parsed
+ */
 class CSVFileReader : public CSVReader {
 public:
 	CSVFileReader(std::string filename, bool has_header = true) :
 		CSVReader(has_header),
-		filename_(filename),
-		file_(filename) {
+		filename_(filename) {
 
-		if (!file_.is_open()) {
-			throw std::invalid_argument("Failed to open file " + filename);
-		}
+		open();
 	}
 
 	CSVFileReader(std::string filename, bool has_header, const List<CSVValueType>& types) :
 		CSVReader(has_header, types),
-		filename_(filename),
-		file_(filename) {
+		filename_(filename) {
 
-		if (!file_.is_open()) {
-			throw std::invalid_argument("Failed to open file " + filename);
-		}
-	}
-
-	~CSVFileReader() {
-		file_.close();
+		open();
 	}
 
 private:
 	bool eof() const override;
 	std::string readline() override;
 
+	/**
+	 * @brief Opens the file with reads ahead of the parser, see read_ahead
+	 *
+	 * @throws std::invalid_argument if the file can't be opened
+	 */
+	void open();
+
 	std::string filename_;
-	std::ifstream file_;
+	std::unique_ptr<read_ahead> file_;
+
+	// Block of the file lines are read from
+	const char* block_ = nullptr;
+	size_t blockSize_ = 0;
+	size_t blockPos_ = 0;
+	bool eof_ = false;
 };
 
 } // namespace CSV
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <sstream>
+
+#include "CSVReader.hpp"
+
+namespace CSV {
+
+/**
+ * @brief Reads CSV data held in memory
+ */
+class CSVStringReader : public CSVReader {
+public:
+	CSVStringReader(const std::string& data, bool has_header = true) :
+		CSVReader(has_header),
+		stream_(data) {}
+
+	CSVStringReader(const std::string& data, bool has_header, const List<CSVValueType>& types) :
+		CSVReader(has_header, types),
+		stream_(data) {}
+
+private:
+	bool eof() const override;
+	std::string readline() override;
+
+	std::istringstream stream_;
+};
+
+} // namespace CSV
@@ -75,6 +75,7 @@ private:
 
 template <typename T>
 List<T>::List(const List<T>& other) :
+	head_(nullptr),
 	size_(other.size_) {
 	Node** link_ptr = &head_;
 
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 template <typename KEY_T, typename VAL_T>
 class avl_map {
@@ -93,6 +95,25 @@ public:
 	iterator find(const KEY_T& key);
 	const_iterator find(const KEY_T& key) const;
 
+	/**
+	 * @brief Finds many keys at once, overlapping their cache misses
+	 *
+	 * Groups of keys descend the tree together, one level per round, each
+	 * prefetching its next node before the other searches take their step,
+	 * so the misses of a group are in flight together.
+	 *
+	 * @returns An iterator per key, in order, end for keys not found
+	 */
+	std::vector<iterator> find_many(const KEY_T* keys, size_t count);
+	std::vector<const_iterator> find_many(const KEY_T* keys, size_t count) const;
+
+	/**
+	 * @brief Checks many keys at once, like find_many
+	 *
+	 * @returns 1 for each key found, 0 otherwise, in order
+	 */
+	std::vector<uint8_t> contains_many(const KEY_T* keys, size_t count) const;
+
 	/**
 	 * @brief Gets the corresponding value of a key
 	 *
@@ -117,8 +138,18 @@ public:
 	int balance() const { return m_root->get_balance_factor(); }
 
 private:
+	static const size_t lookup_group = 8; // Searches interleaved by find_many
+
 	std::unique_ptr<node> m_root;
 
+	/**
+	 * @brief Searches for every key, interleaved, see find_many
+	 *
+	 * @param fn   Called as fn(index, node) for each key found
+	 */
+	template <typename FN_T>
+	void search_many(const KEY_T* keys, size_t count, FN_T fn) const;
+
 	/*
 	 * @brief Rotate left about the given node
 	 *
@@ -182,7 +213,26 @@ private:
 	public:
 		node(const pair_type& pair) : m_pair(pair) {}
 
-		KEY_T key() const { return m_pair.first; }
+		/**
+		 * @brief Frees the subtree iteratively, leaves first
+		 *
+		 * Letting each node's unique_ptr free its children would recurse
+		 * once per level, freeing a node only once it has no children keeps
+		 * the stack flat however tall the tree is.
+		 */
+		~node();
+
+		/**
+		 * @brief Copies a subtree node for node, keeping its shape and heights
+		 *
+		 * Unlike inserting every pair into a new tree, this needs no searches
+		 * or rotations, and is iterative like the destructor.
+		 *
+		 * @returns The root of the copy, null for an empty subtree
+		 */
+		static std::unique_ptr<node> clone(const node* root);
+
+		const KEY_T& key() const { return m_pair.first; }
 
 		void set_value(const VAL_T& value) { m_pair.second = value; }
 		VAL_T value() const { return m_pair.second; }
@@ -2,19 +2,17 @@
 
 #include "avl_map.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 #include <iostream>
 
+#include "stats.hpp"
 #include "utility.hpp"
 
 // avl_map
 
 template <typename KEY_T, typename VAL_T>
-avl_map<KEY_T, VAL_T>::avl_map(const avl_map<KEY_T, VAL_T>& other) {
-	for (const auto& pair : other) {
-		insert(pair);
-	}
-}
+avl_map<KEY_T, VAL_T>::avl_map(const avl_map<KEY_T, VAL_T>& other) : m_root(node::clone(other.m_root.get())) {}
 
 template <typename KEY_T, typename VAL_T>
 avl_map<KEY_T, VAL_T>& avl_map<KEY_T, VAL_T>::operator=(avl_map<KEY_T, VAL_T> rhs) {
@@ -170,13 +168,17 @@ void avl_map<KEY_T, VAL_T>::clear() {
 template <typename KEY_T, typename VAL_T>
 typename avl_map<KEY_T, VAL_T>::iterator avl_map<KEY_T, VAL_T>::find(const KEY_T& key) {
 	node* cur = m_root.get();
+	size_t depth = 0;
 
 	// Searching for the position iteratively. Recursion is unnecessary due to
 	// storing the node's parent.
 	while (cur != nullptr) {
+		++depth;
+
 		// If we encountered a pari with the same key, return
 		// its iterator and false. Stop early
 		if (cur->key() == key) {
+			PA3_STATS_RECORD(avl_lookup_depth, depth);
 			return iterator(cur);
 		}
 
@@ -187,6 +189,8 @@ typename avl_map<KEY_T, VAL_T>::iterator avl_map<KEY_T, VAL_T>::find(const KEY_T
 		}
 	}
 
+	PA3_STATS_RECORD(avl_lookup_depth, depth);
+
 	// No key found
 	return iterator(nullptr);
 }
@@ -194,13 +198,17 @@ typename avl_map<KEY_T, VAL_T>::iterator avl_map<KEY_T, VAL_T>::find(const KEY_T
 template <typename KEY_T, typename VAL_T>
 typename avl_map<KEY_T, VAL_T>::const_iterator avl_map<KEY_T, VAL_T>::find(const KEY_T& key) const {
 	node* cur = m_root.get();
+	size_t depth = 0;
 
 	// Searching for the position iteratively. Recursion is unnecessary due to
 	// storing the node's parent.
 	while (cur != nullptr) {
+		++depth;
+
 		// If we encountered a pari with the same key, return
 		// its iterator and false. Stop early
 		if (cur->key() == key) {
+			PA3_STATS_RECORD(avl_lookup_depth, depth);
 			return const_iterator(cur);
 		}
 
@@ -211,10 +219,95 @@ typename avl_map<KEY_T, VAL_T>::const_iterator avl_map<KEY_T, VAL_T>::find(const
 		}
 	}
 
+	PA3_STATS_RECORD(avl_lookup_depth, depth);
+
 	// No key found
 	return const_iterator(nullptr);
 }
 
+template <typename KEY_T, typename VAL_T>
+std::vector<typename avl_map<KEY_T, VAL_T>::iterator> avl_map<KEY_T, VAL_T>::find_many(const KEY_T* keys, size_t count) {
+	std::vector<iterator> found(count, end());
+
+	search_many(keys, count, [&](size_t i, const node* match) {
+		found[i] = iterator(const_cast<node*>(match));
+	});
+
+	return found;
+}
+
+template <typename KEY_T, typename VAL_T>
+std::vector<typename avl_map<KEY_T, VAL_T>::const_iterator> avl_map<KEY_T, VAL_T>::find_many(const KEY_T* keys, size_t count) const {
+	std::vector<const_iterator> found(count, end());
+
+	search_many(keys, count, [&](size_t i, const node* match) {
+		found[i] = const_iterator(match);
+	});
+
+	return found;
+}
+
+template <typename KEY_T, typename VAL_T>
+std::vector<uint8_t> avl_map<KEY_T, VAL_T>::contains_many(const KEY_T* keys, size_t count) const {
+	std::vector<uint8_t> found(count, 0);
+
+	search_many(keys, count, [&](size_t i, const node*) {
+		found[i] = 1;
+	});
+
+	return found;
+}
+
+template <typename KEY_T, typename VAL_T>
+template <typename FN_T>
+void avl_map<KEY_T, VAL_T>::search_many(const KEY_T* keys, size_t count, FN_T fn) const {
+	const node* cur[lookup_group];
+	size_t depth[lookup_group];
+
+	for (size_t first = 0; first < count; first += lookup_group) {
+		size_t group = count - first < lookup_group ? count - first : lookup_group;
+		size_t active = group;
+
+		for (size_t j = 0; j < group; ++j) {
+			cur[j] = m_root.get();
+			depth[j] = 0;
+		}
+
+		// Each round moves every search still running one level down
+		while (active > 0) {
+			active = 0;
+
+			for (size_t j = 0; j < group; ++j) {
+				const node* at = cur[j];
+
+				if (at == nullptr) {
+					continue;
+				}
+
+				const KEY_T& key = keys[first + j];
+				++depth[j];
+
+				if (at->key() == key) {
+					PA3_STATS_RECORD(avl_lookup_depth, depth[j]);
+					fn(first + j, at);
+					cur[j] = nullptr;
+					continue;
+				}
+
+				at = (key < at->key()) ? at->left() : at->right();
+				cur[j] = at;
+
+				if (at != nullptr) {
+					prefetch(at);
+					++active;
+				} else {
+					PA3_STATS_RECORD(avl_lookup_depth, depth[j]);
+				}
+			}
+		}
+	}
+}
+
 template <typename KEY_T, typename VAL_T>
 VAL_T& avl_map<KEY_T, VAL_T>::operator[](const KEY_T& key) {
 	iterator it = find(key);
@@ -413,6 +506,65 @@ void avl_map<KEY_T, VAL_T>::propagate_rebalance(node* bottom) {
 
 // avl_map::node
 
+template <typename KEY_T, typename VAL_T>
+avl_map<KEY_T, VAL_T>::node::~node() {
+	node* cur = this;
+
+	while (true) {
+		if (cur->m_left != nullptr) {
+			cur = cur->m_left.get();
+		} else if (cur->m_right != nullptr) {
+			cur = cur->m_right.get();
+		} else if (cur == this) {
+			break;
+		} else {
+			// A leaf, its destructor has nothing left to free
+			node* parent = cur->m_parent;
+			(cur == parent->m_left.get() ? parent->m_left : parent->m_right).reset();
+			cur = parent;
+		}
+	}
+}
+
+template <typename KEY_T, typename VAL_T>
+std::unique_ptr<typename avl_map<KEY_T, VAL_T>::node> avl_map<KEY_T, VAL_T>::node::clone(const node* root) {
+	if (root == nullptr) {
+		return nullptr;
+	}
+
+	std::unique_ptr<node> copy = make_unique<node>(root->m_pair);
+	copy->m_height = root->m_height;
+
+	// Walk both trees together, a missing child in the copy marks a subtree
+	// not copied yet
+	const node* src = root;
+	node* dst = copy.get();
+
+	while (true) {
+		if (src->m_left != nullptr && dst->m_left == nullptr) {
+			dst->m_left = make_unique<node>(src->m_left->m_pair);
+			dst->m_left->m_parent = dst;
+			src = src->m_left.get();
+			dst = dst->m_left.get();
+		} else if (src->m_right != nullptr && dst->m_right == nullptr) {
+			dst->m_right = make_unique<node>(src->m_right->m_pair);
+			dst->m_right->m_parent = dst;
+			src = src->m_right.get();
+			dst = dst->m_right.get();
+		} else if (src == root) {
+			break;
+		} else {
+			src = src->m_parent;
+			dst = dst->m_parent;
+			continue;
+		}
+
+		dst->m_height = src->m_height;
+	}
+
+	return copy;
+}
+
 template <typename KEY_T, typename VAL_T>
 std::unique_ptr<typename avl_map<KEY_T, VAL_T>::node> avl_map<KEY_T, VAL_T>::node::take_left() {
 	if (m_left == nullptr) {
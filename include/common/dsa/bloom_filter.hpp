@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "hash.hpp"
+
+namespace dsa {
+
+/**
+ * @brief Blocked Bloom filter, answering "definitely absent" or "maybe
+ * present" for keys
+ *
+ * Each key sets all of its bits within a single 64 byte block, so a lookup
+ * reads one cache line no matter how many bits are checked. This costs a
+ * slightly higher false positive rate than a classic Bloom filter of the
+ * same size, which the sizing accounts for.
+ *
+ * Inserting more keys than the capacity given to @c reset still works,
+ * but the false positive rate climbs above the target.
+ *
+ * @code
+ * dsa::bloom_filter<std::string, dsa::wyhash> filter(ids.size(), 0.01);
+ * @endcode
+ */
+template <typename KEY_T, typename HASH_F = std::hash<KEY_T>>
+class bloom_filter {
+public:
+	/**
+	 * @param capacity              Number of keys expected
+	 * @param false_positive_rate   Target rate at capacity, in (0, 0.5]
+	 */
+	explicit bloom_filter(size_t capacity = 0, double false_positive_rate = 0.01) { reset(capacity, false_positive_rate); }
+
+	/**
+	 * @brief Empties the filter and resizes it for a new capacity and rate
+	 */
+	void reset(size_t capacity, double false_positive_rate);
+
+	/**
+	 * @brief Empties the filter, keeping its size
+	 */
+	void clear();
+
+	void insert(const KEY_T& key) { insert_hash(HASH_F{}(key)); }
+
+	/**
+	 * @brief Inserts a key by its @c HASH_F hash
+	 */
+	void insert_hash(uint64_t hash);
+
+	/**
+	 * @brief Checks if a key may have been inserted
+	 *
+	 * @returns false if the key was definitely never inserted
+	 */
+	bool contains(const KEY_T& key) const { return contains_hash(HASH_F{}(key)); }
+	bool contains_hash(uint64_t hash) const;
+
+	/**
+	 * @brief Number of keys inserted
+	 */
+	size_t size() const { return m_size; }
+
+	size_t capacity() const { return m_capacity; }
+	double false_positive_rate() const { return m_false_positive_rate; }
+
+	size_t bit_count() const { return m_blocks * block_bits; }
+	size_t hash_count() const { return m_hashes; }
+
+private:
+	static const size_t block_words = 8; // One cache line of 64 bit words
+	static const size_t block_bits = block_words * 64;
+	static const size_t max_hashes = 16;
+
+	// Blocking loses some accuracy as keys are not spread evenly over the
+	// blocks, given back by making the filter this much larger
+	static constexpr double block_overhead = 1.1;
+
+	uint64_t* block(uint64_t hash) { return m_storage.data() + m_offset + fast_range(hash, m_blocks) * block_words; }
+	const uint64_t* block(uint64_t hash) const { return m_storage.data() + m_offset + fast_range(hash, m_blocks) * block_words; }
+
+	/**
+	 * @brief Calls fn(word, mask) for each bit of a key's hash
+	 */
+	template <typename FN_T>
+	void for_each_bit(uint64_t hash, FN_T fn) const;
+
+	size_t m_capacity;
+	double m_false_positive_rate;
+
+	size_t m_size;
+	size_t m_hashes; // Bits set per key
+	size_t m_blocks;
+
+	// Over-allocated so the blocks can start on a cache line boundary
+	std::vector<uint64_t> m_storage;
+	size_t m_offset; // Index of the first block in m_storage
+};
+
+} // namespace dsa
+
+#include "bloom_filter.inl.hpp"
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "bloom_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "stats.hpp"
+
+namespace dsa {
+
+// Bound by reference in std::min, so needs a definition
+template <typename KEY_T, typename HASH_F>
+const size_t bloom_filter<KEY_T, HASH_F>::max_hashes;
+
+template <typename KEY_T, typename HASH_F>
+void bloom_filter<KEY_T, HASH_F>::reset(size_t capacity, double false_positive_rate) {
+	m_capacity = capacity;
+	m_false_positive_rate = std::min(std::max(false_positive_rate, 1e-9), 0.5);
+
+	// Optimal for a classic Bloom filter: -log2(p) hashes, and
+	// -log2(p) / ln(2) bits per key
+	double hashes = -std::log2(m_false_positive_rate);
+	double bits = std::ceil(std::max<size_t>(capacity, 1) * hashes / std::log(2.0) * block_overhead);
+
+	m_hashes = std::min<size_t>(std::max<size_t>(1, std::lround(hashes)), max_hashes);
+	m_blocks = std::max<size_t>(1, std::ceil(bits / block_bits));
+
+	m_storage.assign(m_blocks * block_words + block_words - 1, 0);
+
+	// 64 byte alignment in words, vector storage is at least 8 byte aligned
+	uintptr_t address = reinterpret_cast<uintptr_t>(m_storage.data());
+	m_offset = ((64 - address % 64) % 64) / sizeof(uint64_t);
+
+	m_size = 0;
+}
+
+template <typename KEY_T, typename HASH_F>
+void bloom_filter<KEY_T, HASH_F>::clear() {
+	std::fill(m_storage.begin(), m_storage.end(), 0);
+	m_size = 0;
+}
+
+template <typename KEY_T, typename HASH_F>
+template <typename FN_T>
+void bloom_filter<KEY_T, HASH_F>::for_each_bit(uint64_t hash, FN_T fn) const {
+	// The block comes from the high bits of hash, bit positions from a
+	// second mix, 9 bits each
+	uint64_t bits = mix64(hash ^ 0x9E3779B97F4A7C15ull);
+	size_t available = 7;
+
+	for (size_t i = 0; i < m_hashes; ++i) {
+		if (available == 0) {
+			bits = mix64(bits);
+			available = 7;
+		}
+
+		size_t bit = bits & (block_bits - 1);
+		fn(bit / 64, uint64_t(1) << (bit % 64));
+
+		bits >>= 9;
+		--available;
+	}
+}
+
+template <typename KEY_T, typename HASH_F>
+void bloom_filter<KEY_T, HASH_F>::insert_hash(uint64_t hash) {
+	hash = mix64(hash);
+	uint64_t* words = block(hash);
+
+	for_each_bit(hash, [&](size_t word, uint64_t mask) { words[word] |= mask; });
+
+	++m_size;
+}
+
+template <typename KEY_T, typename HASH_F>
+bool bloom_filter<KEY_T, HASH_F>::contains_hash(uint64_t hash) const {
+	hash = mix64(hash);
+	const uint64_t* words = block(hash);
+
+	// Gather every bit, branching once instead of per bit
+	uint64_t missing = 0;
+
+	for_each_bit(hash, [&](size_t word, uint64_t mask) { missing |= ~words[word] & mask; });
+
+	if (missing != 0) {
+		PA3_STATS_INCREMENT(filter_reject);
+		return false;
+	}
+
+	PA3_STATS_INCREMENT(filter_pass);
+	return true;
+}
+
+} // namespace dsa
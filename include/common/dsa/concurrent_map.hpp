@@ -0,0 +1,221 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "optional.hpp"
+
+namespace dsa {
+
+/**
+ * @brief Hash map allowing lookups from any thread while a single writer
+ * updates it
+ *
+ * Entries are immutable nodes published into atomic buckets, so readers
+ * never lock and never wait on the writer. Updating a value publishes a new
+ * node in place of the old one; erasing leaves a tombstone.
+ *
+ * Growing does not rebuild the table in one call. The writer publishes a
+ * larger table that keeps a pointer to the old one, and every write migrates
+ * a bounded number of old buckets into it. Readers search the old table,
+ * then the new one. A write to a key still in the old table first moves it
+ * to the new table, then tombstones its old bucket, so a reader searching in
+ * that order always sees the key in at least one of them.
+ *
+ * A lookup only repeats if a new table was published while it ran, which
+ * happens once per resize.
+ *
+ * Replaced nodes and tables are freed once all lookups that could still
+ * see them have finished, tracked by per-thread striped reader counts.
+ *
+ * Only one thread may call the writing functions at a time.
+ */
+template <typename KEY_T, typename VAL_T, typename HASH_F = std::hash<KEY_T>>
+class concurrent_map {
+public:
+	using size_type = size_t;
+
+	concurrent_map() : concurrent_map(min_buckets) {}
+	explicit concurrent_map(size_t buckets);
+
+	concurrent_map(const concurrent_map&) = delete;
+	concurrent_map& operator=(const concurrent_map&) = delete;
+
+	~concurrent_map();
+
+	/**
+	 * @brief Gets a copy of the value for a key, safe from any thread
+	 *
+	 * @returns The value, or an empty optional if the key was not found
+	 */
+	optional<VAL_T> find(const KEY_T& key) const;
+
+	/**
+	 * @brief Checks if the given key exists, safe from any thread
+	 */
+	bool contains(const KEY_T& key) const;
+
+	/**
+	 * @brief Inserts a key/value pair, writer only
+	 *
+	 * @returns true if inserted, false if the key already existed
+	 */
+	bool insert(const KEY_T& key, const VAL_T& value);
+
+	/**
+	 * @brief Inserts a pair, or replaces the value of an existing key,
+	 * writer only
+	 *
+	 * @returns true if inserted, false if a value was replaced
+	 */
+	bool insert_or_assign(const KEY_T& key, const VAL_T& value);
+
+	/**
+	 * @brief Erase the pair with matching key, if any, writer only
+	 *
+	 * @returns The number of pairs erased, 0 or 1
+	 */
+	size_type erase(const KEY_T& key);
+
+	/**
+	 * @brief Number of pairs, exact for the writer, approximate for readers
+	 */
+	size_type size() const { return m_size.load(std::memory_order_relaxed); }
+	bool empty() const { return size() == 0; }
+
+	/**
+	 * @brief Bucket count of the newest table
+	 */
+	size_type bucket_count() const { return m_current.load(std::memory_order_acquire)->capacity; }
+
+	/**
+	 * @brief Checks if a resize is still migrating buckets, writer only
+	 */
+	bool migrating() const { return m_current.load(std::memory_order_relaxed)->old.load(std::memory_order_relaxed) != nullptr; }
+
+	/**
+	 * @brief Frees replaced nodes and tables no reader can still reach,
+	 * writer only
+	 *
+	 * Called automatically as writes retire memory. Never blocks; memory
+	 * held by in-progress lookups is freed on a later call.
+	 *
+	 * @returns true if nothing is left waiting to be freed
+	 */
+	bool reclaim();
+
+private:
+	static const size_t min_buckets = 16;
+	static const size_t migrate_batch = 32; // Old buckets moved per write
+	static const size_t reclaim_batch = 64; // Retired nodes before reclaiming
+	static const size_t reader_stripes = 16;
+
+	struct node {
+		node(const KEY_T& key, const VAL_T& value, size_t hash) : key(key), value(value), hash(hash) {}
+
+		const KEY_T key;
+		const VAL_T value;
+		const size_t hash;
+	};
+
+	struct table {
+		explicit table(size_t buckets);
+
+		size_t home(size_t hash) const { return (hash * 0x9E3779B97F4A7C15ull) >> shift; }
+		size_t next(size_t idx) const { return (idx + 1) & (capacity - 1); }
+
+		size_t capacity;
+		int shift;
+		std::unique_ptr<std::atomic<node*>[]> buckets;
+
+		// Table whose buckets are being migrated into this one
+		std::atomic<table*> old;
+
+		// Writer only
+		size_t used = 0;     // Full and tombstone buckets
+		size_t migrated = 0; // Buckets of old already migrated
+	};
+
+	// Reader counts, one cache line each to avoid sharing between threads
+	struct alignas(64) reader_count {
+		std::atomic<size_t> count;
+	};
+
+	struct retired {
+		std::vector<node*> nodes;
+		std::vector<table*> tables;
+
+		bool empty() const { return nodes.empty() && tables.empty(); }
+		void free();
+	};
+
+	/**
+	 * @brief Marks a lookup in progress for its whole scope
+	 */
+	class read_guard {
+	public:
+		read_guard(const concurrent_map& map);
+		~read_guard();
+
+	private:
+		std::atomic<size_t>* m_count;
+	};
+
+	static node* tombstone() {
+		static char marker;
+		return reinterpret_cast<node*>(&marker);
+	}
+	static bool is_node(const node* entry) { return entry != nullptr && entry != tombstone(); }
+
+	/**
+	 * @brief Reader stripe of the calling thread
+	 */
+	static size_t reader_stripe();
+
+	/**
+	 * @brief Finds the node holding key in a table, safe from any thread
+	 */
+	static node* lookup(const table* tbl, const KEY_T& key, size_t hash);
+
+	/**
+	 * @brief Finds the bucket holding key in a table, or capacity if absent
+	 */
+	static size_t locate(const table* tbl, const KEY_T& key, size_t hash);
+
+	/**
+	 * @brief Publishes a node known to be absent into a table
+	 *
+	 * @returns Index of the bucket used
+	 */
+	static size_t place(table* tbl, node* entry);
+
+	/**
+	 * @brief Prepares for a write to key, growing and migrating as needed
+	 *
+	 * @returns Bucket holding key in the current table, or its capacity
+	 */
+	size_t prepare_write(const KEY_T& key, size_t hash);
+
+	void migrate_step(table* tbl, size_t count);
+	void start_resize();
+
+	void retire(node* entry);
+	void retire(table* tbl);
+
+	std::atomic<table*> m_current;
+	std::atomic<size_type> m_size;
+
+	// Lookups in progress, indexed by phase and then reader stripe
+	mutable reader_count m_readers[2][reader_stripes];
+	std::atomic<unsigned> m_phase;
+
+	retired m_retiring; // Retired since the phase last flipped
+	retired m_waiting;  // Waiting for readers of the previous phase to finish
+};
+
+} // namespace dsa
+
+#include "concurrent_map.inl.hpp"
@@ -0,0 +1,384 @@
+#pragma once
+
+#include "concurrent_map.hpp"
+
+#include <algorithm>
+
+namespace dsa {
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+concurrent_map<KEY_T, VAL_T, HASH_F>::table::table(size_t buckets) :
+	capacity(min_buckets),
+	shift(sizeof(size_t) * 8 - 4),
+	old(nullptr) {
+
+	while (capacity < buckets) {
+		capacity <<= 1;
+		--shift;
+	}
+
+	this->buckets.reset(new std::atomic<node*>[capacity]);
+
+	for (size_t i = 0; i < capacity; ++i) {
+		this->buckets[i].store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void concurrent_map<KEY_T, VAL_T, HASH_F>::retired::free() {
+	for (node* entry : nodes) {
+		delete entry;
+	}
+
+	for (table* tbl : tables) {
+		delete tbl;
+	}
+
+	nodes.clear();
+	tables.clear();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+concurrent_map<KEY_T, VAL_T, HASH_F>::read_guard::read_guard(const concurrent_map& map) {
+	size_t stripe = reader_stripe();
+
+	// Counted under a phase the writer has not flipped past yet, otherwise
+	// the writer could miss this lookup when checking that phase
+	while (true) {
+		unsigned phase = map.m_phase.load(std::memory_order_seq_cst);
+		m_count = &map.m_readers[phase & 1][stripe].count;
+
+		m_count->fetch_add(1, std::memory_order_seq_cst);
+
+		if (map.m_phase.load(std::memory_order_seq_cst) == phase) {
+			break;
+		}
+
+		m_count->fetch_sub(1, std::memory_order_release);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+concurrent_map<KEY_T, VAL_T, HASH_F>::read_guard::~read_guard() {
+	m_count->fetch_sub(1, std::memory_order_release);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t concurrent_map<KEY_T, VAL_T, HASH_F>::reader_stripe() {
+	static std::atomic<size_t> next_stripe(0);
+	static thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % reader_stripes;
+
+	return stripe;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+concurrent_map<KEY_T, VAL_T, HASH_F>::concurrent_map(size_t buckets) :
+	m_current(new table(buckets)),
+	m_size(0),
+	m_phase(0) {
+
+	for (auto& phase : m_readers) {
+		for (reader_count& readers : phase) {
+			readers.count.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+concurrent_map<KEY_T, VAL_T, HASH_F>::~concurrent_map() {
+	table* tbl = m_current.load(std::memory_order_relaxed);
+	table* old = tbl->old.load(std::memory_order_relaxed);
+
+	for (size_t i = 0; i < tbl->capacity; ++i) {
+		node* entry = tbl->buckets[i].load(std::memory_order_relaxed);
+
+		if (is_node(entry)) {
+			delete entry;
+		}
+	}
+
+	// Migrated buckets share their nodes with the current table
+	if (old != nullptr) {
+		for (size_t i = tbl->migrated; i < old->capacity; ++i) {
+			node* entry = old->buckets[i].load(std::memory_order_relaxed);
+
+			if (is_node(entry)) {
+				delete entry;
+			}
+		}
+
+		delete old;
+	}
+
+	delete tbl;
+
+	m_retiring.free();
+	m_waiting.free();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename concurrent_map<KEY_T, VAL_T, HASH_F>::node* concurrent_map<KEY_T, VAL_T, HASH_F>::lookup(const table* tbl, const KEY_T& key, size_t hash) {
+	size_t idx = tbl->home(hash);
+
+	while (true) {
+		node* entry = tbl->buckets[idx].load(std::memory_order_acquire);
+
+		if (entry == nullptr) {
+			return nullptr;
+		}
+
+		if (entry != tombstone() && entry->hash == hash && entry->key == key) {
+			return entry;
+		}
+
+		idx = tbl->next(idx);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+optional<VAL_T> concurrent_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) const {
+	size_t hash = HASH_F{}(key);
+
+	read_guard guard(*this);
+	table* tbl = m_current.load(std::memory_order_acquire);
+
+	while (true) {
+		// The old table first: a key moved by the writer is in the new
+		// table before its old bucket is tombstoned
+		table* old = tbl->old.load(std::memory_order_acquire);
+		node* entry = (old != nullptr) ? lookup(old, key, hash) : nullptr;
+
+		if (entry == nullptr) {
+			entry = lookup(tbl, key, hash);
+		}
+
+		if (entry != nullptr) {
+			return optional<VAL_T>(entry->value);
+		}
+
+		// A newer table may have taken over while searching
+		table* current = m_current.load(std::memory_order_acquire);
+
+		if (current == tbl) {
+			return optional<VAL_T>();
+		}
+
+		tbl = current;
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+bool concurrent_map<KEY_T, VAL_T, HASH_F>::contains(const KEY_T& key) const {
+	return find(key).has_value();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t concurrent_map<KEY_T, VAL_T, HASH_F>::locate(const table* tbl, const KEY_T& key, size_t hash) {
+	size_t idx = tbl->home(hash);
+
+	while (true) {
+		node* entry = tbl->buckets[idx].load(std::memory_order_relaxed);
+
+		if (entry == nullptr) {
+			return tbl->capacity;
+		}
+
+		if (entry != tombstone() && entry->hash == hash && entry->key == key) {
+			return idx;
+		}
+
+		idx = tbl->next(idx);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t concurrent_map<KEY_T, VAL_T, HASH_F>::place(table* tbl, node* entry) {
+	size_t idx = tbl->home(entry->hash);
+
+	while (true) {
+		node* resident = tbl->buckets[idx].load(std::memory_order_relaxed);
+
+		if (resident == nullptr || resident == tombstone()) {
+			if (resident == nullptr) {
+				++tbl->used;
+			}
+
+			tbl->buckets[idx].store(entry, std::memory_order_release);
+			return idx;
+		}
+
+		idx = tbl->next(idx);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void concurrent_map<KEY_T, VAL_T, HASH_F>::migrate_step(table* tbl, size_t count) {
+	table* old = tbl->old.load(std::memory_order_relaxed);
+
+	if (old == nullptr) {
+		return;
+	}
+
+	size_t end = tbl->migrated + std::min(count, old->capacity - tbl->migrated);
+
+	// Keys written during the resize were already moved and tombstoned,
+	// so any node left in the old table is absent from the new one
+	for (; tbl->migrated < end; ++tbl->migrated) {
+		node* entry = old->buckets[tbl->migrated].load(std::memory_order_relaxed);
+
+		if (is_node(entry)) {
+			place(tbl, entry);
+		}
+	}
+
+	if (tbl->migrated == old->capacity) {
+		tbl->old.store(nullptr, std::memory_order_release);
+		retire(old);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void concurrent_map<KEY_T, VAL_T, HASH_F>::start_resize() {
+	table* tbl = m_current.load(std::memory_order_relaxed);
+
+	// Only one resize at a time, readers consult at most two tables
+	migrate_step(tbl, SIZE_MAX);
+
+	// Sized so the migration finishes long before the next resize. A table
+	// full of tombstones is rebuilt at the same size.
+	table* larger = new table(std::max(4 * (size() + 1), tbl->capacity));
+	larger->old.store(tbl, std::memory_order_relaxed);
+
+	m_current.store(larger, std::memory_order_release);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t concurrent_map<KEY_T, VAL_T, HASH_F>::prepare_write(const KEY_T& key, size_t hash) {
+	table* tbl = m_current.load(std::memory_order_relaxed);
+
+	if (2 * (tbl->used + 1) > tbl->capacity) {
+		start_resize();
+		tbl = m_current.load(std::memory_order_relaxed);
+	}
+
+	migrate_step(tbl, migrate_batch);
+
+	size_t pos = locate(tbl, key, hash);
+	table* old = tbl->old.load(std::memory_order_relaxed);
+
+	if (old == nullptr) {
+		return pos;
+	}
+
+	size_t old_pos = locate(old, key, hash);
+
+	// Move the key to the new table before removing it from the old one
+	if (old_pos != old->capacity) {
+		if (pos == tbl->capacity) {
+			pos = place(tbl, old->buckets[old_pos].load(std::memory_order_relaxed));
+		}
+
+		old->buckets[old_pos].store(tombstone(), std::memory_order_release);
+	}
+
+	return pos;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+bool concurrent_map<KEY_T, VAL_T, HASH_F>::insert(const KEY_T& key, const VAL_T& value) {
+	size_t hash = HASH_F{}(key);
+	size_t pos = prepare_write(key, hash);
+	table* tbl = m_current.load(std::memory_order_relaxed);
+
+	if (pos != tbl->capacity) {
+		return false;
+	}
+
+	place(tbl, new node(key, value, hash));
+	m_size.fetch_add(1, std::memory_order_relaxed);
+
+	return true;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+bool concurrent_map<KEY_T, VAL_T, HASH_F>::insert_or_assign(const KEY_T& key, const VAL_T& value) {
+	size_t hash = HASH_F{}(key);
+	size_t pos = prepare_write(key, hash);
+	table* tbl = m_current.load(std::memory_order_relaxed);
+
+	if (pos == tbl->capacity) {
+		place(tbl, new node(key, value, hash));
+		m_size.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	node* replaced = tbl->buckets[pos].load(std::memory_order_relaxed);
+	tbl->buckets[pos].store(new node(key, value, hash), std::memory_order_release);
+	retire(replaced);
+
+	return false;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename concurrent_map<KEY_T, VAL_T, HASH_F>::size_type concurrent_map<KEY_T, VAL_T, HASH_F>::erase(const KEY_T& key) {
+	size_t hash = HASH_F{}(key);
+	size_t pos = prepare_write(key, hash);
+	table* tbl = m_current.load(std::memory_order_relaxed);
+
+	if (pos == tbl->capacity) {
+		return 0;
+	}
+
+	node* erased = tbl->buckets[pos].load(std::memory_order_relaxed);
+	tbl->buckets[pos].store(tombstone(), std::memory_order_release);
+	m_size.fetch_sub(1, std::memory_order_relaxed);
+	retire(erased);
+
+	return 1;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void concurrent_map<KEY_T, VAL_T, HASH_F>::retire(node* entry) {
+	m_retiring.nodes.push_back(entry);
+
+	if (m_retiring.nodes.size() >= reclaim_batch) {
+		reclaim();
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void concurrent_map<KEY_T, VAL_T, HASH_F>::retire(table* tbl) {
+	m_retiring.tables.push_back(tbl);
+	reclaim();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+bool concurrent_map<KEY_T, VAL_T, HASH_F>::reclaim() {
+	// Unlinking must be visible before checking for readers
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	// Lookups started after the phase flipped cannot reach anything retired
+	// before it, so waiting memory is free once the old phase has drained
+	if (!m_waiting.empty()) {
+		unsigned previous = (m_phase.load(std::memory_order_relaxed) + 1) & 1;
+
+		for (const reader_count& readers : m_readers[previous]) {
+			if (readers.count.load(std::memory_order_seq_cst) != 0) {
+				return false;
+			}
+		}
+
+		m_waiting.free();
+	}
+
+	if (m_retiring.empty()) {
+		return true;
+	}
+
+	std::swap(m_retiring, m_waiting);
+	m_phase.fetch_add(1, std::memory_order_seq_cst);
+
+	return false;
+}
+
+} // namespace dsa
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "perfect_hash.hpp"
+
+namespace dsa {
+
+/**
+ * @brief Read-only map built once over a fixed set of pairs
+ *
+ * Pairs are stored in a single array, ordered by the slot a minimal
+ * perfect hash gives their key. A lookup hashes the key once, reads one
+ * pilot to get the slot, and compares against the one pair stored there,
+ * with no probing. Each entry keeps its key's hash so misses are usually
+ * rejected without comparing keys.
+ *
+ * Meant for indexes that are built at startup and then only read. It can
+ * be saved to and loaded from a binary stream, skipping the build.
+ *
+ * @code
+ * dsa::frozen_map<std::string, size_t, dsa::wyhash> index(map.begin(), map.end());
+ * @endcode
+ */
+template <typename KEY_T, typename VAL_T, typename HASH_F = std::hash<KEY_T>>
+class frozen_map {
+private:
+	struct entry;
+
+public:
+	using value_type = std::pair<KEY_T, VAL_T>;
+	using size_type = size_t;
+
+	class const_iterator;
+	using iterator = const_iterator;
+
+	frozen_map() {}
+
+	/**
+	 * @brief Builds the map from a range of pairs
+	 *
+	 * @throws std::invalid_argument if a key repeats
+	 */
+	template <typename IT_T>
+	frozen_map(IT_T first, IT_T last) { build(first, last); }
+
+	/**
+	 * @brief Replaces the contents with a range of pairs
+	 *
+	 * @throws std::invalid_argument if a key repeats
+	 */
+	template <typename IT_T>
+	void build(IT_T first, IT_T last);
+
+	/**
+	 * @brief Find an iterator to the given key
+	 *
+	 * @returns Iterator to the matching pair, end if no match was found
+	 */
+	const_iterator find(const KEY_T& key) const;
+
+	bool contains(const KEY_T& key) const { return find(key) != end(); }
+	size_type count(const KEY_T& key) const { return contains(key) ? 1 : 0; }
+
+	/**
+	 * @brief Gets the corresponding value of a key
+	 *
+	 * @throws std::invalid_argument if no matching key was found
+	 */
+	const VAL_T& operator[](const KEY_T& key) const;
+
+	const_iterator begin() const { return const_iterator(m_entries.data()); }
+	const_iterator end() const { return const_iterator(m_entries.data() + m_entries.size()); }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+
+	size_type size() const { return m_entries.size(); }
+	bool empty() const { return m_entries.empty(); }
+
+	/**
+	 * @brief Size of the perfect hash index in bits per key, excluding the
+	 * pairs themselves
+	 */
+	double bits_per_key() const { return m_index.bits_per_key(); }
+
+	/**
+	 * @brief Writes the map to a binary stream, see dsa::serial
+	 *
+	 * Keys and values must be arithmetic types or std::string.
+	 */
+	void save(std::ostream& out) const;
+
+	/**
+	 * @brief Replaces the contents with a map read by @c save
+	 *
+	 * Key hashes are recomputed and checked against the saved index, so
+	 * data saved with a different @c HASH_F is rejected.
+	 *
+	 * @throws std::runtime_error if the data is truncated or inconsistent
+	 */
+	void load(std::istream& in);
+
+	void clear();
+
+	class const_iterator {
+	public:
+		explicit const_iterator(const entry* entry) : m_entry(entry) {}
+
+		const_iterator& operator++() {
+			++m_entry;
+			return *this;
+		}
+
+		const_iterator operator++(int) {
+			const_iterator tmp = *this;
+			++m_entry;
+			return tmp;
+		}
+
+		bool operator==(const const_iterator& other) const { return m_entry == other.m_entry; }
+		bool operator!=(const const_iterator& other) const { return m_entry != other.m_entry; }
+
+		const value_type& operator*() const { return m_entry->pair; }
+		const value_type* operator->() const { return &m_entry->pair; }
+
+	private:
+		const entry* m_entry;
+	};
+
+private:
+	static const uint32_t magic_number = 0x315a5246; // "FRZ1"
+
+	struct entry {
+		entry(uint64_t hash, value_type pair) : hash(hash), pair(std::move(pair)) {}
+
+		uint64_t hash;
+		value_type pair;
+	};
+
+	/**
+	 * @brief Builds the index over entries, then orders them by slot
+	 */
+	void index(std::vector<entry> entries);
+
+	perfect_hash<KEY_T, HASH_F> m_index;
+	std::vector<entry> m_entries; // Indexed by slot
+};
+
+} // namespace dsa
+
+#include "frozen_map.inl.hpp"
@@ -0,0 +1,142 @@
+#pragma once
+
+#include "frozen_map.hpp"
+
+#include <stdexcept>
+
+#include "serialize.hpp"
+
+namespace dsa {
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+template <typename IT_T>
+void frozen_map<KEY_T, VAL_T, HASH_F>::build(IT_T first, IT_T last) {
+	std::vector<entry> entries;
+
+	for (; first != last; ++first) {
+		entries.emplace_back(HASH_F{}(first->first), value_type(first->first, first->second));
+	}
+
+	index(std::move(entries));
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void frozen_map<KEY_T, VAL_T, HASH_F>::index(std::vector<entry> entries) {
+	clear();
+
+	std::vector<uint64_t> hashes;
+	hashes.reserve(entries.size());
+
+	for (const entry& e : entries) {
+		hashes.push_back(e.hash);
+	}
+
+	m_index.build(hashes);
+
+	// Slots are a permutation of the entries
+	std::vector<size_t> order(entries.size());
+
+	for (size_t i = 0; i < entries.size(); ++i) {
+		order[m_index.slot(entries[i].hash)] = i;
+	}
+
+	m_entries.reserve(entries.size());
+
+	for (size_t i : order) {
+		m_entries.push_back(std::move(entries[i]));
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename frozen_map<KEY_T, VAL_T, HASH_F>::const_iterator frozen_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) const {
+	if (m_entries.empty()) {
+		return end();
+	}
+
+	uint64_t hash = HASH_F{}(key);
+	const entry& e = m_entries[m_index.slot(hash)];
+
+	if (e.hash != hash || !(e.pair.first == key)) {
+		return end();
+	}
+
+	return const_iterator(&e);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+const VAL_T& frozen_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) const {
+	const_iterator it = find(key);
+
+	if (it == end()) {
+		throw std::invalid_argument("Key not found in map");
+	}
+
+	return it->second;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void frozen_map<KEY_T, VAL_T, HASH_F>::save(std::ostream& out) const {
+	serial::write(out, static_cast<uint32_t>(magic_number));
+	m_index.save(out);
+
+	serial::write(out, static_cast<uint64_t>(m_entries.size()));
+
+	for (const entry& e : m_entries) {
+		serial::write(out, e.pair.first);
+		serial::write(out, e.pair.second);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void frozen_map<KEY_T, VAL_T, HASH_F>::load(std::istream& in) {
+	clear();
+
+	uint32_t magic;
+	serial::read(in, magic);
+
+	if (magic != magic_number) {
+		throw std::runtime_error("Not a serialized frozen map");
+	}
+
+	// Never leave a partially loaded map behind
+	try {
+		m_index.load(in);
+
+		uint64_t size;
+		serial::read(in, size);
+
+		if (size != m_index.size()) {
+			throw std::runtime_error("Corrupt serialized frozen map");
+		}
+
+		m_entries.reserve(size);
+
+		for (uint64_t i = 0; i < size; ++i) {
+			KEY_T key;
+			VAL_T value;
+
+			serial::read(in, key);
+			serial::read(in, value);
+
+			uint64_t hash = HASH_F{}(key);
+
+			// Entries are saved in slot order
+			if (m_index.slot(hash) != i) {
+				throw std::runtime_error("Corrupt serialized frozen map");
+			}
+
+			m_entries.emplace_back(hash, value_type(std::move(key), std::move(value)));
+		}
+	} catch (...) {
+		clear();
+		throw;
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void frozen_map<KEY_T, VAL_T, HASH_F>::clear() {
+	m_index.clear();
+	m_entries.clear();
+}
+
+} // namespace dsa
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dsa {
+
+/**
+ * @brief Fixed size summary of a key that orders like the key wherever two
+ * summaries differ, letting searches skip reading keys kept out of line
+ *
+ * Keys without one get an empty summary, which never decides.
+ */
+template <typename KEY_T>
+struct key_prefix {
+	struct type {};
+
+	static type of(const KEY_T&) { return type(); }
+	static int compare(const type&, const type&) { return 0; }
+};
+
+/**
+ * @brief A string's first 8 bytes, big endian, so they compare like
+ * std::string does, as unsigned bytes
+ */
+template <>
+struct key_prefix<std::string> {
+	struct type {
+		uint64_t bytes = 0;
+	};
+
+	static type of(const std::string& key) {
+		type prefix;
+
+		for (size_t i = 0; i < 8; ++i) {
+			uint64_t byte = i < key.size() ? static_cast<unsigned char>(key[i]) : 0;
+			prefix.bytes |= byte << (56 - 8 * i);
+		}
+
+		return prefix;
+	}
+
+	static int compare(const type& a, const type& b) { return (a.bytes > b.bytes) - (a.bytes < b.bytes); }
+};
+
+/**
+ * @brief Read-only ordered map built once over a fixed set of pairs
+ *
+ * The pairs are kept in one array sorted by key, which iteration and range
+ * queries walk. Searches use a second array holding the keys in Eytzinger
+ * order, the breadth first layout of a complete binary search tree: the
+ * children of index k are at 2k and 2k + 1, so the tree needs no pointers
+ * and each level's nodes sit next to each other. Every node records the
+ * position of its pair in the sorted array.
+ *
+ * The descent picks a child with a comparison rather than a branch, and
+ * prefetches the nodes a few levels below, which are contiguous, so the
+ * misses of the next levels are in flight while the current one compares.
+ *
+ * Meant for ordered indexes that are built once and then only read, in
+ * place of an avl_map.
+ *
+ * @code
+ * dsa::frozen_ordered_map<std::string, size_t> index(tree.begin(), tree.end());
+ * @endcode
+ */
+template <typename KEY_T, typename VAL_T>
+class frozen_ordered_map {
+public:
+	using value_type = std::pair<KEY_T, VAL_T>;
+	using size_type = size_t;
+
+	using const_iterator = typename std::vector<value_type>::const_iterator;
+	using iterator = const_iterator;
+
+	frozen_ordered_map() {}
+
+	/**
+	 * @brief Builds the map from a range of pairs, see build
+	 */
+	template <typename IT_T>
+	frozen_ordered_map(IT_T first, IT_T last) { build(first, last); }
+
+	/**
+	 * @brief Replaces the contents with a range of pairs
+	 *
+	 * A range that is already sorted by key, such as an avl_map's, is
+	 * taken as is, any other is sorted first.
+	 *
+	 * @throws std::invalid_argument if a key repeats
+	 */
+	template <typename IT_T>
+	void build(IT_T first, IT_T last);
+
+	/**
+	 * @brief Find an iterator to the given key
+	 *
+	 * @returns Iterator to the matching pair, end if no match was found
+	 */
+	const_iterator find(const KEY_T& key) const;
+
+	/**
+	 * @brief Gets the first pair whose key is not less than key
+	 */
+	const_iterator lower_bound(const KEY_T& key) const;
+
+	/**
+	 * @brief Gets the first pair whose key is greater than key
+	 */
+	const_iterator upper_bound(const KEY_T& key) const;
+
+	bool contains(const KEY_T& key) const { return find(key) != end(); }
+	size_type count(const KEY_T& key) const { return contains(key) ? 1 : 0; }
+
+	/**
+	 * @brief Gets the corresponding value of a key
+	 *
+	 * @throws std::invalid_argument if no matching key was found
+	 */
+	const VAL_T& operator[](const KEY_T& key) const;
+
+	const_iterator begin() const { return m_pairs.begin(); }
+	const_iterator end() const { return m_pairs.end(); }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+
+	size_type size() const { return m_pairs.size(); }
+	bool empty() const { return m_pairs.empty(); }
+
+	void clear();
+
+private:
+	using prefix_type = typename key_prefix<KEY_T>::type;
+
+	// Derives from the prefix so an empty one takes no space
+	struct node : prefix_type {
+		KEY_T key;
+		size_t rank = 0; // Position of the key's pair in m_pairs
+	};
+
+	/**
+	 * @brief Levels below the current node that are prefetched, as many as
+	 * keep the prefetched nodes within a few cache lines
+	 */
+	static const int prefetch_levels = sizeof(node) <= 16 ? 4 : sizeof(node) <= 64 ? 3 : 2;
+	static const size_t prefetch_span = sizeof(node) << prefetch_levels; // Bytes
+
+	/**
+	 * @brief Lays the sorted keys out in Eytzinger order
+	 */
+	void layout();
+
+	/**
+	 * @brief Climbs from an index past the end of a descent to the last node
+	 * it went left at, 0 if none
+	 */
+	static size_t last_left(size_t k);
+
+	/**
+	 * @brief Compares a node's key with a key, by their prefixes where they
+	 * differ
+	 *
+	 * @returns Negative, zero or positive as the node's key is less than,
+	 * equal to or greater than key
+	 */
+	static int compare(const node& n, const KEY_T& key, const prefix_type& prefix);
+
+	/**
+	 * @brief Descends the tree, going right past nodes less than key, or
+	 * also past those equal to it for UPPER
+	 *
+	 * @returns Position in m_pairs of the last node the descent went left
+	 * at, size() if it never did
+	 */
+	template <bool UPPER>
+	size_t descend(const KEY_T& key) const;
+
+	std::vector<value_type> m_pairs; // Sorted by key
+	std::vector<node> m_nodes;       // Eytzinger order, the root at 1
+};
+
+} // namespace dsa
+
+#include "frozen_ordered_map.inl.hpp"
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "frozen_ordered_map.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "utility.hpp"
+
+namespace dsa {
+
+template <typename KEY_T, typename VAL_T>
+template <typename IT_T>
+void frozen_ordered_map<KEY_T, VAL_T>::build(IT_T first, IT_T last) {
+	clear();
+
+	for (; first != last; ++first) {
+		m_pairs.emplace_back(first->first, first->second);
+	}
+
+	auto by_key = [](const value_type& a, const value_type& b) { return a.first < b.first; };
+
+	if (!std::is_sorted(m_pairs.begin(), m_pairs.end(), by_key)) {
+		std::stable_sort(m_pairs.begin(), m_pairs.end(), by_key);
+	}
+
+	for (size_t i = 1; i < m_pairs.size(); ++i) {
+		if (!(m_pairs[i - 1].first < m_pairs[i].first)) {
+			clear();
+			throw std::invalid_argument("Duplicate key in frozen map");
+		}
+	}
+
+	layout();
+}
+
+template <typename KEY_T, typename VAL_T>
+void frozen_ordered_map<KEY_T, VAL_T>::layout() {
+	const size_t n = m_pairs.size();
+
+	if (n == 0) {
+		return;
+	}
+
+	m_nodes.resize(n + 1);
+
+	// Visit the tree in order, starting at its leftmost node
+	size_t k = 1;
+
+	while (2 * k <= n) {
+		k *= 2;
+	}
+
+	for (size_t rank = 0; rank < n; ++rank) {
+		m_nodes[k].rank = rank;
+
+		// Next is the leftmost node of the right subtree, or else the
+		// ancestor whose left subtree this ends
+		if (2 * k + 1 <= n) {
+			k = 2 * k + 1;
+
+			while (2 * k <= n) {
+				k *= 2;
+			}
+		} else {
+			k = last_left(k);
+		}
+	}
+
+	// Copied in tree order so the contents of keys kept out of line, such
+	// as long strings, are allocated level by level too
+	for (k = 1; k <= n; ++k) {
+		const KEY_T& key = m_pairs[m_nodes[k].rank].first;
+
+		static_cast<prefix_type&>(m_nodes[k]) = key_prefix<KEY_T>::of(key);
+		m_nodes[k].key = key;
+	}
+}
+
+template <typename KEY_T, typename VAL_T>
+size_t frozen_ordered_map<KEY_T, VAL_T>::last_left(size_t k) {
+	// The low one bits are the steps right since the last step left
+#if defined(__GNUC__)
+	return k >> (__builtin_ctzll(~static_cast<unsigned long long>(k)) + 1);
+#else
+	while (k & 1) {
+		k >>= 1;
+	}
+
+	return k >> 1;
+#endif
+}
+
+template <typename KEY_T, typename VAL_T>
+int frozen_ordered_map<KEY_T, VAL_T>::compare(const node& n, const KEY_T& key, const prefix_type& prefix) {
+	int order = key_prefix<KEY_T>::compare(n, prefix);
+
+	if (order != 0) {
+		return order;
+	}
+
+	return n.key < key ? -1 : key < n.key ? 1 : 0;
+}
+
+template <typename KEY_T, typename VAL_T>
+template <bool UPPER>
+size_t frozen_ordered_map<KEY_T, VAL_T>::descend(const KEY_T& key) const {
+	const size_t n = m_pairs.size();
+	const node* nodes = m_nodes.data();
+	const prefix_type prefix = key_prefix<KEY_T>::of(key);
+	size_t k = 1;
+
+	while (k <= n) {
+		// The nodes prefetch_levels below are contiguous
+		const char* below = reinterpret_cast<const char*>(nodes + std::min(k << prefetch_levels, n));
+
+		for (size_t line = 0; line < prefetch_span; line += 64) {
+			prefetch(below + line);
+		}
+
+		int order = compare(nodes[k], key, prefix);
+		k = 2 * k + (UPPER ? order <= 0 : order < 0);
+	}
+
+	k = last_left(k);
+
+	return k == 0 ? n : nodes[k].rank;
+}
+
+template <typename KEY_T, typename VAL_T>
+typename frozen_ordered_map<KEY_T, VAL_T>::const_iterator
+frozen_ordered_map<KEY_T, VAL_T>::lower_bound(const KEY_T& key) const {
+	return begin() + descend<false>(key);
+}
+
+template <typename KEY_T, typename VAL_T>
+typename frozen_ordered_map<KEY_T, VAL_T>::const_iterator
+frozen_ordered_map<KEY_T, VAL_T>::upper_bound(const KEY_T& key) const {
+	return begin() + descend<true>(key);
+}
+
+template <typename KEY_T, typename VAL_T>
+typename frozen_ordered_map<KEY_T, VAL_T>::const_iterator
+frozen_ordered_map<KEY_T, VAL_T>::find(const KEY_T& key) const {
+	const_iterator it = lower_bound(key);
+
+	if (it == end() || key < it->first) {
+		return end();
+	}
+
+	return it;
+}
+
+template <typename KEY_T, typename VAL_T>
+const VAL_T& frozen_ordered_map<KEY_T, VAL_T>::operator[](const KEY_T& key) const {
+	const_iterator it = find(key);
+
+	if (it == end()) {
+		throw std::invalid_argument("Key not found in map");
+	}
+
+	return it->second;
+}
+
+template <typename KEY_T, typename VAL_T>
+void frozen_ordered_map<KEY_T, VAL_T>::clear() {
+	m_pairs.clear();
+	m_nodes.clear();
+}
+
+} // namespace dsa
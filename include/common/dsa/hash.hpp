@@ -0,0 +1,149 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace dsa {
+
+/**
+ * @brief Bijective 64 bit mixer, the splitmix64 finalizer
+ *
+ * Derives independent looking hashes from one key hash, e.g. with a seed
+ * xored in first.
+ */
+inline uint64_t mix64(uint64_t x) {
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ull;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebull;
+	x ^= x >> 31;
+	return x;
+}
+
+/**
+ * @brief Maps a hash uniformly onto [0, range) with a multiply instead of
+ * a division, using the hash's high bits
+ */
+inline uint64_t fast_range(uint64_t hash, uint64_t range) {
+	return static_cast<uint64_t>((static_cast<__uint128_t>(hash) * range) >> 64);
+}
+
+/**
+ * @brief Fast, high quality hash for strings, usable as a map's @c HASH_F
+ *
+ * Follows the construction of wyhash: the key is read 8 or 16 bytes at a
+ * time and folded with 64x64->128 bit multiplies. Short keys like our ids
+ * take a handful of multiplies instead of a byte-at-a-time loop.
+ *
+ * Hashes are stable for a given seed, but are not guaranteed to match other
+ * wyhash implementations, do not persist them across versions.
+ *
+ * @code
+ * dsa::unordered_map<std::string, size_t, dsa::wyhash> index;
+ * @endcode
+ */
+struct wyhash {
+	size_t operator()(const std::string& key) const { return hash_bytes(key.data(), key.size()); }
+	size_t operator()(const char* key) const { return hash_bytes(key, std::strlen(key)); }
+
+	static uint64_t hash_bytes(const void* data, size_t length, uint64_t seed = 0);
+
+private:
+	// Odd constants with balanced bits, per wyhash
+	static constexpr uint64_t secret(size_t i) {
+		return i == 0 ? 0x2d358dccaa6c78a5ull
+		     : i == 1 ? 0x8bb84b93962eacc9ull
+		     : i == 2 ? 0x4b33a62ed433d4a3ull
+		     : 0x4d5a2da51de1aa47ull;
+	}
+
+	static uint64_t mix(uint64_t a, uint64_t b) {
+		__uint128_t product = static_cast<__uint128_t>(a) * b;
+		return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+	}
+
+	static void multiply(uint64_t& a, uint64_t& b) {
+		__uint128_t product = static_cast<__uint128_t>(a) * b;
+		a = static_cast<uint64_t>(product);
+		b = static_cast<uint64_t>(product >> 64);
+	}
+
+	// Unaligned little-endian reads
+	static uint64_t read8(const uint8_t* p) {
+		uint64_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	static uint64_t read4(const uint8_t* p) {
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	// 1 to 3 bytes, reading the first, middle and last
+	static uint64_t read3(const uint8_t* p, size_t length) {
+		return (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[length >> 1]) << 8) | p[length - 1];
+	}
+};
+
+inline uint64_t wyhash::hash_bytes(const void* data, size_t length, uint64_t seed) {
+	const uint8_t* p = static_cast<const uint8_t*>(data);
+	seed ^= mix(seed ^ secret(0), secret(1));
+
+	uint64_t a;
+	uint64_t b;
+
+	if (length <= 16) {
+		if (length >= 4) {
+			// Two overlapping pairs of 4 byte reads cover 4 to 16 bytes
+			size_t offset = (length >> 3) << 2;
+			a = (read4(p) << 32) | read4(p + offset);
+			b = (read4(p + length - 4) << 32) | read4(p + length - 4 - offset);
+		} else if (length > 0) {
+			a = read3(p, length);
+			b = 0;
+		} else {
+			a = 0;
+			b = 0;
+		}
+	} else {
+		size_t remaining = length;
+
+		// Three independent lanes for long keys
+		if (remaining >= 48) {
+			uint64_t seed1 = seed;
+			uint64_t seed2 = seed;
+
+			do {
+				seed = mix(read8(p) ^ secret(1), read8(p + 8) ^ seed);
+				seed1 = mix(read8(p + 16) ^ secret(2), read8(p + 24) ^ seed1);
+				seed2 = mix(read8(p + 32) ^ secret(3), read8(p + 40) ^ seed2);
+				p += 48;
+				remaining -= 48;
+			} while (remaining >= 48);
+
+			seed ^= seed1 ^ seed2;
+		}
+
+		while (remaining > 16) {
+			seed = mix(read8(p) ^ secret(1), read8(p + 8) ^ seed);
+			p += 16;
+			remaining -= 16;
+		}
+
+		// The last 16 bytes, overlapping already mixed ones if needed
+		a = read8(p + remaining - 16);
+		b = read8(p + remaining - 8);
+	}
+
+	a ^= secret(1);
+	b ^= seed;
+	multiply(a, b);
+
+	return mix(a ^ secret(0) ^ length, b ^ secret(1));
+}
+
+} // namespace dsa
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <vector>
+
+namespace dsa {
+
+/**
+ * @brief Minimal perfect hash function over a fixed set of keys
+ *
+ * Maps each of the n keys it was built from to a distinct slot in
+ * [0, n). Keys outside the set map to an arbitrary slot, so callers must
+ * compare against the key stored there.
+ *
+ * Built in the style of PTHash: keys are split into small buckets, and
+ * each bucket gets a 16 bit pilot chosen so that all of its keys land in
+ * free slots of a table slightly larger than n. Slots past n are remapped
+ * to the free slots below it. A lookup is one hash of the key, one pilot
+ * read and, for about 1% of keys, one remap read.
+ *
+ * The index takes roughly 3 to 6 bits per key, fewer as the set grows.
+ */
+template <typename KEY_T, typename HASH_F = std::hash<KEY_T>>
+class perfect_hash {
+public:
+	perfect_hash() : m_seed(0), m_size(0), m_slots(0), m_dense(0) {}
+
+	/**
+	 * @brief Builds the function over keys with the given hashes
+	 *
+	 * @param hashes   @c HASH_F of every key, in any order
+	 *
+	 * @throws std::invalid_argument if two hashes are equal, either a
+	 * duplicate key or a full collision of the key hash
+	 */
+	void build(const std::vector<uint64_t>& hashes);
+
+	/**
+	 * @brief Gets the slot of a key
+	 */
+	size_t operator()(const KEY_T& key) const { return slot(HASH_F{}(key)); }
+
+	/**
+	 * @brief Gets the slot of a key from its @c HASH_F hash
+	 */
+	size_t slot(uint64_t hash) const;
+
+	/**
+	 * @brief Number of keys, and so of slots
+	 */
+	size_t size() const { return m_size; }
+
+	/**
+	 * @brief Size of the index in bits per key
+	 */
+	double bits_per_key() const;
+
+	/**
+	 * @brief Writes the function to a binary stream, see dsa::serial
+	 */
+	void save(std::ostream& out) const;
+
+	/**
+	 * @brief Replaces the function with one read by @c save
+	 *
+	 * @throws std::runtime_error if the data is truncated or inconsistent
+	 */
+	void load(std::istream& in);
+
+	void clear();
+
+private:
+	static const uint32_t pilot_limit = 65536; // Pilots are stored in 16 bits
+	static const size_t build_attempts = 16;   // Seeds tried before giving up
+	static const uint32_t magic_number = 0x31485050; // "PPH1"
+
+	// Keys per bucket are about log2(n) / bucket_ratio
+	static constexpr double bucket_ratio = 4.0;
+
+	// Fraction of the slots searched by pilots that end up holding keys
+	static constexpr double slot_load = 0.99;
+
+	size_t bucket(uint64_t hash) const;
+	size_t position(uint64_t hash, uint16_t pilot) const;
+
+	/**
+	 * @brief Tries to build with the current seed
+	 *
+	 * @returns false if some bucket found no pilot
+	 */
+	bool try_build(const std::vector<uint64_t>& hashes);
+
+	uint64_t m_seed;
+	size_t m_size;  // Keys
+	size_t m_slots; // Slots searched by pilots, slightly more than m_size
+	size_t m_dense; // Buckets holding the first 60% of keys
+
+	std::vector<uint16_t> m_pilots; // Indexed by bucket
+	std::vector<uint32_t> m_remap;  // Slot below m_size for slots past it
+};
+
+} // namespace dsa
+
+#include "perfect_hash.inl.hpp"
@@ -0,0 +1,263 @@
+#pragma once
+
+#include "perfect_hash.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "hash.hpp"
+#include "serialize.hpp"
+
+namespace dsa {
+
+template <typename KEY_T, typename HASH_F>
+size_t perfect_hash<KEY_T, HASH_F>::bucket(uint64_t hash) const {
+	// Skewed: 60% of keys go to the first 30% of buckets. Those dense
+	// buckets are placed first, while the table is still mostly empty.
+	uint32_t low = static_cast<uint32_t>(hash);
+
+	if ((hash >> 32) < 0x9999999aull) {
+		return (static_cast<uint64_t>(low) * m_dense) >> 32;
+	}
+
+	return m_dense + ((static_cast<uint64_t>(low) * (m_pilots.size() - m_dense)) >> 32);
+}
+
+template <typename KEY_T, typename HASH_F>
+size_t perfect_hash<KEY_T, HASH_F>::position(uint64_t hash, uint16_t pilot) const {
+	return fast_range(mix64(hash ^ (pilot * 0x9E3779B97F4A7C15ull)), m_slots);
+}
+
+template <typename KEY_T, typename HASH_F>
+size_t perfect_hash<KEY_T, HASH_F>::slot(uint64_t hash) const {
+	if (m_size == 0) {
+		return 0;
+	}
+
+	hash = mix64(hash ^ m_seed);
+	size_t pos = position(hash, m_pilots[bucket(hash)]);
+
+	return (pos < m_size) ? pos : m_remap[pos - m_size];
+}
+
+template <typename KEY_T, typename HASH_F>
+void perfect_hash<KEY_T, HASH_F>::build(const std::vector<uint64_t>& hashes) {
+	clear();
+
+	if (hashes.empty()) {
+		return;
+	}
+
+	if (hashes.size() > UINT32_MAX) {
+		throw std::length_error("Too many keys for a perfect hash");
+	}
+
+	m_size = hashes.size();
+	m_slots = std::max<size_t>(m_size + 1, std::ceil(m_size / slot_load));
+
+	double keys_per_bucket = std::log2(m_size + 1) / bucket_ratio;
+	size_t buckets = std::max<size_t>(2, std::ceil(m_size / std::max(keys_per_bucket, 1.0)));
+
+	m_pilots.assign(buckets, 0);
+	m_dense = std::min(std::max<size_t>(1, buckets * 3 / 10), buckets - 1);
+
+	for (size_t attempt = 0; attempt < build_attempts; ++attempt) {
+		m_seed = mix64(attempt + 0x243F6A8885A308D3ull);
+
+		if (try_build(hashes)) {
+			return;
+		}
+	}
+
+	clear();
+	throw std::runtime_error("Failed to find a perfect hash for the keys");
+}
+
+template <typename KEY_T, typename HASH_F>
+bool perfect_hash<KEY_T, HASH_F>::try_build(const std::vector<uint64_t>& hashes) {
+	size_t buckets = m_pilots.size();
+
+	// Group the mixed hashes by bucket with a counting sort
+	std::vector<size_t> offsets(buckets + 1, 0);
+	std::vector<uint64_t> mixed(m_size);
+
+	for (size_t i = 0; i < m_size; ++i) {
+		mixed[i] = mix64(hashes[i] ^ m_seed);
+		++offsets[bucket(mixed[i]) + 1];
+	}
+
+	for (size_t b = 0; b < buckets; ++b) {
+		offsets[b + 1] += offsets[b];
+	}
+
+	std::vector<uint64_t> grouped(m_size);
+	std::vector<size_t> fill(offsets.begin(), offsets.end() - 1);
+
+	for (uint64_t hash : mixed) {
+		grouped[fill[bucket(hash)]++] = hash;
+	}
+
+	// Equal hashes collide under every pilot, so no seed can help
+	size_t largest = 0;
+
+	for (size_t b = 0; b < buckets; ++b) {
+		std::sort(grouped.begin() + offsets[b], grouped.begin() + offsets[b + 1]);
+
+		if (std::adjacent_find(grouped.begin() + offsets[b], grouped.begin() + offsets[b + 1]) != grouped.begin() + offsets[b + 1]) {
+			throw std::invalid_argument("Duplicate key hashes in perfect hash");
+		}
+
+		largest = std::max(largest, offsets[b + 1] - offsets[b]);
+	}
+
+	// Place the largest buckets first
+	std::vector<size_t> order(buckets);
+
+	for (size_t b = 0; b < buckets; ++b) {
+		order[b] = b;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+		return offsets[a + 1] - offsets[a] > offsets[b + 1] - offsets[b];
+	});
+
+	std::vector<bool> taken(m_slots, false);
+	std::vector<size_t> positions;
+	positions.reserve(largest);
+
+	for (size_t b : order) {
+		size_t begin = offsets[b];
+		size_t end = offsets[b + 1];
+
+		if (begin == end) {
+			break;
+		}
+
+		bool placed = false;
+
+		for (uint32_t pilot = 0; pilot < pilot_limit && !placed; ++pilot) {
+			positions.clear();
+			placed = true;
+
+			for (size_t i = begin; i < end; ++i) {
+				size_t pos = position(grouped[i], pilot);
+
+				if (taken[pos] || std::find(positions.begin(), positions.end(), pos) != positions.end()) {
+					placed = false;
+					break;
+				}
+
+				positions.push_back(pos);
+			}
+
+			if (placed) {
+				m_pilots[b] = pilot;
+			}
+		}
+
+		if (!placed) {
+			return false;
+		}
+
+		for (size_t pos : positions) {
+			taken[pos] = true;
+		}
+	}
+
+	// Keys placed past m_size move to the slots left free below it
+	m_remap.assign(m_slots - m_size, 0);
+	size_t free_slot = 0;
+
+	for (size_t pos = m_size; pos < m_slots; ++pos) {
+		if (!taken[pos]) {
+			continue;
+		}
+
+		while (taken[free_slot]) {
+			++free_slot;
+		}
+
+		m_remap[pos - m_size] = free_slot++;
+	}
+
+	return true;
+}
+
+template <typename KEY_T, typename HASH_F>
+double perfect_hash<KEY_T, HASH_F>::bits_per_key() const {
+	if (m_size == 0) {
+		return 0.0;
+	}
+
+	size_t bits = 8 * (m_pilots.size() * sizeof(uint16_t) + m_remap.size() * sizeof(uint32_t));
+	return static_cast<double>(bits) / m_size;
+}
+
+template <typename KEY_T, typename HASH_F>
+void perfect_hash<KEY_T, HASH_F>::save(std::ostream& out) const {
+	serial::write(out, static_cast<uint32_t>(magic_number));
+	serial::write(out, m_seed);
+	serial::write(out, static_cast<uint64_t>(m_size));
+	serial::write(out, static_cast<uint64_t>(m_slots));
+	serial::write(out, static_cast<uint64_t>(m_dense));
+	serial::write(out, m_pilots);
+	serial::write(out, m_remap);
+}
+
+template <typename KEY_T, typename HASH_F>
+void perfect_hash<KEY_T, HASH_F>::load(std::istream& in) {
+	clear();
+
+	uint32_t magic;
+	uint64_t size;
+	uint64_t slots;
+	uint64_t dense;
+
+	serial::read(in, magic);
+
+	if (magic != magic_number) {
+		throw std::runtime_error("Not a serialized perfect hash");
+	}
+
+	try {
+		serial::read(in, m_seed);
+		serial::read(in, size);
+		serial::read(in, slots);
+		serial::read(in, dense);
+		serial::read(in, m_pilots);
+		serial::read(in, m_remap);
+	} catch (...) {
+		clear();
+		throw;
+	}
+
+	m_size = size;
+	m_slots = slots;
+	m_dense = dense;
+
+	bool valid = (m_size == 0) ?
+		(m_slots == 0 && m_pilots.empty() && m_remap.empty()) :
+		(m_slots > m_size && m_remap.size() == m_slots - m_size && m_dense >= 1 && m_dense < m_pilots.size());
+
+	for (uint32_t target : m_remap) {
+		valid = valid && target < m_size;
+	}
+
+	if (!valid) {
+		clear();
+		throw std::runtime_error("Corrupt serialized perfect hash");
+	}
+}
+
+template <typename KEY_T, typename HASH_F>
+void perfect_hash<KEY_T, HASH_F>::clear() {
+	m_seed = 0;
+	m_size = 0;
+	m_slots = 0;
+	m_dense = 0;
+	m_pilots.clear();
+	m_remap.clear();
+}
+
+} // namespace dsa
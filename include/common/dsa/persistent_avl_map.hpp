@@ -0,0 +1,278 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "epoch_domain.hpp"
+
+namespace dsa {
+
+/**
+ * @brief Ordered map whose copies share structure, each a version that later
+ * writes never change
+ *
+ * Nodes are immutable and owned through reference counts, so a subtree can
+ * belong to any number of versions. A write copies only the path from the
+ * root to the key, rebalancing on the way back up like avl_map, and leaves
+ * every other version as it was. Copying a map is O(1), a write makes
+ * O(log n) new nodes.
+ *
+ * Iterators hold the path to their node and stay valid while the version
+ * they came from is kept, by this map or a copy of it.
+ *
+ * A version may be read from any number of threads at once. Use
+ * versioned_avl_map to hand new versions from a writer to readers.
+ */
+template <typename KEY_T, typename VAL_T>
+class persistent_avl_map {
+private:
+	struct node;
+	using node_ptr = std::shared_ptr<const node>;
+
+public:
+	using pair_type = std::pair<const KEY_T, VAL_T>;
+	using value_type = pair_type;
+	using size_type = size_t;
+
+	class const_iterator;
+	using iterator = const_iterator;
+
+	persistent_avl_map() {}
+
+	/**
+	 * @brief Inserts key/value pair, if the key isn't in the map
+	 *
+	 * @returns true if inserted, false if the key already existed
+	 */
+	bool insert(pair_type value);
+
+	/**
+	 * @brief Inserts a pair, or replaces the value of an existing key
+	 *
+	 * @returns true if inserted, false if a value was replaced
+	 */
+	bool insert_or_assign(pair_type value);
+
+	/**
+	 * @brief Erase the pair with matching key, if any
+	 *
+	 * @returns The number of pairs erased, 0 or 1
+	 */
+	size_type erase(const KEY_T& key);
+
+	/**
+	 * @brief Removes all elements from this version
+	 */
+	void clear();
+
+	void swap(persistent_avl_map& other);
+
+	/**
+	 * @brief Find an iterator to the given key
+	 *
+	 * @returns Iterator to the matching pair, end if no match was found
+	 */
+	const_iterator find(const KEY_T& key) const;
+
+	/**
+	 * @brief Gets the first pair whose key is not less than key
+	 */
+	const_iterator lower_bound(const KEY_T& key) const;
+
+	bool contains(const KEY_T& key) const { return locate(key) != nullptr; }
+	size_type count(const KEY_T& key) const { return contains(key) ? 1 : 0; }
+
+	/**
+	 * @brief Gets the corresponding value of a key
+	 *
+	 * @throws std::invalid_argument if no matching key was found
+	 */
+	const VAL_T& operator[](const KEY_T& key) const;
+
+	const_iterator begin() const;
+	const_iterator end() const { return const_iterator(); }
+	const_iterator cbegin() const { return begin(); }
+	const_iterator cend() const { return end(); }
+
+	size_type size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+
+	/**
+	 * @brief Number of levels in the tree, 0 for an empty map
+	 */
+	int height() const { return height(m_root); }
+
+	/**
+	 * @brief Checks if two versions are the same tree, such as a copy that
+	 * hasn't been written to since
+	 */
+	bool same_version(const persistent_avl_map& other) const { return m_root == other.m_root; }
+
+	class const_iterator {
+	public:
+		const_iterator() {}
+
+		const_iterator& operator++();
+
+		const_iterator operator++(int) {
+			const_iterator tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		bool operator==(const const_iterator& other) const { return current() == other.current(); }
+		bool operator!=(const const_iterator& other) const { return current() != other.current(); }
+
+		const pair_type& operator*() const { return current()->pair; }
+		const pair_type* operator->() const { return &current()->pair; }
+
+	private:
+		friend class persistent_avl_map;
+
+		const node* current() const { return m_path.empty() ? nullptr : m_path.back(); }
+
+		/**
+		 * @brief Pushes n and the left spine below it
+		 */
+		void descend_left(const node* n);
+
+		// The current node last, after every ancestor whose left subtree
+		// it is in, those still to be visited
+		std::vector<const node*> m_path;
+	};
+
+private:
+	struct node {
+		node(pair_type pair, node_ptr left, node_ptr right) :
+			pair(std::move(pair)),
+			left(std::move(left)),
+			right(std::move(right)),
+			height(1 + std::max(persistent_avl_map::height(this->left), persistent_avl_map::height(this->right))) {}
+
+		const pair_type pair;
+		const node_ptr left;
+		const node_ptr right;
+		const int height; // Levels in the subtree, 1 for a leaf
+	};
+
+	static int height(const node_ptr& n) { return n ? n->height : 0; }
+
+	/**
+	 * @brief Finds the node holding key, without the path an iterator keeps
+	 */
+	const node* locate(const KEY_T& key) const;
+
+	static node_ptr make(pair_type pair, node_ptr left, node_ptr right);
+
+	/**
+	 * @brief Makes a node over two subtrees whose heights differ by at most
+	 * two, rotating so they differ by at most one
+	 */
+	static node_ptr balance(pair_type pair, node_ptr left, node_ptr right);
+
+	/**
+	 * @brief Inserts into a subtree, copying the path to the key
+	 *
+	 * @param assign     Replaces the value if the key exists
+	 * @param inserted   Set if a pair was added
+	 *
+	 * @returns The new subtree, n itself if nothing changed
+	 */
+	static node_ptr insert(const node_ptr& n, pair_type& value, bool assign, bool& inserted);
+
+	/**
+	 * @brief Erases from a subtree, copying the path to the key
+	 *
+	 * @returns The new subtree, n itself if the key wasn't found
+	 */
+	static node_ptr erase(const node_ptr& n, const KEY_T& key, bool& erased);
+
+	/**
+	 * @brief Removes the leftmost node of a non-empty subtree
+	 *
+	 * @param min   Set to the removed node, still owned by the old subtree
+	 */
+	static node_ptr erase_min(const node_ptr& n, const node*& min);
+
+	node_ptr m_root;
+	size_type m_size = 0;
+};
+
+/**
+ * @brief Publishes versions of a persistent_avl_map from one writer to any
+ * number of readers
+ *
+ * The current version is an atomic pointer. A reader takes a snapshot by
+ * loading it and copying the map, which only adds a reference to the root,
+ * and then reads its snapshot with no further synchronization while the
+ * writer goes on publishing new versions.
+ *
+ * Snapshots pin an epoch_domain while they copy, and replaced versions are
+ * retired to it, so a version is freed once no snapshot can still be
+ * loading it. Nodes still shared with newer versions or held by snapshots
+ * live on through their reference counts.
+ *
+ * Only one thread may call the writing functions at a time.
+ */
+template <typename KEY_T, typename VAL_T>
+class versioned_avl_map {
+public:
+	using map_type = persistent_avl_map<KEY_T, VAL_T>;
+
+	/**
+	 * @param domain   Domain replaced versions are retired to, which must
+	 * outlive the map
+	 */
+	explicit versioned_avl_map(epoch_domain& domain = epoch_domain::shared());
+
+	/**
+	 * @brief Frees the current version, replaced ones are left to the domain
+	 */
+	~versioned_avl_map();
+
+	versioned_avl_map(const versioned_avl_map&) = delete;
+	versioned_avl_map& operator=(const versioned_avl_map&) = delete;
+
+	/**
+	 * @brief Gets the current version, safe from any thread, never locks
+	 */
+	map_type snapshot() const;
+
+	/**
+	 * @brief Makes map the current version, writer only
+	 */
+	void publish(map_type map);
+
+	/**
+	 * @brief Applies fn to a copy of the current version, then publishes
+	 * it, writer only
+	 *
+	 * @param fn   Called as fn(map_type&)
+	 */
+	template <typename FN_T>
+	void update(FN_T fn);
+
+	/**
+	 * @brief Frees replaced versions no reader can still load, writer only
+	 *
+	 * Publishing retires to the domain, which frees in batches. Never
+	 * blocks; versions held by snapshots in progress are freed on a later
+	 * call.
+	 *
+	 * @returns true if nothing the writer, or a thread that exited,
+	 * retired to the domain is left waiting to be freed
+	 */
+	bool reclaim() { return m_domain.reclaim(); }
+
+private:
+	epoch_domain& m_domain;
+	std::atomic<map_type*> m_current;
+};
+
+} // namespace dsa
+
+#include "persistent_avl_map.inl.hpp"
@@ -0,0 +1,298 @@
+#pragma once
+
+#include "persistent_avl_map.hpp"
+
+#include <stdexcept>
+
+namespace dsa {
+
+// persistent_avl_map
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::node_ptr
+persistent_avl_map<KEY_T, VAL_T>::make(pair_type pair, node_ptr left, node_ptr right) {
+	return std::make_shared<node>(std::move(pair), std::move(left), std::move(right));
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::node_ptr
+persistent_avl_map<KEY_T, VAL_T>::balance(pair_type pair, node_ptr left, node_ptr right) {
+	int left_height = height(left);
+	int right_height = height(right);
+
+	if (left_height > right_height + 1) {
+		// Left heavy, rotate right, first rotating the left child left if
+		// its own right side is the taller
+		if (height(left->left) >= height(left->right)) {
+			return make(left->pair, left->left, make(std::move(pair), left->right, std::move(right)));
+		}
+
+		const node& middle = *left->right;
+
+		return make(middle.pair, make(left->pair, left->left, middle.left),
+		            make(std::move(pair), middle.right, std::move(right)));
+	}
+
+	if (right_height > left_height + 1) {
+		if (height(right->right) >= height(right->left)) {
+			return make(right->pair, make(std::move(pair), std::move(left), right->left), right->right);
+		}
+
+		const node& middle = *right->left;
+
+		return make(middle.pair, make(std::move(pair), std::move(left), middle.left),
+		            make(right->pair, middle.right, right->right));
+	}
+
+	return make(std::move(pair), std::move(left), std::move(right));
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::node_ptr
+persistent_avl_map<KEY_T, VAL_T>::insert(const node_ptr& n, pair_type& value, bool assign, bool& inserted) {
+	if (!n) {
+		inserted = true;
+		return make(std::move(value), nullptr, nullptr);
+	}
+
+	if (value.first < n->pair.first) {
+		node_ptr left = insert(n->left, value, assign, inserted);
+		return left == n->left ? n : balance(n->pair, std::move(left), n->right);
+	}
+
+	if (n->pair.first < value.first) {
+		node_ptr right = insert(n->right, value, assign, inserted);
+		return right == n->right ? n : balance(n->pair, n->left, std::move(right));
+	}
+
+	inserted = false;
+	return assign ? make(std::move(value), n->left, n->right) : n;
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::node_ptr
+persistent_avl_map<KEY_T, VAL_T>::erase(const node_ptr& n, const KEY_T& key, bool& erased) {
+	if (!n) {
+		return n;
+	}
+
+	if (key < n->pair.first) {
+		node_ptr left = erase(n->left, key, erased);
+		return left == n->left ? n : balance(n->pair, std::move(left), n->right);
+	}
+
+	if (n->pair.first < key) {
+		node_ptr right = erase(n->right, key, erased);
+		return right == n->right ? n : balance(n->pair, n->left, std::move(right));
+	}
+
+	erased = true;
+
+	if (!n->left) {
+		return n->right;
+	}
+	if (!n->right) {
+		return n->left;
+	}
+
+	// Replace with the smallest pair of the right subtree
+	const node* min = nullptr;
+	node_ptr right = erase_min(n->right, min);
+
+	return balance(min->pair, n->left, std::move(right));
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::node_ptr
+persistent_avl_map<KEY_T, VAL_T>::erase_min(const node_ptr& n, const node*& min) {
+	if (!n->left) {
+		min = n.get();
+		return n->right;
+	}
+
+	return balance(n->pair, erase_min(n->left, min), n->right);
+}
+
+template <typename KEY_T, typename VAL_T>
+bool persistent_avl_map<KEY_T, VAL_T>::insert(pair_type value) {
+	bool inserted = false;
+	m_root = insert(m_root, value, false, inserted);
+
+	if (inserted) {
+		++m_size;
+	}
+
+	return inserted;
+}
+
+template <typename KEY_T, typename VAL_T>
+bool persistent_avl_map<KEY_T, VAL_T>::insert_or_assign(pair_type value) {
+	bool inserted = false;
+	m_root = insert(m_root, value, true, inserted);
+
+	if (inserted) {
+		++m_size;
+	}
+
+	return inserted;
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::size_type persistent_avl_map<KEY_T, VAL_T>::erase(const KEY_T& key) {
+	bool erased = false;
+	m_root = erase(m_root, key, erased);
+
+	if (!erased) {
+		return 0;
+	}
+
+	--m_size;
+	return 1;
+}
+
+template <typename KEY_T, typename VAL_T>
+void persistent_avl_map<KEY_T, VAL_T>::clear() {
+	m_root = nullptr;
+	m_size = 0;
+}
+
+template <typename KEY_T, typename VAL_T>
+void persistent_avl_map<KEY_T, VAL_T>::swap(persistent_avl_map& other) {
+	std::swap(m_root, other.m_root);
+	std::swap(m_size, other.m_size);
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::const_iterator
+persistent_avl_map<KEY_T, VAL_T>::lower_bound(const KEY_T& key) const {
+	const_iterator it;
+	const node* cur = m_root.get();
+
+	// Only nodes the search goes left at are still to be visited
+	while (cur != nullptr) {
+		if (cur->pair.first < key) {
+			cur = cur->right.get();
+		} else {
+			it.m_path.push_back(cur);
+			cur = cur->left.get();
+		}
+	}
+
+	return it;
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::const_iterator
+persistent_avl_map<KEY_T, VAL_T>::find(const KEY_T& key) const {
+	const_iterator it = lower_bound(key);
+
+	if (it == end() || key < it->first) {
+		return end();
+	}
+
+	return it;
+}
+
+template <typename KEY_T, typename VAL_T>
+const typename persistent_avl_map<KEY_T, VAL_T>::node* persistent_avl_map<KEY_T, VAL_T>::locate(const KEY_T& key) const {
+	const node* cur = m_root.get();
+
+	while (cur != nullptr) {
+		if (key < cur->pair.first) {
+			cur = cur->left.get();
+		} else if (cur->pair.first < key) {
+			cur = cur->right.get();
+		} else {
+			return cur;
+		}
+	}
+
+	return nullptr;
+}
+
+template <typename KEY_T, typename VAL_T>
+const VAL_T& persistent_avl_map<KEY_T, VAL_T>::operator[](const KEY_T& key) const {
+	const node* found = locate(key);
+
+	if (found == nullptr) {
+		throw std::invalid_argument("Key not found in map");
+	}
+
+	return found->pair.second;
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::const_iterator persistent_avl_map<KEY_T, VAL_T>::begin() const {
+	const_iterator it;
+
+	if (m_root) {
+		it.descend_left(m_root.get());
+	}
+
+	return it;
+}
+
+// end persistent_avl_map
+
+// persistent_avl_map::const_iterator
+
+template <typename KEY_T, typename VAL_T>
+void persistent_avl_map<KEY_T, VAL_T>::const_iterator::descend_left(const node* n) {
+	while (n != nullptr) {
+		m_path.push_back(n);
+		n = n->left.get();
+	}
+}
+
+template <typename KEY_T, typename VAL_T>
+typename persistent_avl_map<KEY_T, VAL_T>::const_iterator&
+persistent_avl_map<KEY_T, VAL_T>::const_iterator::operator++() {
+	const node* cur = m_path.back();
+	m_path.pop_back();
+
+	// The next node is the leftmost of the right subtree, otherwise the
+	// nearest ancestor still on the path
+	descend_left(cur->right.get());
+
+	return *this;
+}
+
+// end persistent_avl_map::const_iterator
+
+// versioned_avl_map
+
+template <typename KEY_T, typename VAL_T>
+versioned_avl_map<KEY_T, VAL_T>::versioned_avl_map(epoch_domain& domain) :
+	m_domain(domain),
+	m_current(new map_type()) {}
+
+template <typename KEY_T, typename VAL_T>
+versioned_avl_map<KEY_T, VAL_T>::~versioned_avl_map() {
+	delete m_current.load(std::memory_order_relaxed);
+}
+
+template <typename KEY_T, typename VAL_T>
+typename versioned_avl_map<KEY_T, VAL_T>::map_type versioned_avl_map<KEY_T, VAL_T>::snapshot() const {
+	epoch_domain::guard guard(m_domain);
+
+	// The copy holds its own reference, the version may be replaced after
+	return *m_current.load(std::memory_order_acquire);
+}
+
+template <typename KEY_T, typename VAL_T>
+void versioned_avl_map<KEY_T, VAL_T>::publish(map_type map) {
+	map_type* replaced = m_current.exchange(new map_type(std::move(map)), std::memory_order_acq_rel);
+	m_domain.retire(replaced);
+}
+
+template <typename KEY_T, typename VAL_T>
+template <typename FN_T>
+void versioned_avl_map<KEY_T, VAL_T>::update(FN_T fn) {
+	map_type next = *m_current.load(std::memory_order_relaxed);
+	fn(next);
+	publish(std::move(next));
+}
+
+// end versioned_avl_map
+
+} // namespace dsa
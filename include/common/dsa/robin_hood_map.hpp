@@ -0,0 +1,307 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+
+#include "utility.hpp"
+
+namespace dsa {
+
+/**
+ * @brief Open addressing hash map using Robin Hood linear probing
+ *
+ * Same interface as @c unordered_map, with a different collision strategy.
+ * Every entry records its distance from its home bucket. On insert, an entry
+ * that is further from home than the resident takes its bucket and the
+ * resident continues probing, which keeps probe distances short and even.
+ *
+ * Because entries along a probe sequence are ordered by distance, a lookup
+ * can stop as soon as it meets an entry closer to home than the probe, so
+ * misses do not walk to an empty bucket. Erase shifts the following entries
+ * back instead of leaving sentinels, so the table does not degrade as it
+ * ages, and the map can run at a much higher load factor.
+ *
+ * Bucket counts are powers of two. Erasing while iterating may revisit an
+ * entry shifted back across the end of the table.
+ */
+template <typename KEY_T, typename VAL_T, typename HASH_F = std::hash<KEY_T>>
+class robin_hood_map {
+private:
+	class bucket;
+
+	template <typename IT_BUCKET_T, typename IT_PAIR_T>
+	class iterator_base;
+
+public:
+	using pair_type = std::pair<const KEY_T, VAL_T>;
+	using value_type = pair_type;
+	using size_type = size_t;
+
+	using iterator = iterator_base<bucket, pair_type>;
+	using const_iterator = iterator_base<const bucket, const pair_type>;
+
+	robin_hood_map() : robin_hood_map(min_buckets) {}
+
+	robin_hood_map(size_t buckets);
+
+	robin_hood_map(robin_hood_map&& other);
+	robin_hood_map(const robin_hood_map& other);
+
+	robin_hood_map& operator=(robin_hood_map rhs);
+
+	/**
+	 * @brief Inserts key/value pair into the map
+	 *
+	 * @returns @c std::pair containing an iterator to the KVP inserted or
+	 * the KVP blocking the insertion, and a boolean indicating whether the
+	 * value was inserted
+	 */
+	std::pair<iterator, bool> insert(pair_type value);
+
+	/**
+	 * @brief Removes all elements from the map, keeping its buckets
+	 */
+	void clear();
+
+	/**
+	 * @brief Erase the pair referenced by the iterator
+	 *
+	 * @returns Iterator to the next value after the erased value
+	 */
+	iterator erase(iterator pos);
+
+	/**
+	 * @brief Erase pairs with matching key, if any
+	 *
+	 * @returns The number of nodes erased, 0 or 1
+	 */
+	size_type erase(const KEY_T& key);
+
+	void swap(robin_hood_map& other);
+
+	size_type count(const KEY_T& key) const { return contains(key); }
+	bool contains(const KEY_T& key) const { return find(key) != end(); }
+
+	/**
+	 * @brief Find an iterator to the given key
+	 *
+	 * @returns @c iterator or @c const_iterator to the matching pair,
+	 * end if no match was found
+	 */
+	iterator find(const KEY_T& key);
+	const_iterator find(const KEY_T& key) const;
+
+	/**
+	 * @brief Gets the corresponding value of a key
+	 *
+	 * @throws std::invalid_argument if no matching key was found
+	 */
+	VAL_T& operator[](const KEY_T& key);
+	const VAL_T& operator[](const KEY_T& key) const;
+
+	iterator begin();
+	const_iterator begin() const;
+	const_iterator cbegin() const { return begin(); }
+
+	iterator end() { return iterator(table_end(), table_end()); }
+	const_iterator end() const { return const_iterator(table_end(), table_end()); }
+	const_iterator cend() const { return end(); }
+
+	size_type size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	size_type bucket_count() const { return m_buckets; }
+
+	double load_factor() const { return static_cast<double>(m_size) / m_buckets; }
+	double max_load_factor() const { return m_max_load_factor; }
+
+	/**
+	 * @brief Sets the load factor that triggers growth, clamped to [0.1, 0.95]
+	 */
+	void max_load_factor(double factor);
+
+	/**
+	 * @brief Rehashes the table to at least count buckets
+	 */
+	void rehash(size_t count);
+
+	/**
+	 * @brief Reserve enough space for at least count entries
+	 */
+	void reserve(size_t count);
+
+	/**
+	 * @brief Longest probe distance of any entry, for diagnostics
+	 */
+	size_t max_probe_distance() const;
+
+private:
+	static const size_t min_buckets = 16;
+
+	/**
+	 * @brief Mixes a hash and keeps its high 32 bits
+	 *
+	 * Fibonacci hashing spreads weak hashes (e.g. identity for integers)
+	 * over the table. The fragment is cached in the bucket, which is enough
+	 * to find the home bucket of tables up to 2^32 buckets without hashing
+	 * the key again, and to skip most key comparisons.
+	 */
+	static uint32_t fragment(size_t hash) { return (hash * 0x9E3779B97F4A7C15ull) >> 32; }
+
+	/**
+	 * @brief Maps a hash fragment to its home bucket
+	 */
+	size_t home(uint32_t fragment) const { return fragment >> (m_shift - 32); }
+
+	size_t next(size_t idx) const { return (idx + 1) & (m_buckets - 1); }
+
+	bucket* table_end() const { return m_table.get() + m_buckets; }
+
+	/**
+	 * @brief Index of the bucket holding key, or m_buckets if absent
+	 */
+	size_t find_index(const KEY_T& key) const;
+
+	/**
+	 * @brief Places an entry known to be absent, starting the probe at idx
+	 *
+	 * @returns Index of the bucket the entry ended up in
+	 */
+	size_t place(typename bucket::storage_type&& pair, uint32_t fragment, size_t idx, uint32_t distance);
+
+	size_type m_size;
+	size_type m_buckets;
+	int m_shift;
+	double m_max_load_factor = 0.9;
+	std::unique_ptr<bucket[]> m_table;
+
+	/**
+	 * Stores a single entry, its distance from its home bucket and its hash
+	 * fragment, which fits in what would otherwise be padding
+	 *
+	 * Entries are stored as a pair with a mutable key so they can be moved
+	 * between buckets, and exposed as @c pair_type with a const key.
+	 */
+	class bucket {
+	public:
+		using storage_type = std::pair<KEY_T, VAL_T>;
+
+		bucket() : m_distance(0), m_fragment(0) {}
+		~bucket() { destroy(); }
+
+		bucket(const bucket&) = delete;
+		bucket& operator=(const bucket&) = delete;
+
+		bool empty() const { return m_distance == 0; }
+		bool full() const { return m_distance != 0; }
+
+		// Probe distance from the home bucket, only valid when full
+		uint32_t distance() const { return m_distance - 1; }
+		void set_distance(uint32_t distance) { m_distance = distance + 1; }
+
+		const KEY_T& key() const { return storage().first; }
+
+		uint32_t fragment() const { return m_fragment; }
+
+		bool matches(const KEY_T& key, uint32_t fragment) const {
+			return m_fragment == fragment && storage().first == key;
+		}
+
+		storage_type& storage() { return *reinterpret_cast<storage_type*>(m_buf); }
+		const storage_type& storage() const { return *reinterpret_cast<const storage_type*>(m_buf); }
+
+		pair_type& pair() { return *reinterpret_cast<pair_type*>(m_buf); }
+		const pair_type& pair() const { return *reinterpret_cast<const pair_type*>(m_buf); }
+
+		/**
+		 * @brief Constructs an entry in an empty bucket
+		 */
+		void emplace(storage_type&& entry, uint32_t fragment, uint32_t distance) {
+			new (m_buf) storage_type(std::move(entry));
+			m_fragment = fragment;
+			set_distance(distance);
+		}
+
+		/**
+		 * @brief Exchanges the entry of a full bucket with one being placed
+		 */
+		void exchange(storage_type& entry, uint32_t& fragment, uint32_t& distance) {
+			std::swap(storage(), entry);
+			std::swap(m_fragment, fragment);
+
+			uint32_t resident = this->distance();
+			set_distance(distance);
+			distance = resident;
+		}
+
+		/**
+		 * @brief Moves this bucket's entry into an empty bucket
+		 */
+		void move_to(bucket& dest, uint32_t distance) {
+			dest.emplace(std::move(storage()), m_fragment, distance);
+			destroy();
+		}
+
+		void destroy() {
+			if (full()) {
+				storage().~storage_type();
+				m_distance = 0;
+			}
+		}
+
+	private:
+		uint32_t m_distance; // 0 if empty, otherwise distance + 1
+		uint32_t m_fragment;
+		alignas(storage_type) unsigned char m_buf[sizeof(storage_type)];
+	};
+
+	template <typename IT_BUCKET_T, typename IT_PAIR_T>
+	class iterator_base {
+	public:
+		template <typename OTH_IT_BUCKET_T, typename OTH_IT_PAIR_T>
+		friend class iterator_base;
+
+		iterator_base(IT_BUCKET_T* entry, IT_BUCKET_T* end) : m_entry(entry), m_end(end) {}
+
+		template <typename OTH_IT_BUCKET_T, typename OTH_IT_PAIR_T>
+		iterator_base(iterator_base<OTH_IT_BUCKET_T, OTH_IT_PAIR_T> other) :
+			m_entry(other.m_entry),
+			m_end(other.m_end) {}
+
+		using iterator_type = iterator_base<IT_BUCKET_T, IT_PAIR_T>;
+
+		iterator_type& operator++() {
+			do {
+				++m_entry;
+			} while (m_entry != m_end && m_entry->empty());
+
+			return *this;
+		}
+
+		iterator_type operator++(int) {
+			iterator_type tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		template <typename OTH_IT_BUCKET_T, typename OTH_IT_PAIR_T>
+		bool operator==(const iterator_base<OTH_IT_BUCKET_T, OTH_IT_PAIR_T>& other) const { return m_entry == other.m_entry; }
+
+		template <typename OTH_IT_BUCKET_T, typename OTH_IT_PAIR_T>
+		bool operator!=(const iterator_base<OTH_IT_BUCKET_T, OTH_IT_PAIR_T>& other) const { return m_entry != other.m_entry; }
+
+		IT_PAIR_T& operator*() const { return m_entry->pair(); }
+		IT_PAIR_T* operator->() const { return &m_entry->pair(); }
+
+		IT_BUCKET_T* entry() const { return m_entry; }
+
+	private:
+		IT_BUCKET_T* m_entry;
+		IT_BUCKET_T* m_end;
+	};
+};
+
+} // namespace dsa
+
+#include "robin_hood_map.inl.hpp"
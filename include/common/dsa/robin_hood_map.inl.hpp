@@ -0,0 +1,301 @@
+#pragma once
+
+#include "robin_hood_map.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include "stats.hpp"
+
+namespace dsa {
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+robin_hood_map<KEY_T, VAL_T, HASH_F>::robin_hood_map(size_t buckets) :
+	m_size(0),
+	m_buckets(min_buckets),
+	m_shift(sizeof(size_t) * 8 - 4) {
+
+	while (m_buckets < buckets) {
+		m_buckets <<= 1;
+		--m_shift;
+	}
+
+	m_table.reset(new bucket[m_buckets]);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+robin_hood_map<KEY_T, VAL_T, HASH_F>::robin_hood_map(robin_hood_map<KEY_T, VAL_T, HASH_F>&& other) :
+	m_size(other.m_size),
+	m_buckets(other.m_buckets),
+	m_shift(other.m_shift),
+	m_max_load_factor(other.m_max_load_factor),
+	m_table(std::move(other.m_table)) {}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+robin_hood_map<KEY_T, VAL_T, HASH_F>::robin_hood_map(const robin_hood_map<KEY_T, VAL_T, HASH_F>& other) :
+	m_size(other.m_size),
+	m_buckets(other.m_buckets),
+	m_shift(other.m_shift),
+	m_max_load_factor(other.m_max_load_factor),
+	m_table(new bucket[m_buckets]) {
+
+	// Same bucket count, so every entry keeps its bucket and distance
+	for (size_t i = 0; i < m_buckets; ++i) {
+		const bucket& src = other.m_table[i];
+
+		if (src.full()) {
+			m_table[i].emplace(typename bucket::storage_type(src.storage()), src.fragment(), src.distance());
+		}
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+robin_hood_map<KEY_T, VAL_T, HASH_F>& robin_hood_map<KEY_T, VAL_T, HASH_F>::operator=(robin_hood_map<KEY_T, VAL_T, HASH_F> rhs) {
+	swap(rhs);
+	return *this;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void robin_hood_map<KEY_T, VAL_T, HASH_F>::max_load_factor(double factor) {
+	m_max_load_factor = std::min(std::max(factor, 0.1), 0.95);
+	reserve(m_size);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void robin_hood_map<KEY_T, VAL_T, HASH_F>::rehash(size_t count) {
+	PA3_STATS_TIMER(timer, rehash_ns);
+	PA3_STATS_INCREMENT(rehash_count);
+
+	size_t min_size = std::ceil(m_size / max_load_factor());
+
+	robin_hood_map<KEY_T, VAL_T, HASH_F> new_map(std::max(count, min_size));
+	new_map.m_max_load_factor = m_max_load_factor;
+
+	// Keys are known to be unique, so entries are placed without a lookup,
+	// and the cached fragment gives the new home without rehashing the key
+	for (size_t i = 0; i < m_buckets; ++i) {
+		bucket& entry = m_table[i];
+
+		if (entry.full()) {
+			new_map.place(std::move(entry.storage()), entry.fragment(), new_map.home(entry.fragment()), 0);
+			entry.destroy();
+		}
+	}
+
+	new_map.m_size = m_size;
+	swap(new_map);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void robin_hood_map<KEY_T, VAL_T, HASH_F>::reserve(size_t count) {
+	size_t needed = std::ceil(count / max_load_factor());
+
+	if (m_buckets < needed) {
+		rehash(needed);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t robin_hood_map<KEY_T, VAL_T, HASH_F>::place(typename bucket::storage_type&& pair, uint32_t fragment, size_t idx, uint32_t distance) {
+	typename bucket::storage_type carried(std::move(pair));
+	size_t placed = m_buckets;
+
+	while (true) {
+		bucket& entry = m_table[idx];
+
+		if (entry.empty()) {
+			entry.emplace(std::move(carried), fragment, distance);
+			return placed == m_buckets ? idx : placed;
+		}
+
+		// Take from the rich: the resident is closer to home, so it moves on
+		if (entry.distance() < distance) {
+			entry.exchange(carried, fragment, distance);
+
+			if (placed == m_buckets) {
+				placed = idx;
+			}
+		}
+
+		idx = next(idx);
+		++distance;
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+std::pair<typename robin_hood_map<KEY_T, VAL_T, HASH_F>::iterator, bool> robin_hood_map<KEY_T, VAL_T, HASH_F>::insert(pair_type pair) {
+	reserve(m_size + 1);
+
+	const KEY_T& key = pair.first;
+	uint32_t frag = fragment(HASH_F{}(key));
+
+	size_t idx = home(frag);
+	uint32_t distance = 0;
+
+	// A match can only appear before the first entry closer to its home
+	while (m_table[idx].full() && m_table[idx].distance() >= distance) {
+		if (m_table[idx].matches(key, frag)) {
+			return { iterator(&m_table[idx], table_end()), false };
+		}
+
+		idx = next(idx);
+		++distance;
+	}
+
+	PA3_STATS_RECORD(hash_probe_length, distance + 1);
+
+	idx = place(typename bucket::storage_type(pair.first, std::move(pair.second)), frag, idx, distance);
+	++m_size;
+
+	return { iterator(&m_table[idx], table_end()), true };
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void robin_hood_map<KEY_T, VAL_T, HASH_F>::clear() {
+	for (size_t i = 0; i < m_buckets; ++i) {
+		m_table[i].destroy();
+	}
+
+	m_size = 0;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename robin_hood_map<KEY_T, VAL_T, HASH_F>::iterator robin_hood_map<KEY_T, VAL_T, HASH_F>::erase(iterator pos) {
+	bucket* erased = pos.entry();
+	size_t idx = erased - m_table.get();
+
+	erased->destroy();
+	--m_size;
+
+	// Backward shift: pull following entries one bucket closer to home,
+	// until an empty bucket or an entry already at home
+	for (size_t after = next(idx); m_table[after].full() && m_table[after].distance() > 0; after = next(after)) {
+		m_table[after].move_to(m_table[idx], m_table[after].distance() - 1);
+		idx = after;
+	}
+
+	iterator it(erased, table_end());
+
+	// The next entry may have shifted into the erased bucket
+	if (erased->empty()) {
+		++it;
+	}
+
+	return it;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename robin_hood_map<KEY_T, VAL_T, HASH_F>::size_type robin_hood_map<KEY_T, VAL_T, HASH_F>::erase(const KEY_T& key) {
+	iterator pos = find(key);
+
+	if (pos == end()) {
+		return 0;
+	}
+
+	erase(pos);
+	return 1;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void robin_hood_map<KEY_T, VAL_T, HASH_F>::swap(robin_hood_map<KEY_T, VAL_T, HASH_F>& other) {
+	std::swap(m_size, other.m_size);
+	std::swap(m_buckets, other.m_buckets);
+	std::swap(m_shift, other.m_shift);
+	std::swap(m_max_load_factor, other.m_max_load_factor);
+	std::swap(m_table, other.m_table);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t robin_hood_map<KEY_T, VAL_T, HASH_F>::find_index(const KEY_T& key) const {
+	uint32_t frag = fragment(HASH_F{}(key));
+
+	size_t idx = home(frag);
+	uint32_t distance = 0;
+
+	// Stop early once the probe is further from home than the resident,
+	// the key would have displaced it on insert
+	while (m_table[idx].full() && m_table[idx].distance() >= distance) {
+		if (m_table[idx].matches(key, frag)) {
+			PA3_STATS_RECORD(hash_probe_length, distance + 1);
+			return idx;
+		}
+
+		idx = next(idx);
+		++distance;
+	}
+
+	PA3_STATS_RECORD(hash_probe_length, distance + 1);
+
+	return m_buckets;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename robin_hood_map<KEY_T, VAL_T, HASH_F>::iterator robin_hood_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) {
+	return iterator(m_table.get() + find_index(key), table_end());
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename robin_hood_map<KEY_T, VAL_T, HASH_F>::const_iterator robin_hood_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) const {
+	return const_iterator(m_table.get() + find_index(key), table_end());
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+VAL_T& robin_hood_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) {
+	iterator it = find(key);
+
+	if (it == end()) {
+		throw std::invalid_argument("Key not found in map");
+	}
+
+	return it->second;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+const VAL_T& robin_hood_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) const {
+	const_iterator it = find(key);
+
+	if (it == end()) {
+		throw std::invalid_argument("Key not found in map");
+	}
+
+	return it->second;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename robin_hood_map<KEY_T, VAL_T, HASH_F>::iterator robin_hood_map<KEY_T, VAL_T, HASH_F>::begin() {
+	bucket* entry = m_table.get();
+	bucket* end = table_end();
+
+	while (entry != end && entry->empty()) {
+		++entry;
+	}
+
+	return iterator(entry, end);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename robin_hood_map<KEY_T, VAL_T, HASH_F>::const_iterator robin_hood_map<KEY_T, VAL_T, HASH_F>::begin() const {
+	const bucket* entry = m_table.get();
+	const bucket* end = table_end();
+
+	while (entry != end && entry->empty()) {
+		++entry;
+	}
+
+	return const_iterator(entry, end);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t robin_hood_map<KEY_T, VAL_T, HASH_F>::max_probe_distance() const {
+	size_t longest = 0;
+
+	for (size_t i = 0; i < m_buckets; ++i) {
+		if (m_table[i].full()) {
+			longest = std::max<size_t>(longest, m_table[i].distance());
+		}
+	}
+
+	return longest;
+}
+
+} // namespace dsa
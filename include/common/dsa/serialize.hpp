@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dsa {
+
+/**
+ * @brief Binary reading and writing of the types stored in frozen
+ * structures
+ *
+ * Values are written in the host's byte order and layout, so data is only
+ * meant to be read back by the same build on the same machine, such as a
+ * snapshot saved at startup.
+ */
+namespace serial {
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type write(std::ostream& out, const T& value) {
+	out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+inline void write(std::ostream& out, const std::string& value) {
+	write(out, static_cast<uint64_t>(value.size()));
+	out.write(value.data(), value.size());
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type write(std::ostream& out, const std::vector<T>& values) {
+	write(out, static_cast<uint64_t>(values.size()));
+	out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/**
+ * @brief Reads exactly length bytes
+ *
+ * @throws std::runtime_error if the stream ends early
+ */
+inline void read_bytes(std::istream& in, void* data, size_t length) {
+	in.read(static_cast<char*>(data), length);
+
+	if (static_cast<size_t>(in.gcount()) != length) {
+		throw std::runtime_error("Unexpected end of serialized data");
+	}
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type read(std::istream& in, T& value) {
+	read_bytes(in, &value, sizeof(value));
+}
+
+inline void read(std::istream& in, std::string& value) {
+	uint64_t size;
+	read(in, size);
+
+	// Read in chunks, so a corrupt size fails at the end of the stream
+	// instead of allocating it all up front
+	value.clear();
+	char chunk[4096];
+
+	while (size > 0) {
+		size_t length = size < sizeof(chunk) ? size : sizeof(chunk);
+		read_bytes(in, chunk, length);
+		value.append(chunk, length);
+		size -= length;
+	}
+}
+
+template <typename T>
+typename std::enable_if<std::is_arithmetic<T>::value>::type read(std::istream& in, std::vector<T>& values) {
+	uint64_t size;
+	read(in, size);
+
+	values.clear();
+
+	while (size > 0) {
+		size_t length = size < 4096 ? size : 4096;
+		size_t offset = values.size();
+
+		values.resize(offset + length);
+		read_bytes(in, values.data() + offset, length * sizeof(T));
+		size -= length;
+	}
+}
+
+} // namespace serial
+
+} // namespace dsa
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "hash.hpp"
+#include "unordered_map.hpp"
+
+class thread_pool;
+
+namespace dsa {
+
+/**
+ * @brief Hash map split into independent unordered_map shards, so several
+ * threads can insert at once
+ *
+ * A key lives in the shard picked by the high bits of its hash, mixed
+ * first since hashes like std::hash of an integer leave them zero for small
+ * keys. Every operation on a key touches only that shard, and the shards'
+ * own tables are indexed by the whole hash, so the shards are filled
+ * evenly. A key is hashed once per operation, its shard's table is given
+ * the hash rather than computing it again.
+ *
+ * insert and erase lock the key's shard and may be called from several
+ * threads at once. insert_bulk routes a range of pairs to their shards
+ * first, then fills each shard from a single task without contention.
+ * Lookups and iteration don't lock, they must not overlap writes.
+ */
+template <typename KEY_T, typename VAL_T, typename HASH_F = std::hash<KEY_T>>
+class sharded_map {
+private:
+	template <typename IT_MAP_T, typename IT_INNER_T, typename IT_PAIR_T>
+	class iterator_base;
+
+public:
+	using shard_type = unordered_map<KEY_T, VAL_T, HASH_F>;
+	using pair_type = typename shard_type::pair_type;
+	using value_type = pair_type;
+	using size_type = size_t;
+
+	using iterator = iterator_base<sharded_map, typename shard_type::iterator, pair_type>;
+	using const_iterator = iterator_base<const sharded_map, typename shard_type::const_iterator, const pair_type>;
+
+	static const size_t default_shards = 16;
+
+	/**
+	 * @param shards   Number of shards, rounded up to a power of two
+	 */
+	explicit sharded_map(size_t shards = default_shards);
+
+	sharded_map(const sharded_map& other);
+	sharded_map(sharded_map&& other);
+	sharded_map& operator=(sharded_map rhs);
+
+	/**
+	 * @brief Inserts key/value pair into its shard, safe from any thread
+	 *
+	 * @returns true if inserted, false if the key already existed
+	 */
+	bool insert(pair_type value);
+
+	/**
+	 * @brief Inserts count pairs in parallel on a pool
+	 *
+	 * The pairs are split into contiguous chunks routed to their shards in
+	 * parallel, then every shard inserts its pairs from a single task, in
+	 * index order. Where keys repeat the lowest index wins, like inserting
+	 * one by one.
+	 *
+	 * @param key     Called as key(index), returning the index's key
+	 * @param value   Called as value(index), returning the index's value
+	 *
+	 * @returns Whether each index was inserted
+	 */
+	template <typename KEY_F, typename VALUE_F>
+	std::vector<uint8_t> insert_bulk(thread_pool& pool, size_t count, KEY_F key, VALUE_F value);
+
+	/**
+	 * @brief Erase the pair with matching key, if any, safe from any thread
+	 *
+	 * @returns The number of pairs erased, 0 or 1
+	 */
+	size_type erase(const KEY_T& key);
+
+	/**
+	 * @brief Removes all elements from the map
+	 */
+	void clear();
+
+	void swap(sharded_map& other);
+
+	/**
+	 * @brief Find an iterator to the given key, searching only its shard
+	 *
+	 * @returns @c iterator or @c const_iterator to the matching pair,
+	 * end if no match was found
+	 */
+	iterator find(const KEY_T& key);
+	const_iterator find(const KEY_T& key) const;
+
+	bool contains(const KEY_T& key) const {
+		size_t hash = HASH_F{}(key);
+		return entry_of(hash).map.contains(key, hash);
+	}
+	size_type count(const KEY_T& key) const { return contains(key) ? 1 : 0; }
+
+	/**
+	 * @brief Gets the corresponding value of a key
+	 *
+	 * @throws std::invalid_argument if no matching key was found
+	 */
+	VAL_T& operator[](const KEY_T& key);
+	const VAL_T& operator[](const KEY_T& key) const;
+
+	iterator begin() { return iterator(this, 0, m_shards[0].map.begin()); }
+	const_iterator begin() const { return const_iterator(this, 0, m_shards[0].map.begin()); }
+	const_iterator cbegin() const { return begin(); }
+
+	iterator end() { return iterator(this, m_shard_count - 1, m_shards[m_shard_count - 1].map.end()); }
+	const_iterator end() const { return const_iterator(this, m_shard_count - 1, m_shards[m_shard_count - 1].map.end()); }
+	const_iterator cend() const { return end(); }
+
+	/**
+	 * @brief Number of pairs, summed over the shards
+	 */
+	size_type size() const;
+	bool empty() const { return size() == 0; }
+
+	/**
+	 * @brief Reserve enough space for at least count entries, spread evenly
+	 * over the shards
+	 */
+	void reserve(size_t count);
+
+	size_t shard_count() const { return m_shard_count; }
+
+	/**
+	 * @brief Index of the shard a hash belongs to, from the high bits of
+	 * the mixed hash
+	 */
+	size_t shard_index(size_t hash) const { return m_shift < 64 ? mix64(hash) >> m_shift : 0; }
+
+	/**
+	 * @brief Gets a shard, for a thread that owns it while no other writes
+	 */
+	shard_type& shard(size_t index) { return m_shards[index].map; }
+	const shard_type& shard(size_t index) const { return m_shards[index].map; }
+
+private:
+	struct shard_entry {
+		std::mutex mutex;
+		shard_type map;
+
+		// Keeps neighbouring shards off each other's cache lines
+		char padding[64];
+	};
+
+	shard_entry& entry_of(size_t hash) { return m_shards[shard_index(hash)]; }
+	const shard_entry& entry_of(size_t hash) const { return m_shards[shard_index(hash)]; }
+
+	size_t m_shard_count;
+	int m_shift; // 64 with a single shard, which has no shard bits
+	std::unique_ptr<shard_entry[]> m_shards;
+
+	/**
+	 * Iterates the shards in order, each through its own iterator
+	 */
+	template <typename IT_MAP_T, typename IT_INNER_T, typename IT_PAIR_T>
+	class iterator_base {
+	public:
+		template <typename OTH_IT_MAP_T, typename OTH_IT_INNER_T, typename OTH_IT_PAIR_T>
+		friend class iterator_base;
+
+		iterator_base(IT_MAP_T* map, size_t shard, IT_INNER_T inner) :
+			m_map(map),
+			m_shard(shard),
+			m_inner(inner) {
+
+			settle();
+		}
+
+		template <typename OTH_IT_MAP_T, typename OTH_IT_INNER_T, typename OTH_IT_PAIR_T>
+		iterator_base(iterator_base<OTH_IT_MAP_T, OTH_IT_INNER_T, OTH_IT_PAIR_T> other) :
+			m_map(other.m_map),
+			m_shard(other.m_shard),
+			m_inner(other.m_inner) {}
+
+		using iterator_type = iterator_base<IT_MAP_T, IT_INNER_T, IT_PAIR_T>;
+
+		iterator_type& operator++() {
+			++m_inner;
+			settle();
+
+			return *this;
+		}
+
+		iterator_type operator++(int) {
+			iterator_type tmp = *this;
+			++(*this);
+			return tmp;
+		}
+
+		template <typename OTH_IT_MAP_T, typename OTH_IT_INNER_T, typename OTH_IT_PAIR_T>
+		bool operator==(const iterator_base<OTH_IT_MAP_T, OTH_IT_INNER_T, OTH_IT_PAIR_T>& other) const {
+			return m_shard == other.m_shard && m_inner == other.m_inner;
+		}
+
+		template <typename OTH_IT_MAP_T, typename OTH_IT_INNER_T, typename OTH_IT_PAIR_T>
+		bool operator!=(const iterator_base<OTH_IT_MAP_T, OTH_IT_INNER_T, OTH_IT_PAIR_T>& other) const {
+			return !(*this == other);
+		}
+
+		IT_PAIR_T& operator*() const { return *m_inner; }
+		IT_PAIR_T* operator->() const { return &*m_inner; }
+
+	private:
+		/**
+		 * @brief Moves past the ends of shards, stopping at the last's end
+		 */
+		void settle() {
+			while (m_shard + 1 < m_map->m_shard_count && m_inner == m_map->m_shards[m_shard].map.end()) {
+				++m_shard;
+				m_inner = m_map->m_shards[m_shard].map.begin();
+			}
+		}
+
+		IT_MAP_T* m_map;
+		size_t m_shard;
+		IT_INNER_T m_inner;
+	};
+};
+
+} // namespace dsa
+
+#include "sharded_map.inl.hpp"
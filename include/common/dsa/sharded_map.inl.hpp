@@ -0,0 +1,187 @@
+#pragma once
+
+#include "sharded_map.hpp"
+
+#include <stdexcept>
+#include <utility>
+
+#include "thread_pool.hpp"
+
+namespace dsa {
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+sharded_map<KEY_T, VAL_T, HASH_F>::sharded_map(size_t shards) :
+	m_shard_count(1),
+	m_shift(64) {
+
+	while (m_shard_count < shards) {
+		m_shard_count *= 2;
+		--m_shift;
+	}
+
+	m_shards.reset(new shard_entry[m_shard_count]);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+sharded_map<KEY_T, VAL_T, HASH_F>::sharded_map(const sharded_map& other) :
+	m_shard_count(other.m_shard_count),
+	m_shift(other.m_shift),
+	m_shards(new shard_entry[other.m_shard_count]) {
+
+	for (size_t i = 0; i < m_shard_count; ++i) {
+		m_shards[i].map = other.m_shards[i].map;
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+sharded_map<KEY_T, VAL_T, HASH_F>::sharded_map(sharded_map&& other) : sharded_map(1) {
+	swap(other);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+sharded_map<KEY_T, VAL_T, HASH_F>& sharded_map<KEY_T, VAL_T, HASH_F>::operator=(sharded_map rhs) {
+	swap(rhs);
+	return *this;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+bool sharded_map<KEY_T, VAL_T, HASH_F>::insert(pair_type value) {
+	size_t hash = HASH_F{}(value.first);
+	shard_entry& entry = entry_of(hash);
+	std::lock_guard<std::mutex> lock(entry.mutex);
+
+	return entry.map.insert(std::move(value), hash).second;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+template <typename KEY_F, typename VALUE_F>
+std::vector<uint8_t> sharded_map<KEY_T, VAL_T, HASH_F>::insert_bulk(thread_pool& pool, size_t count, KEY_F key,
+                                                                    VALUE_F value) {
+	std::vector<uint8_t> inserted(count, 0);
+
+	if (count == 0) {
+		return inserted;
+	}
+
+	// The indexes of each chunk bound for each shard, chunk-major
+	size_t chunks = pool.chunk_count(0, count, 0);
+	std::vector<std::vector<size_t>> routes(chunks * m_shard_count);
+	std::vector<size_t> hashes(count);
+
+	pool.parallel_for(0, count, chunks, [&](size_t chunk, size_t begin, size_t end) {
+		std::vector<size_t>* own = &routes[chunk * m_shard_count];
+
+		for (size_t i = begin; i < end; ++i) {
+			hashes[i] = HASH_F{}(key(i));
+			own[shard_index(hashes[i])].push_back(i);
+		}
+	});
+
+	// Walking the chunks in order keeps every shard's indexes ascending
+	pool.parallel_for(0, m_shard_count, m_shard_count, [&](size_t shard, size_t, size_t) {
+		shard_entry& entry = m_shards[shard];
+		std::lock_guard<std::mutex> lock(entry.mutex);
+
+		size_t routed = 0;
+
+		for (size_t chunk = 0; chunk < chunks; ++chunk) {
+			routed += routes[chunk * m_shard_count + shard].size();
+		}
+
+		entry.map.reserve(entry.map.size() + routed);
+
+		for (size_t chunk = 0; chunk < chunks; ++chunk) {
+			for (size_t i : routes[chunk * m_shard_count + shard]) {
+				inserted[i] = entry.map.insert(pair_type(key(i), value(i)), hashes[i]).second;
+			}
+		}
+	});
+
+	return inserted;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename sharded_map<KEY_T, VAL_T, HASH_F>::size_type sharded_map<KEY_T, VAL_T, HASH_F>::erase(const KEY_T& key) {
+	size_t hash = HASH_F{}(key);
+	shard_entry& entry = entry_of(hash);
+	std::lock_guard<std::mutex> lock(entry.mutex);
+
+	return entry.map.erase(key, hash);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void sharded_map<KEY_T, VAL_T, HASH_F>::clear() {
+	for (size_t i = 0; i < m_shard_count; ++i) {
+		m_shards[i].map.clear();
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void sharded_map<KEY_T, VAL_T, HASH_F>::swap(sharded_map& other) {
+	std::swap(m_shard_count, other.m_shard_count);
+	std::swap(m_shift, other.m_shift);
+	std::swap(m_shards, other.m_shards);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename sharded_map<KEY_T, VAL_T, HASH_F>::iterator sharded_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) {
+	size_t hash = HASH_F{}(key);
+	size_t shard = shard_index(hash);
+	auto it = m_shards[shard].map.find(key, hash);
+
+	return (it == m_shards[shard].map.end()) ? end() : iterator(this, shard, it);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename sharded_map<KEY_T, VAL_T, HASH_F>::const_iterator sharded_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) const {
+	size_t hash = HASH_F{}(key);
+	size_t shard = shard_index(hash);
+	auto it = m_shards[shard].map.find(key, hash);
+
+	return (it == m_shards[shard].map.end()) ? end() : const_iterator(this, shard, it);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+VAL_T& sharded_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) {
+	iterator it = find(key);
+
+	if (it == end()) {
+		throw std::invalid_argument("Key not found in map");
+	}
+
+	return it->second;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+const VAL_T& sharded_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) const {
+	const_iterator it = find(key);
+
+	if (it == end()) {
+		throw std::invalid_argument("Key not found in map");
+	}
+
+	return it->second;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename sharded_map<KEY_T, VAL_T, HASH_F>::size_type sharded_map<KEY_T, VAL_T, HASH_F>::size() const {
+	size_type total = 0;
+
+	for (size_t i = 0; i < m_shard_count; ++i) {
+		total += m_shards[i].map.size();
+	}
+
+	return total;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void sharded_map<KEY_T, VAL_T, HASH_F>::reserve(size_t count) {
+	// Shards fill unevenly, leave some room over an even share
+	size_t share = count / m_shard_count;
+
+	for (size_t i = 0; i < m_shard_count; ++i) {
+		m_shards[i].map.reserve(share + share / 8 + 1);
+	}
+}
+
+} // namespace dsa
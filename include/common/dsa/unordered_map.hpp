@@ -1,8 +1,10 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 #include "utility.hpp"
 #include "optional.hpp"
@@ -25,20 +27,26 @@ public:
 	using iterator = iterator_base<tagged_entry, pair_type>;
 	using const_iterator = iterator_base<const tagged_entry, const pair_type>;
 
-	unordered_map() :
-		m_size(0),
-		m_buckets(31),
-		m_table(new tagged_entry[m_buckets]) {}
+	unordered_map() : unordered_map(31) {}
 
 	unordered_map(size_t buckets) :
 		m_size(0),
+		m_sentinels(0),
 		m_buckets(next_prime(buckets)),
-		m_table(new tagged_entry[m_buckets]) {}
+		m_table(new tagged_entry[m_buckets]),
+		m_old_buckets(0),
+		m_migrated(0),
+		m_incremental(false) {}
 
 	unordered_map(unordered_map<KEY_T, VAL_T, HASH_F>&& other) :
 		m_size(other.m_size),
+		m_sentinels(other.m_sentinels),
 		m_buckets(other.m_buckets),
-		m_table(std::move(other.m_table)) {}
+		m_table(std::move(other.m_table)),
+		m_old_buckets(other.m_old_buckets),
+		m_old_table(std::move(other.m_old_table)),
+		m_migrated(other.m_migrated),
+		m_incremental(other.m_incremental) {}
 
 	unordered_map(const unordered_map<KEY_T, VAL_T, HASH_F>& other);
 
@@ -55,6 +63,13 @@ public:
 	 */
 	std::pair<iterator, bool> insert(pair_type value);
 
+	/**
+	 * @brief insert, with the key's hash already computed by the caller
+	 *
+	 * @param hash   @c HASH_F of the key
+	 */
+	std::pair<iterator, bool> insert(pair_type value, size_t hash);
+
 	/**
 	 * @brief Removes all elements from the map
 	 */
@@ -77,6 +92,7 @@ public:
 	 * @returns The number of nodes erased, 0 or 1
 	 */
 	size_type erase(const KEY_T& key);
+	size_type erase(const KEY_T& key, size_t hash);
 
 	/**
 	 * @brief Swap this map with another
@@ -101,17 +117,47 @@ public:
 	 * @returns true if a match was found, false otherwise
 	 */
 	bool contains(const KEY_T& key) const;
+	bool contains(const KEY_T& key, size_t hash) const;
 
 	/**
 	 * @brief Find an iterator to the given key
 	 *
-	 * @param key   Key of pair to find
+	 * @param key    Key of pair to find
+	 * @param hash   @c HASH_F of the key, if the caller already hashed it
 	 *
 	 * @returns @c iterator or @c const_iterator to the matching pair,
 	 * end if no match was found
 	 */
 	iterator find(const KEY_T& key);
 	const_iterator find(const KEY_T& key) const;
+	iterator find(const KEY_T& key, size_t hash);
+	const_iterator find(const KEY_T& key, size_t hash) const;
+
+	/**
+	 * @brief Finds many keys at once, overlapping their cache misses
+	 *
+	 * Every key is hashed first. Each key is then probed while the home
+	 * buckets of the next few are prefetched, so their loads are in flight
+	 * together instead of one after another.
+	 *
+	 * @returns An iterator per key, in order, end for keys not found
+	 */
+	std::vector<iterator> find_many(const KEY_T* keys, size_t count);
+	std::vector<const_iterator> find_many(const KEY_T* keys, size_t count) const;
+
+	/**
+	 * @brief Checks many keys at once, like find_many
+	 *
+	 * @returns 1 for each key found, 0 otherwise, in order
+	 */
+	std::vector<uint8_t> contains_many(const KEY_T* keys, size_t count) const;
+
+	/**
+	 * @brief Erases many keys at once, prefetching like find_many
+	 *
+	 * @returns The number of pairs erased
+	 */
+	size_type erase_many(const KEY_T* keys, size_t count);
 
 	/**
 	 * @brief Gets the corresponding value of a key
@@ -129,9 +175,18 @@ public:
 	const_iterator begin() const;
 	const_iterator cbegin() const;
 
-	iterator end() { return m_table.get() + m_buckets; }
-	const_iterator end() const { return m_table.get() + m_buckets; }
-	const_iterator cend() const { return m_table.get() + m_buckets; }
+	iterator end() { return iterator(table_end(), table_end()); }
+	const_iterator end() const { return const_iterator(table_end(), table_end()); }
+	const_iterator cend() const { return end(); }
+
+	size_type size() const { return m_size; }
+	bool empty() const { return m_size == 0; }
+	size_type bucket_count() const { return m_buckets; }
+
+	/**
+	 * @brief Number of sentinels left behind by erase, which probes walk past
+	 */
+	size_type sentinel_count() const { return m_sentinels; }
 
 	/**
 	 * @brief Calculate the current load factor
@@ -149,7 +204,29 @@ public:
 	 */
 	void reserve(size_t count);
 
+	/**
+	 * @brief Enables or disables incremental rehashing when growing
+	 *
+	 * When enabled, an insert that needs a larger table does not rebuild it
+	 * in one call. The old table is kept alongside the new one, and every
+	 * insert or erase by key moves a bounded number of old buckets across.
+	 * Lookups consult both tables until the move is complete, and iteration
+	 * visits the old table's remaining pairs first.
+	 *
+	 * Explicit calls to @c rehash and @c reserve still rebuild in one call.
+	 */
+	void incremental_rehash(bool enabled);
+	bool incremental_rehash() const { return m_incremental; }
+
+	/**
+	 * @brief Checks if an incremental rehash is still moving buckets
+	 */
+	bool migrating() const { return m_old_table != nullptr; }
+
 private:
+	static const size_t migrate_batch = 8; // Old buckets moved per operation
+	static const size_t prefetch_distance = 16; // Keys prefetched ahead by the bulk lookups
+
 	/**
 	 * @brief Calculate the offset for collision on the given attempt
 	 * 
@@ -158,14 +235,92 @@ private:
 	size_t collision_offset(size_t attempt) const;
 
 	/**
-	 * @brief Calculates the hash of a key for an attempt
+	 * @brief Calculates the bucket of a key's hash for an attempt, in a
+	 * table with the given number of buckets
+	 *
+	 * Keys are hashed once per operation, and the hash is kept in the entry
+	 */
+	size_t bucket(size_t hash, size_t attempt, size_t buckets) const;
+
+	/**
+	 * @brief Probes a table for key until a match or an empty entry
+	 *
+	 * @returns Index of the entry the probe stopped at
+	 */
+	size_t probe(const tagged_entry* table, size_t buckets, const KEY_T& key, size_t hash) const;
+
+	/**
+	 * @brief Finds the entry holding key in either table
+	 *
+	 * @returns The entry, or null if the key is absent
+	 */
+	const tagged_entry* locate(const KEY_T& key, size_t hash) const;
+
+	/**
+	 * @brief Prefetches the first bucket a hash probes in each table
+	 */
+	void prefetch_home(size_t hash) const;
+
+	/**
+	 * @brief Prefetches the out of line data of the key in a hash's home
+	 * bucket of the current table, if the hash matches
+	 */
+	void prefetch_key(size_t hash) const;
+
+	/**
+	 * @brief Locates every key, prefetching ahead, see find_many
+	 *
+	 * @param fn   Called as fn(index, entry) for each key in order, entry
+	 *             null if the key is absent
+	 */
+	template <typename FN_T>
+	void locate_many(const KEY_T* keys, size_t count, FN_T fn) const;
+
+	/**
+	 * @brief Grows the table, or purges sentinels, before an insert
+	 */
+	void grow();
+
+	/**
+	 * @brief Moves the current table aside and starts an incremental rehash
+	 */
+	void start_migration(size_t count);
+
+	/**
+	 * @brief Moves up to count buckets of the old table to the current one
+	 */
+	void migrate_step(size_t count);
+
+	/**
+	 * @brief Stores a pair known to be absent in the current table
+	 */
+	void place(pair_type pair, size_t hash);
+
+	bool in_old_table(const tagged_entry* entry) const {
+		return entry >= m_old_table.get() && entry < m_old_table.get() + m_old_buckets;
+	}
+
+	/**
+	 * @brief Makes an iterator to an entry of either table
 	 */
-	size_t hash(const KEY_T& key, size_t attempt) const;
+	template <typename IT_T, typename IT_ENTRY_T>
+	IT_T make_iterator(IT_ENTRY_T* entry) const;
+
+	tagged_entry* table_end() const { return m_table.get() + m_buckets; }
 
-	size_type m_size;
+	size_type m_size; // Pairs in both tables
+	size_type m_sentinels;
 	size_type m_buckets;
 	std::unique_ptr<tagged_entry[]> m_table;
 
+	// Table being moved into m_table by an incremental rehash, if any.
+	// Buckets before m_migrated have already been moved.
+	size_type m_old_buckets;
+	std::unique_ptr<tagged_entry[]> m_old_table;
+	size_type m_migrated;
+
+	bool m_incremental;
+
 	/**
 	 * Stores an entry in the hash table
 	 *
@@ -175,21 +330,33 @@ private:
 	 */
 	class tagged_entry {
 	public:
-		tagged_entry() : m_empty(true) {}
-		tagged_entry(pair_type entry) : m_empty(false), m_pair(entry) {}
+		tagged_entry() : m_empty(true), m_hash(0) {}
+		tagged_entry(pair_type entry, size_t hash) : m_empty(false), m_hash(hash), m_pair(entry) {}
 
 		bool empty() const { return m_empty; }
 		bool sentinel() const { return !m_empty && !m_pair.has_value(); }
 		bool full() const { return m_pair.has_value(); }
 
-		pair_type entry() { return m_pair; }
+		const pair_type& entry() const { return m_pair.value(); }
+
+		const KEY_T& key() const { return m_pair.value().first; }
 
-		KEY_T key() const { return m_pair.value().first; }
+		// Hash of the key, only valid when full
+		size_t hash() const { return m_hash; }
+
+		/**
+		 * @brief Checks for a key, comparing the cached hash first so most
+		 * mismatches skip the key comparison
+		 */
+		bool matches(const KEY_T& key, size_t hash) const {
+			return full() && m_hash == hash && m_pair.value().first == key;
+		}
 		VAL_T& value() { return m_pair.value().second; }
 		const VAL_T& value() const { return m_pair.value().second; }
 
-		void set_entry(pair_type entry) {
+		void set_entry(pair_type entry, size_t hash) {
 			m_empty = false;
+			m_hash = hash;
 
 			m_pair.reset();
 			m_pair.emplace(entry);
@@ -203,6 +370,7 @@ private:
 		friend class iterator_base;
 
 		bool m_empty;
+		size_t m_hash;
 		optional<pair_type> m_pair;
 	};
 
@@ -212,22 +380,38 @@ private:
 		template <typename OTH_IT_ENTRY_T, typename OTH_IT_PAIR_T>
 		friend class iterator_base;
 
-		iterator_base(IT_ENTRY_T* entry) : m_entry(entry) {}
+		friend class unordered_map;
+
+		iterator_base(IT_ENTRY_T* entry, IT_ENTRY_T* end) :
+			m_entry(entry),
+			m_end(end),
+			m_next(nullptr),
+			m_next_end(nullptr) {}
+
+		iterator_base(IT_ENTRY_T* entry, IT_ENTRY_T* end, IT_ENTRY_T* next, IT_ENTRY_T* next_end) :
+			m_entry(entry),
+			m_end(end),
+			m_next(next),
+			m_next_end(next_end) {}
 
 		template <typename OTH_IT_ENTRY_T, typename OTH_IT_PAIR_T>
-		iterator_base(iterator_base<OTH_IT_ENTRY_T, OTH_IT_PAIR_T> other) : m_entry(other.m_entry) {}
+		iterator_base(iterator_base<OTH_IT_ENTRY_T, OTH_IT_PAIR_T> other) :
+			m_entry(other.m_entry),
+			m_end(other.m_end),
+			m_next(other.m_next),
+			m_next_end(other.m_next_end) {}
 
 		using iterator_type = iterator_base<IT_ENTRY_T, IT_PAIR_T>;
 
 		iterator_type& operator++() {
-			while (*this != map->end() && !m_entry->full()){
-				++m_entry;
-			}
+			// Skip past the current entry, then any empty or sentinel entries
+			++m_entry;
+			settle();
 
 			return *this;
 		}
 
-		iterator_type operator++(int) const {
+		iterator_type operator++(int) {
 			iterator_type tmp = *this;
 			++(*this);
 			return tmp;
@@ -242,9 +426,36 @@ private:
 		IT_PAIR_T& operator*() const { return m_entry->m_pair.value(); }
 		IT_PAIR_T* operator->() const { return &m_entry->m_pair.value(); }
 
+		IT_ENTRY_T* entry() const { return m_entry; }
+
 	private:
-		const unordered_map<KEY_T, VAL_T>* map; // Map this iterator belongs to
+		/**
+		 * @brief Advances to the first full entry at or after the current one,
+		 * continuing into the next table at the end of the old one
+		 */
+		void settle() {
+			while (true) {
+				while (m_entry != m_end && !m_entry->full()) {
+					++m_entry;
+				}
+
+				if (m_entry != m_end || m_next == nullptr) {
+					return;
+				}
+
+				m_entry = m_next;
+				m_end = m_next_end;
+				m_next = nullptr;
+				m_next_end = nullptr;
+			}
+		}
+
 		IT_ENTRY_T* m_entry;
+		IT_ENTRY_T* m_end; // One past the last entry of the owning table
+
+		// Current table when iterating the old table of an incremental rehash
+		IT_ENTRY_T* m_next;
+		IT_ENTRY_T* m_next_end;
 	};
 };
 
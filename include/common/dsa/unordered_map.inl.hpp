@@ -2,7 +2,10 @@
 
 #include "unordered_map.hpp"
 
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include "stats.hpp"
 #include "utility.hpp"
 
 namespace dsa {
@@ -10,12 +13,21 @@ namespace dsa {
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 unordered_map<KEY_T, VAL_T, HASH_F>::unordered_map(const unordered_map<KEY_T, VAL_T, HASH_F>& other) :
 	m_size(other.m_size),
+	m_sentinels(other.m_sentinels),
 	m_buckets(other.m_buckets),
-	m_table(new tagged_entry[m_buckets]) {
+	m_table(new tagged_entry[m_buckets]),
+	m_old_buckets(other.m_old_buckets),
+	m_old_table(other.m_old_table ? new tagged_entry[m_old_buckets] : nullptr),
+	m_migrated(other.m_migrated),
+	m_incremental(other.m_incremental) {
 
 	for (size_t i = 0; i < m_buckets; ++i) {
 		m_table[i] = other.m_table[i];
 	}
+
+	for (size_t i = 0; i < m_old_buckets; ++i) {
+		m_old_table[i] = other.m_old_table[i];
+	}
 }
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
@@ -31,22 +43,55 @@ size_t unordered_map<KEY_T, VAL_T, HASH_F>::collision_offset(size_t attempt) con
 }
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
-size_t unordered_map<KEY_T, VAL_T, HASH_F>::hash(const KEY_T& key, size_t attempt) const {
-	return (HASH_F{}(key) + collision_offset(attempt)) % m_buckets;
+size_t unordered_map<KEY_T, VAL_T, HASH_F>::bucket(size_t hash, size_t attempt, size_t buckets) const {
+	return (hash + collision_offset(attempt)) % buckets;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+size_t unordered_map<KEY_T, VAL_T, HASH_F>::probe(const tagged_entry* table, size_t buckets, const KEY_T& key, size_t hash) const {
+	size_t attempt = 0;
+	size_t idx;
+
+	do {
+		idx = bucket(hash, attempt, buckets);
+		++attempt;
+		// Keep looking until we find an empty bucket, or the key matches cur attempt
+	} while (!table[idx].empty() && !table[idx].matches(key, hash));
+
+	PA3_STATS_RECORD(hash_probe_length, attempt);
+
+	return idx;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+template <typename IT_T, typename IT_ENTRY_T>
+IT_T unordered_map<KEY_T, VAL_T, HASH_F>::make_iterator(IT_ENTRY_T* entry) const {
+	if (in_old_table(entry)) {
+		return IT_T(entry, m_old_table.get() + m_old_buckets, m_table.get(), table_end());
+	}
+
+	return IT_T(entry, table_end());
 }
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 void unordered_map<KEY_T, VAL_T, HASH_F>::rehash(size_t count) {
+	PA3_STATS_TIMER(timer, rehash_ns);
+	PA3_STATS_INCREMENT(rehash_count);
+
 	size_t min_size = std::ceil(m_size / max_load_factor());
 
 	size_t requested_buckets = std::max(count, min_size);
 
 	unordered_map<KEY_T, VAL_T, HASH_F> new_map(requested_buckets);
+	new_map.m_incremental = m_incremental;
 
-	for (const pair_type& pair : *this) {
-		new_map.insert(pair);
+	// Also takes any pairs still waiting in an old table. Cached hashes
+	// are reused, keys are not hashed again.
+	for (const_iterator it = cbegin(); it != cend(); ++it) {
+		new_map.place(*it, it.entry()->hash());
 	}
-	
+
+	new_map.m_size = m_size;
 	swap(new_map);
 }
 
@@ -59,58 +104,408 @@ void unordered_map<KEY_T, VAL_T, HASH_F>::reserve(size_t count) {
 	}
 }
 
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::incremental_rehash(bool enabled) {
+	m_incremental = enabled;
+
+	if (!enabled) {
+		migrate_step(m_old_buckets);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::grow() {
+	size_t limit = max_load_factor() * m_buckets;
+
+	// Doubling keeps inserts amortized O(1). A table that filled up with
+	// sentinels rather than pairs is rebuilt at the same size to purge them.
+	size_t count = (2 * (m_size + 1) > limit) ? 2 * m_buckets : m_buckets;
+
+	if (m_incremental) {
+		start_migration(count);
+	} else {
+		rehash(count);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::start_migration(size_t count) {
+	PA3_STATS_INCREMENT(rehash_count);
+
+	// Only one old table at a time, finish any migration still running
+	migrate_step(m_old_buckets);
+
+	size_t min_size = std::ceil((m_size + 1) / max_load_factor());
+
+	m_old_table = std::move(m_table);
+	m_old_buckets = m_buckets;
+	m_migrated = 0;
+
+	m_buckets = next_prime(std::max(count, min_size));
+	m_table.reset(new tagged_entry[m_buckets]);
+	m_sentinels = 0;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::migrate_step(size_t count) {
+	if (!m_old_table) {
+		return;
+	}
+
+	size_t end = m_migrated + std::min(count, m_old_buckets - m_migrated);
+
+	// Moved pairs leave sentinels, so probes for the rest stay intact
+	for (; m_migrated < end; ++m_migrated) {
+		tagged_entry& entry = m_old_table[m_migrated];
+
+		if (entry.full()) {
+			place(entry.entry(), entry.hash());
+			entry.remove_entry();
+		}
+	}
+
+	if (m_migrated == m_old_buckets) {
+		m_old_table.reset();
+		m_old_buckets = 0;
+		m_migrated = 0;
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::place(pair_type pair, size_t hash) {
+	tagged_entry* pos;
+	size_t attempt = 0;
+
+	do {
+		pos = &m_table[bucket(hash, attempt++, m_buckets)];
+	} while (pos->full());
+
+	if (pos->sentinel()) {
+		--m_sentinels;
+	}
+
+	pos->set_entry(pair, hash);
+}
+
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 std::pair<typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator, bool> unordered_map<KEY_T, VAL_T, HASH_F>::insert(pair_type pair) {
-	reserve(m_size + 1);
+	size_t hash = HASH_F{}(pair.first);
+	return insert(std::move(pair), hash);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+std::pair<typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator, bool> unordered_map<KEY_T, VAL_T, HASH_F>::insert(pair_type pair, size_t hash) {
+	// Sentinels count towards the load, probes have to walk past them
+	if (m_size + m_sentinels + 1 > max_load_factor() * m_buckets) {
+		grow();
+	}
+
+	migrate_step(migrate_batch);
 
 	const KEY_T& key = pair.first;
 
+	if (m_old_table) {
+		size_t idx = probe(m_old_table.get(), m_old_buckets, key, hash);
+
+		if (m_old_table[idx].full()) {
+			return { make_iterator<iterator>(&m_old_table[idx]), false };
+		}
+	}
+
 	tagged_entry* pos;
+	tagged_entry* first_sentinel = nullptr;
 	size_t attempt = 0;
 
+	// Sentinels may be reused, but the key could still be further along the
+	// probe sequence. Keep looking until an empty entry or a match.
 	do {
-		pos = &m_table[hash(key, attempt++)];
-	} while (pos->full() && pos->key() != key);
+		pos = &m_table[bucket(hash, attempt++, m_buckets)];
+
+		if (pos->sentinel() && first_sentinel == nullptr) {
+			first_sentinel = pos;
+		}
+	} while (!pos->empty() && !pos->matches(key, hash));
+
+	PA3_STATS_RECORD(hash_probe_length, attempt);
 
 	// If the key was a duplicate, do not replace
-	if (pos->full() && pos->key() == key) {
-		return { pos, false };
-	} else {
-		pos->set_entry(pair);
-		return { pos, true };
+	if (pos->full()) {
+		return { iterator(pos, table_end()), false };
+	}
+
+	if (first_sentinel != nullptr) {
+		pos = first_sentinel;
+		--m_sentinels;
 	}
+
+	pos->set_entry(pair, hash);
+	++m_size;
+
+	return { iterator(pos, table_end()), true };
 }
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
-typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator unordered_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) {
-	size_t attempt = 0;
-	tagged_entry* entry = nullptr;
+void unordered_map<KEY_T, VAL_T, HASH_F>::clear() {
+	for (size_t i = 0; i < m_buckets; ++i) {
+		m_table[i] = tagged_entry();
+	}
 
-	do {
-		size_t idx = hash(key, attempt);
-		entry = &m_table[idx];
-		++attempt;
-		// Keep looking until we find an empty bucket, or the key matches cur attempt
-	} while (!entry->empty() && entry->key() != key);
+	m_old_table.reset();
+	m_old_buckets = 0;
+	m_migrated = 0;
+
+	m_size = 0;
+	m_sentinels = 0;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator unordered_map<KEY_T, VAL_T, HASH_F>::erase(iterator pos) {
+	iterator next = pos;
+	++next;
+
+	// Leaves a sentinel behind so probe sequences passing through stay intact
+	pos.entry()->remove_entry();
+	--m_size;
+
+	if (!in_old_table(pos.entry())) {
+		++m_sentinels;
+	}
+
+	return next;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::size_type unordered_map<KEY_T, VAL_T, HASH_F>::erase(const KEY_T& key) {
+	return erase(key, HASH_F{}(key));
+}
 
-	bool match = !entry->empty() && entry->key() == key;
-	return match ? entry : end();
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::size_type unordered_map<KEY_T, VAL_T, HASH_F>::erase(const KEY_T& key, size_t hash) {
+	migrate_step(migrate_batch);
+
+	iterator pos = find(key, hash);
+
+	if (pos == end()) {
+		return 0;
+	}
+
+	erase(pos);
+	return 1;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::swap(unordered_map<KEY_T, VAL_T, HASH_F>& other) {
+	std::swap(m_size, other.m_size);
+	std::swap(m_sentinels, other.m_sentinels);
+	std::swap(m_buckets, other.m_buckets);
+	std::swap(m_table, other.m_table);
+	std::swap(m_old_buckets, other.m_old_buckets);
+	std::swap(m_old_table, other.m_old_table);
+	std::swap(m_migrated, other.m_migrated);
+	std::swap(m_incremental, other.m_incremental);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::size_type unordered_map<KEY_T, VAL_T, HASH_F>::count(const KEY_T& key) const {
+	return contains(key);
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+bool unordered_map<KEY_T, VAL_T, HASH_F>::contains(const KEY_T& key) const {
+	return find(key) != end();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+bool unordered_map<KEY_T, VAL_T, HASH_F>::contains(const KEY_T& key, size_t hash) const {
+	return find(key, hash) != end();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator unordered_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) {
+	return find(key, HASH_F{}(key));
 }
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 typename unordered_map<KEY_T, VAL_T, HASH_F>::const_iterator unordered_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key) const {
-	size_t attempt = 0;
-	tagged_entry* entry = nullptr;
+	return find(key, HASH_F{}(key));
+}
 
-	do {
-		size_t idx = hash(key, attempt);
-		entry = &m_table[idx];
-		++attempt;
-		// Keep looking until we find an empty bucket, or the key matches cur attempt
-	} while (!entry->empty() && entry->key() != key);
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator unordered_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key, size_t hash) {
+	size_t idx = probe(m_table.get(), m_buckets, key, hash);
+
+	if (m_table[idx].full()) {
+		return iterator(&m_table[idx], table_end());
+	}
+
+	// Not moved across yet
+	if (m_old_table) {
+		idx = probe(m_old_table.get(), m_old_buckets, key, hash);
 
-	bool match = !entry->empty() && entry->key() == key;
-	return match ? entry : end();
+		if (m_old_table[idx].full()) {
+			return make_iterator<iterator>(&m_old_table[idx]);
+		}
+	}
+
+	return end();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::const_iterator unordered_map<KEY_T, VAL_T, HASH_F>::find(const KEY_T& key, size_t hash) const {
+	size_t idx = probe(m_table.get(), m_buckets, key, hash);
+
+	if (m_table[idx].full()) {
+		return const_iterator(&m_table[idx], table_end());
+	}
+
+	// Not moved across yet
+	if (m_old_table) {
+		idx = probe(m_old_table.get(), m_old_buckets, key, hash);
+
+		if (m_old_table[idx].full()) {
+			return make_iterator<const_iterator>(static_cast<const tagged_entry*>(&m_old_table[idx]));
+		}
+	}
+
+	return end();
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+std::vector<typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator> unordered_map<KEY_T, VAL_T, HASH_F>::find_many(const KEY_T* keys, size_t count) {
+	std::vector<iterator> found(count, end());
+
+	locate_many(keys, count, [&](size_t i, const tagged_entry* entry) {
+		if (entry != nullptr) {
+			found[i] = make_iterator<iterator>(const_cast<tagged_entry*>(entry));
+		}
+	});
+
+	return found;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+std::vector<typename unordered_map<KEY_T, VAL_T, HASH_F>::const_iterator> unordered_map<KEY_T, VAL_T, HASH_F>::find_many(const KEY_T* keys, size_t count) const {
+	std::vector<const_iterator> found(count, end());
+
+	locate_many(keys, count, [&](size_t i, const tagged_entry* entry) {
+		if (entry != nullptr) {
+			found[i] = make_iterator<const_iterator>(entry);
+		}
+	});
+
+	return found;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+std::vector<uint8_t> unordered_map<KEY_T, VAL_T, HASH_F>::contains_many(const KEY_T* keys, size_t count) const {
+	std::vector<uint8_t> found(count, 0);
+
+	locate_many(keys, count, [&](size_t i, const tagged_entry* entry) {
+		found[i] = entry != nullptr;
+	});
+
+	return found;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+typename unordered_map<KEY_T, VAL_T, HASH_F>::size_type unordered_map<KEY_T, VAL_T, HASH_F>::erase_many(const KEY_T* keys, size_t count) {
+	size_type erased = 0;
+
+	// Every key is located after the previous erase and its migration step,
+	// so the entries found are current
+	locate_many(keys, count, [&](size_t i, const tagged_entry* found) {
+		if (found != nullptr) {
+			tagged_entry* entry = const_cast<tagged_entry*>(found);
+
+			// Like erase(iterator), without looking for the next pair
+			entry->remove_entry();
+			--m_size;
+			++erased;
+
+			if (!in_old_table(entry)) {
+				++m_sentinels;
+			}
+		}
+
+		migrate_step(migrate_batch);
+	});
+
+	return erased;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+const typename unordered_map<KEY_T, VAL_T, HASH_F>::tagged_entry* unordered_map<KEY_T, VAL_T, HASH_F>::locate(const KEY_T& key, size_t hash) const {
+	size_t idx = probe(m_table.get(), m_buckets, key, hash);
+
+	if (m_table[idx].full()) {
+		return &m_table[idx];
+	}
+
+	if (m_old_table) {
+		idx = probe(m_old_table.get(), m_old_buckets, key, hash);
+
+		if (m_old_table[idx].full()) {
+			return &m_old_table[idx];
+		}
+	}
+
+	return nullptr;
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::prefetch_home(size_t hash) const {
+	prefetch(&m_table[bucket(hash, 0, m_buckets)]);
+
+	if (m_old_table) {
+		prefetch(&m_old_table[bucket(hash, 0, m_old_buckets)]);
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+void unordered_map<KEY_T, VAL_T, HASH_F>::prefetch_key(size_t hash) const {
+	const tagged_entry& home = m_table[bucket(hash, 0, m_buckets)];
+
+	if (home.full() && home.hash() == hash) {
+		prefetch_contents(home.key());
+	}
+}
+
+template <typename KEY_T, typename VAL_T, typename HASH_F>
+template <typename FN_T>
+void unordered_map<KEY_T, VAL_T, HASH_F>::locate_many(const KEY_T* keys, size_t count, FN_T fn) const {
+	std::vector<size_t> hashes(count);
+
+	for (size_t i = 0; i < count; ++i) {
+		if (i + prefetch_distance < count) {
+			prefetch_contents(keys[i + prefetch_distance]);
+		}
+
+		hashes[i] = HASH_F{}(keys[i]);
+	}
+
+	// Two stages ahead of the probes: the home buckets of the keys
+	// prefetch_distance ahead, then, once those buckets have likely
+	// arrived, the out of line data of the keys they hold, halfway ahead
+	size_t half = prefetch_distance / 2;
+
+	for (size_t i = 0; i < (count < prefetch_distance ? count : prefetch_distance); ++i) {
+		prefetch_home(hashes[i]);
+	}
+
+	for (size_t i = 0; i < std::min(count, half); ++i) {
+		prefetch_key(hashes[i]);
+	}
+
+	for (size_t i = 0; i < count; ++i) {
+		if (i + prefetch_distance < count) {
+			prefetch_home(hashes[i + prefetch_distance]);
+		}
+		if (i + half < count) {
+			prefetch_key(hashes[i + half]);
+		}
+
+		fn(i, locate(keys[i], hashes[i]));
+	}
 }
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
@@ -126,7 +521,7 @@ VAL_T& unordered_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) {
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 const VAL_T& unordered_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) const {
-	iterator it = find(key);
+	const_iterator it = find(key);
 
 	if (it == end()) {
 		throw std::invalid_argument("Key not found in map");
@@ -137,26 +532,28 @@ const VAL_T& unordered_map<KEY_T, VAL_T, HASH_F>::operator[](const KEY_T& key) c
 
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 typename unordered_map<KEY_T, VAL_T, HASH_F>::iterator unordered_map<KEY_T, VAL_T, HASH_F>::begin() {
-	tagged_entry* entry = m_table.get();
-	tagged_entry* end = m_table.get() + m_buckets;
-
-	while (entry != end && !entry->full()) {
-		++entry;
-	}
+	// Pairs still in the old table come first
+	iterator it = m_old_table
+		? iterator(m_old_table.get(), m_old_table.get() + m_old_buckets, m_table.get(), table_end())
+		: iterator(m_table.get(), table_end());
 
-	return entry;
+	it.settle();
+	return it;
 }
+
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 typename unordered_map<KEY_T, VAL_T, HASH_F>::const_iterator unordered_map<KEY_T, VAL_T, HASH_F>::begin() const {
-	tagged_entry* entry = m_table.get();
-	tagged_entry* end = m_table.get() + m_buckets;
+	const tagged_entry* table = m_table.get();
+	const tagged_entry* old_table = m_old_table.get();
 
-	while (entry != end && !entry->full()) {
-		++entry;
-	}
+	const_iterator it = old_table
+		? const_iterator(old_table, old_table + m_old_buckets, table, table_end())
+		: const_iterator(table, table_end());
 
-	return entry;
+	it.settle();
+	return it;
 }
+
 template <typename KEY_T, typename VAL_T, typename HASH_F>
 typename unordered_map<KEY_T, VAL_T, HASH_F>::const_iterator unordered_map<KEY_T, VAL_T, HASH_F>::cbegin() const {
 	return begin();
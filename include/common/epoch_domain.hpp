@@ -0,0 +1,209 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Epoch-based reclamation, deferring the freeing of memory that
+ * concurrent readers may still be traversing
+ *
+ * Readers pin the domain for as long as they hold pointers into a shared
+ * structure, with a guard. A writer that unlinks a node or table retires it
+ * instead of deleting it. The domain keeps a global epoch, which advances
+ * once every pinned thread has seen the current one; memory retired in an
+ * epoch is freed two epochs later, when no reader pinned before it was
+ * unlinked can still be running.
+ *
+ * Each thread keeps its own retire lists, one per epoch still in flight, so
+ * retiring never locks. A thread frees its lists in batches, once enough is
+ * retired, or when it calls quiescent() at a point where it holds no
+ * pointers, such as between REPL commands. What a thread still holds when
+ * it exits is handed to the domain and freed by the next thread to reclaim.
+ *
+ * Pinning is per thread and nests. The domain must outlive its guards, and
+ * no thread may use it while it is destroyed; everything still retired is
+ * freed then.
+ *
+ * @code
+ * {
+ *     epoch_domain::guard guard(epoch_domain::shared());
+ *     // ... read nodes ...
+ * }
+ *
+ * unlink(node);
+ * epoch_domain::shared().retire(node);
+ * @endcode
+ */
+class epoch_domain {
+private:
+	struct record;
+
+public:
+	static const size_t default_batch = 64;
+
+	/**
+	 * @param batch   Pointers a thread retires before trying to free them
+	 */
+	explicit epoch_domain(size_t batch = default_batch);
+
+	/**
+	 * @brief Frees everything still retired
+	 */
+	~epoch_domain();
+
+	epoch_domain(const epoch_domain&) = delete;
+	epoch_domain& operator=(const epoch_domain&) = delete;
+
+	/**
+	 * @brief Gets the process-wide domain
+	 */
+	static epoch_domain& shared();
+
+	/**
+	 * @brief Pins the calling thread for its scope, nothing retired while
+	 * it is pinned is freed
+	 */
+	class guard {
+	public:
+		explicit guard(epoch_domain& domain);
+		~guard();
+
+		guard(const guard&) = delete;
+		guard& operator=(const guard&) = delete;
+
+	private:
+		epoch_domain& m_domain;
+		record* m_record;
+	};
+
+	/**
+	 * @brief Frees ptr with delete once no pinned thread can reach it
+	 */
+	template <typename T>
+	void retire(T* ptr) {
+		retire(ptr, [](void* p) { delete static_cast<T*>(p); });
+	}
+
+	/**
+	 * @brief Frees ptr with deleter once no pinned thread can reach it
+	 */
+	void retire(void* ptr, void (*deleter)(void*));
+
+	/**
+	 * @brief Declares the calling thread holds no pointers into the domain,
+	 * then frees what it can
+	 *
+	 * Meant for the points between units of work, such as REPL commands.
+	 * The calling thread must not be pinned.
+	 */
+	void quiescent();
+
+	/**
+	 * @brief Tries to advance the epoch, then frees the calling thread's
+	 * retired memory that is safe to free
+	 *
+	 * @returns true if neither the calling thread nor any thread that
+	 * exited has anything left waiting
+	 */
+	bool reclaim();
+
+	/**
+	 * @brief Current global epoch
+	 */
+	uint64_t epoch() const { return m_epoch.load(std::memory_order_acquire); }
+
+	/**
+	 * @brief Pointers the calling thread retired that are not freed yet
+	 */
+	size_t pending();
+
+private:
+	struct retired {
+		void* ptr;
+		void (*deleter)(void*);
+	};
+
+	// Retired in one epoch, kept until the global epoch is two past it
+	struct retire_list {
+		uint64_t epoch = 0;
+		std::vector<retired> items;
+	};
+
+	static const uint64_t pinned = 1; // Low bit of a record's state
+
+	/**
+	 * @brief A thread's state in one domain, one cache line apart from the
+	 * others
+	 */
+	struct alignas(64) record {
+		record() : state(0), in_use(true) {}
+
+		// Plain new only aligns to 16 bytes before C++17
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr);
+
+		// Epoch seen when last pinned, shifted past the pinned bit
+		std::atomic<uint64_t> state;
+		std::atomic<bool> in_use;
+		record* next = nullptr;
+
+		// Owning thread only
+		size_t nesting = 0;
+		size_t pending = 0;       // Retired, not freed yet
+		size_t since_collect = 0; // Retired since the lists were last freed
+		retire_list lists[3];     // Indexed by epoch % 3
+	};
+
+	/**
+	 * @brief The records a thread holds in each domain it used, released
+	 * as the thread exits
+	 */
+	struct thread_records;
+
+	/**
+	 * @brief Record of the calling thread, claimed on first use
+	 */
+	record* local();
+
+	/**
+	 * @brief Claims a free record, or adds a new one
+	 */
+	record* acquire();
+
+	/**
+	 * @brief Hands a record's retired memory to the domain and frees the
+	 * record for another thread, called as its thread exits
+	 */
+	void release(record* rec);
+
+	/**
+	 * @brief Advances the global epoch if every pinned thread has seen it
+	 */
+	bool try_advance();
+
+	/**
+	 * @brief Frees a record's lists from two or more epochs ago
+	 */
+	void collect(record* rec);
+
+	/**
+	 * @brief Frees orphaned lists from two or more epochs ago, if no other
+	 * thread is doing so
+	 */
+	void collect_orphans();
+
+	static void free(retire_list& list);
+
+	const size_t m_batch;
+	const uint64_t m_serial; // Tells domains apart after one is destroyed
+
+	std::atomic<uint64_t> m_epoch;
+	std::atomic<record*> m_records; // Never shrinks until destruction
+
+	std::mutex m_orphans_mutex;
+	std::vector<retire_list> m_orphans; // Left by exited threads
+	std::atomic<bool> m_has_orphans;
+};
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace generator {
+
+struct GeneratorOptions {
+	size_t rows = 10000;
+	uint64_t seed = 42;
+	size_t categories = 200;   // Distinct category paths
+	double zipfExponent = 1.0; // Skew of products per category path, 0 is uniform
+	size_t textLength = 300;   // Approximate length of the long text columns
+};
+
+struct TraceOptions {
+	size_t queries = 10000;
+	uint64_t seed = 7;
+	double hitRatio = 0.8;  // Fraction of queries for ids/categories that exist
+	double listRatio = 0.1; // Fraction of queries that are listInventory
+};
+
+/**
+ * @brief Generates Amazon-style inventory CSVs of any size
+ *
+ * Produces the columns of the Amazon product dataset with a similar mix of
+ * empty, short and long text columns. Fields containing commas or quotes are
+ * quoted, with quotes escaped by a backslash as expected by CSV::Parsing.
+ *
+ * Every row is generated from its own seed, so a row's values (and its id)
+ * can be recomputed without generating the rows before it. That keeps memory
+ * constant no matter the row count, and lets query traces reference ids from
+ * any row.
+ *
+ * Each product's category path is drawn from a Zipfian distribution, so a
+ * few categories hold most of the products, like the real data.
+ */
+class InventoryGenerator {
+public:
+	explicit InventoryGenerator(const GeneratorOptions& options);
+
+	/**
+	 * @brief Writes the header and all rows
+	 */
+	void write(std::ostream& out) const;
+
+	void writeHeader(std::ostream& out) const;
+
+	/**
+	 * @brief Writes rows [begin, end)
+	 */
+	void writeRows(std::ostream& out, size_t begin, size_t end) const;
+
+	/**
+	 * @brief Gets the inventory id of a row
+	 */
+	std::string id(size_t row) const;
+
+	/**
+	 * @brief Gets an id guaranteed not to belong to any row
+	 */
+	std::string missingId(size_t n) const;
+
+	/**
+	 * @brief Gets the index of a row's category path
+	 */
+	size_t categoryOf(size_t row) const;
+
+	/**
+	 * @brief Gets a category path, e.g. "Toys & Games | Puzzles | Magnetic Puzzles"
+	 */
+	const std::string& categoryPath(size_t category) const { return categoryPaths_[category]; }
+	size_t categoryCount() const { return categoryPaths_.size(); }
+
+	/**
+	 * @brief Every individual category name that listInventory accepts
+	 */
+	const std::vector<std::string>& categoryNames() const { return categoryNames_; }
+
+	/**
+	 * @brief Draws a category path index with the Zipfian distribution
+	 *
+	 * @param uniform   Uniformly distributed value in [0, 1)
+	 */
+	size_t sampleCategory(double uniform) const;
+
+	const GeneratorOptions& options() const { return options_; }
+
+private:
+	void appendRow(std::string& buffer, size_t row) const;
+
+	GeneratorOptions options_;
+
+	std::vector<std::string> categoryPaths_;
+	std::vector<std::string> categoryNames_;
+	std::vector<double> categoryCdf_;
+};
+
+/**
+ * @brief Writes REPL commands querying a generated inventory, one per line
+ *
+ * Hits reference existing ids (uniformly) and categories (Zipfian), misses
+ * use ids and categories that do not exist. Can be piped into the REPL.
+ */
+void writeQueryTrace(const InventoryGenerator& generator, const TraceOptions& options, std::ostream& out);
+
+} // namespace generator
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "inventory/NumericColumns.hpp"
+
+namespace inventory {
+
+class Inventory;
+
+/**
+ * @brief Count, sum, min and max of a column over a group of products
+ *
+ * Missing values are skipped like SQL's NULL: count is the number of
+ * values present, and min and max are NaN if there are none.
+ */
+struct ColumnStats {
+	size_t products = 0; // Products in the group, with or without a value
+	size_t count = 0;
+	double sum = 0.0;
+	double min;
+	double max;
+
+	ColumnStats();
+
+	void add(double value);
+	void merge(const ColumnStats& other);
+	double mean() const;
+};
+
+/**
+ * @brief What an aggregate groups products by
+ */
+enum class GroupBy {
+	all,      // One group of every product
+	category, // Each category the product belongs to
+	brand
+};
+
+/**
+ * @brief Group name and the column's statistics over it
+ */
+using GroupStats = std::pair<std::string, ColumnStats>;
+
+/**
+ * @brief Computes a column's statistics per group, for the stats command
+ *
+ * Products are split into contiguous ranges aggregated in parallel on the
+ * shared thread_pool, each into its own partial result, merged at the end.
+ * Categories are dictionary encoded, so their partials are arrays indexed
+ * by category id. Brands are aggregated in a hash map keyed by name.
+ *
+ * A product in several categories counts towards each of them.
+ *
+ * @param threads   Ranges to split the products into, 0 for one per pool
+ *                  thread but no more than the products are worth
+ *
+ * @returns The groups sorted by name, without empty groups
+ */
+std::vector<GroupStats> aggregate(const Inventory& inventory, NumericColumns::Column column, GroupBy by, size_t threads = 0);
+
+} // namespace inventory
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace inventory {
+
+struct Product;
+
+/**
+ * @brief Time one stage of loading an inventory took, see Inventory::loadFile
+ */
+struct LoadStage {
+	std::string name;
+	double milliseconds;
+	bool concurrent; // Ran alongside the other concurrent stages
+};
+
+/**
+ * @brief Reads a whole file into memory
+ *
+ * The file is read in large blocks with the next few always in flight, see
+ * read_ahead, so a cold page cache doesn't stall on every block.
+ *
+ * @throws std::runtime_error if the file can't be opened or read
+ */
+std::string readFile(const std::string& filename);
+
+/**
+ * @brief Parses inventory CSV text into products, without building CSVData
+ *
+ * The text after the header line is split into chunks at line boundaries,
+ * parsed in parallel on the shared thread_pool and concatenated in order.
+ * Rows are split like CSVReader splits them, without column types. Products
+ * keep file order, rows without an id are skipped but duplicates are kept.
+ *
+ * @param texts      Receives each product's description text
+ * @param threads    Chunks to split the text into, 0 for one per pool
+ *                   thread
+ *
+ * @throws std::invalid_argument if the CSV has no "Uniq Id" column
+ */
+void parseProducts(const std::string& csv, std::vector<Product>& products, std::vector<std::string>& texts,
+                   size_t threads = 0);
+
+} // namespace inventory
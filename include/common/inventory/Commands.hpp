@@ -0,0 +1,70 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+
+#include "Inventory.hpp"
+
+namespace inventory {
+
+/**
+ * @brief Runs the REPL's find command, printing the product's details
+ *
+ * Prints "Inventory not found" if no product has the given id.
+ */
+void findCommand(const Inventory& inventory, const std::string& id, std::ostream& out);
+
+/**
+ * @brief Runs the REPL's listInventory command
+ *
+ * Prints the id and name of every product in the category, or
+ * "Invalid Category" if the category doesn't exist. The category may be
+ * followed by "order by <column> [asc|desc]" to order the products by a
+ * numeric column, see SortedListing, and then by "limit N" to list only
+ * the first N.
+ */
+void listInventoryCommand(const Inventory& inventory, const std::string& argument, std::ostream& out);
+
+/**
+ * @brief Runs the REPL's search command, listing products by name
+ *
+ * Prints the id and name of the best matching products, see
+ * Inventory::search, or "No matching products". The argument may end in
+ * "limit N" to list up to N products instead of 10.
+ */
+void searchCommand(const Inventory& inventory, const std::string& argument, std::ostream& out);
+
+/**
+ * @brief Runs the REPL's searchText command, listing products by keywords
+ * in their description
+ *
+ * Lists products like searchCommand, ranked by Inventory::searchText. Words
+ * are all required unless separated by "OR".
+ */
+void searchTextCommand(const Inventory& inventory, const std::string& argument, std::ostream& out);
+
+/**
+ * @brief Runs the REPL's where command, listing products by numeric filter
+ *
+ * Lists the id and name of the first products matching a Filter, such as
+ * "price < 20 and rating >= 4", followed by the number of matches. The
+ * argument may end in "limit N" to list up to N products instead of 10.
+ * Prints "Invalid filter: " and the reason if the filter doesn't parse.
+ */
+void whereCommand(const Inventory& inventory, const std::string& argument, std::ostream& out);
+
+/**
+ * @brief Runs the REPL's stats command, summarizing a numeric column
+ *
+ * The argument is a column name, optionally followed by "by category" or
+ * "by brand". Prints a line per group with the count, sum, min, max and
+ * average of the values present, see aggregate.
+ */
+void statsCommand(const Inventory& inventory, const std::string& argument, std::ostream& out);
+
+/**
+ * @brief Gets the argument of a REPL command, the trimmed text after its name
+ */
+std::string commandArgument(const std::string& line, const std::string& command);
+
+} // namespace inventory
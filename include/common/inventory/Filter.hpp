@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "inventory/NumericColumns.hpp"
+#include "inventory/Scan.hpp"
+
+namespace inventory {
+
+/**
+ * @brief A predicate over the numeric columns, compiled for scanning
+ *
+ * Parsed from conditions like "price < 20 and rating >= 4 or stock > 0",
+ * comparing a column with a number using <, <=, >, >=, = (or ==) and !=.
+ * "and" binds tighter than "or", there are no parentheses.
+ *
+ * Each condition runs as one comparison kernel over its column, producing a
+ * selection bitmap. Conditions joined by "and" are combined with bitwise
+ * AND, alternatives with bitwise OR. Rows are processed in blocks, so the
+ * intermediate bitmaps stay in cache and every column is read once.
+ */
+class Filter {
+public:
+	/**
+	 * @throws std::invalid_argument describing the first syntax error
+	 */
+	explicit Filter(const std::string& text);
+
+	/**
+	 * @brief Finds the rows matching the filter
+	 *
+	 * @returns A selection bitmap of selectionWords(columns.rows()) words
+	 */
+	std::vector<uint64_t> select(const NumericColumns& columns) const;
+
+	/**
+	 * @brief select with a given instruction set, which must be supported
+	 */
+	std::vector<uint64_t> select(const NumericColumns& columns, ScanIsa isa) const;
+
+private:
+	static const size_t blockRows = 16384; // 2 KiB of bitmap per block
+
+	struct Condition {
+		NumericColumns::Column column;
+		CompareOp op;
+		double operand;
+	};
+
+	// Alternatives of conditions that must all hold
+	std::vector<std::vector<Condition>> alternatives_;
+};
+
+} // namespace inventory
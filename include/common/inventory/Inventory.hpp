@@ -0,0 +1,291 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "CSV/CSVData.hpp"
+#include "CSV/CSVRow.hpp"
+#include "CSV/CSVValue.hpp"
+#include "dsa/bloom_filter.hpp"
+#include "dsa/frozen_map.hpp"
+#include "dsa/hash.hpp"
+#include "dsa/sharded_map.hpp"
+#include "dsa/unordered_map.hpp"
+#include "inventory/Bootstrap.hpp"
+#include "inventory/Filter.hpp"
+#include "inventory/NameIndex.hpp"
+#include "inventory/NumericColumns.hpp"
+#include "inventory/TextIndex.hpp"
+
+namespace inventory {
+
+/**
+ * @brief A single product loaded from the inventory CSV
+ */
+struct Product {
+	std::string id;
+	std::string name;
+	std::string brand;
+	std::string asin;
+	std::string category; // Raw category string, e.g. "Toys & Games | Puzzles"
+	double price;         // Selling price, NaN if missing or unparseable
+
+	// Other numeric attributes, NaN if missing or unparseable
+	double listPrice = std::numeric_limits<double>::quiet_NaN();
+	double rating = std::numeric_limits<double>::quiet_NaN();
+	double quantity = std::numeric_limits<double>::quiet_NaN();
+	double stock = std::numeric_limits<double>::quiet_NaN();
+
+	// Dictionary-encoded categories this product belongs to, see Inventory::categoryName
+	std::vector<size_t> categories;
+};
+
+/**
+ * @brief Locates the columns of an inventory CSV by their case-insensitive
+ * header names and fills in products from their cells
+ */
+class ProductColumns {
+public:
+	/**
+	 * @throws std::invalid_argument if the header has no "Uniq Id" column
+	 */
+	explicit ProductColumns(const CSV::CSVRow& header);
+
+	/**
+	 * @brief Sets the product field of column col from a cell
+	 *
+	 * Numeric cells may be typed or text, text is parsed like a price. The
+	 * description cells are appended to text, each followed by a space.
+	 */
+	void set(Product& product, std::string& text, size_t col, const CSV::CSVValue& cell) const;
+	void set(Product& product, std::string& text, size_t col, const std::string& cell) const;
+
+private:
+	double* number(Product& product, size_t col) const;
+
+	size_t id_;
+	size_t name_;
+	size_t brand_;
+	size_t asin_;
+	size_t category_;
+	size_t price_;
+	size_t listPrice_;
+	size_t rating_;
+	size_t quantity_;
+	size_t stock_;
+	size_t about_;
+	size_t description_;
+};
+
+/**
+ * @brief In-memory inventory with the indexes needed by the REPL commands
+ *
+ * Products are stored contiguously and referenced by their position. The id
+ * index maps an inventory id (the "Uniq Id" column) to that position, the
+ * category index maps each category to the positions of its products.
+ *
+ * A product's category string is split on '|', so a product categorized as
+ * "Toys & Games | Puzzles" is listed under both "Toys & Games" and "Puzzles".
+ *
+ * Loading fills the id index as a sharded hash map, every shard from its
+ * own thread. Once loaded it is frozen into a perfect hash map, so find
+ * never probes. Adding a product afterwards thaws it back into shards.
+ *
+ * Lookups of ids that don't exist are mostly answered by a Bloom filter of
+ * the ids, built alongside the index, without touching the index at all.
+ *
+ * Numeric attributes are also kept column by column, see NumericColumns,
+ * for filters that scan every product. load sorts them for ordered
+ * listings, adding a product afterwards drops the sort orders.
+ *
+ * The "About Product" and "Product Description" text of loaded products is
+ * indexed for keyword search. It is not kept, so products added afterwards
+ * can't be found by it.
+ *
+ * Loading builds the indexes concurrently on the shared thread_pool, each
+ * split into chunks, once duplicates are dropped and the products'
+ * positions are final.
+ */
+class Inventory {
+public:
+	Inventory() {}
+	explicit Inventory(const CSV::CSVData& csv) { load(csv); }
+
+	/**
+	 * @brief Loads all products from parsed CSV data, replacing any existing
+	 *
+	 * Columns are located by their header name. The id column is required.
+	 * The id index is frozen afterwards, see @c freeze.
+	 *
+	 * @throws std::invalid_argument if the CSV has no "Uniq Id" column
+	 */
+	void load(const CSV::CSVData& csv);
+
+	/**
+	 * @brief Loads all products from an inventory CSV file, replacing any
+	 * existing
+	 *
+	 * Like load, but the file is parsed straight into products in chunks in
+	 * parallel, see parseProducts, without building CSVData.
+	 *
+	 * @param threads    Chunks each stage is split into, 0 for one per pool
+	 *                   thread
+	 *
+	 * @returns The time each stage took, in order. Index builders run
+	 * concurrently, loading takes as long as the slowest of them.
+	 *
+	 * @throws std::runtime_error if the file can't be read
+	 * @throws std::invalid_argument if the CSV has no "Uniq Id" column
+	 */
+	std::vector<LoadStage> loadFile(const std::string& filename, size_t threads = 0);
+
+	/**
+	 * @brief Adds a single product and indexes it
+	 *
+	 * @returns false if a product with the same id already exists
+	 */
+	bool add(Product product);
+
+	/**
+	 * @brief Find a product by its inventory id
+	 *
+	 * @returns Pointer to the product, nullptr if no product matches
+	 */
+	const Product* find(const std::string& id) const;
+
+	/**
+	 * @brief Rebuilds the id index as a read-only perfect hash map
+	 *
+	 * The next call to add converts it back. If no perfect hash can be
+	 * built, such as when two ids share a key hash, the index is left
+	 * mutable and frozen() stays false.
+	 */
+	void freeze();
+	bool frozen() const { return !frozenIds_.empty(); }
+
+	/**
+	 * @brief Sets the false positive rate of the id filter and rebuilds it
+	 *
+	 * @param rate   Fraction of missing ids let through to the index, 0
+	 *               disables the filter
+	 */
+	void setIdFilterRate(double rate);
+	double idFilterRate() const { return idFilterRate_; }
+
+	/**
+	 * @brief Gets the positions of all products in a category
+	 *
+	 * @returns Pointer to the product positions, nullptr if the category
+	 * does not exist
+	 */
+	const std::vector<size_t>* category(const std::string& name) const;
+
+	/**
+	 * @brief Gets the id of a category, see categoryName
+	 *
+	 * @returns The id, or noCategory if the category does not exist
+	 */
+	size_t findCategory(const std::string& name) const;
+	static const size_t noCategory = SIZE_MAX;
+
+	/**
+	 * @brief Finds the products whose name best matches text, see
+	 * NameIndex::search
+	 *
+	 * @returns Up to limit product positions, best match first
+	 */
+	std::vector<size_t> search(const std::string& text, size_t limit) const { return nameIndex_.search(products_, text, limit); }
+
+	/**
+	 * @brief Finds the loaded products whose description matches a keyword
+	 * query, see TextIndex::search
+	 *
+	 * @returns Up to limit product positions, best match first
+	 */
+	std::vector<size_t> searchText(const std::string& query, size_t limit) const { return textIndex_.search(query, limit); }
+	const TextIndex& textIndex() const { return textIndex_; }
+
+	/**
+	 * @brief Finds the products matching a filter, see Filter
+	 *
+	 * @returns A selection bitmap over product positions
+	 */
+	std::vector<uint64_t> select(const Filter& filter) const { return filter.select(columns_); }
+	const NumericColumns& columns() const { return columns_; }
+
+	const Product& product(size_t pos) const { return products_[pos]; }
+	const std::vector<Product>& products() const { return products_; }
+	size_t size() const { return products_.size(); }
+
+	const std::string& categoryName(size_t category) const { return categoryNames_[category]; }
+	const std::vector<size_t>& categoryMembers(size_t category) const { return categoryMembers_[category]; }
+	size_t categoryCount() const { return categoryNames_.size(); }
+
+	void clear();
+
+private:
+	/**
+	 * @brief Replaces the inventory with products parsed in file order and
+	 * builds every index
+	 *
+	 * Products without an id or with the id of an earlier product are
+	 * dropped first.
+	 *
+	 * @returns The time each stage took
+	 */
+	std::vector<LoadStage> build(std::vector<Product> products, std::vector<std::string> texts, size_t threads);
+
+	/**
+	 * @brief Dictionary-encodes the categories of every product, in chunks in
+	 * parallel
+	 */
+	void buildCategories(size_t threads);
+
+	/**
+	 * @brief Gets the dictionary id of a category, creating it if necessary
+	 */
+	size_t categoryId(const std::string& name);
+
+	/**
+	 * @brief Moves the frozen id index back into the hash map index
+	 */
+	void thaw();
+
+	/**
+	 * @brief Empties the id filter and sizes it for capacity ids
+	 */
+	void resetIdFilter(size_t capacity);
+
+	std::vector<Product> products_;
+	NumericColumns columns_;
+
+	// Only one of the id indexes is populated at a time
+	dsa::sharded_map<std::string, size_t, dsa::wyhash> idIndex_;
+	dsa::frozen_map<std::string, size_t, dsa::wyhash> frozenIds_;
+
+	dsa::bloom_filter<std::string, dsa::wyhash> idFilter_;
+	double idFilterRate_ = 0.01;
+
+	dsa::unordered_map<std::string, size_t, dsa::wyhash> categoryIndex_;
+	std::vector<std::string> categoryNames_;
+	std::vector<std::vector<size_t>> categoryMembers_;
+
+	NameIndex nameIndex_; // Built by load, later products are scanned
+	TextIndex textIndex_; // Built by load, later products are not indexed
+};
+
+/**
+ * @brief Splits a raw category string into its trimmed components
+ */
+std::vector<std::string> splitCategories(const std::string& category);
+
+/**
+ * @brief Parses a price such as "$12.99", returning NaN if there is none
+ *
+ * Ranges like "$12.99 - $15.99" use the lower bound.
+ */
+double parsePrice(const std::string& price);
+
+} // namespace inventory
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace inventory {
+
+struct Product;
+
+/**
+ * @brief Search index over product names, for partial and misspelled names
+ *
+ * Names are split into lowercase words. A sorted dictionary of every word,
+ * each with the sorted positions of the products using it, answers prefix
+ * searches with a binary search.
+ *
+ * Misspelled words are corrected against the dictionary rather than the
+ * products: a trigram index over the dictionary's words finds those within
+ * a small edit distance, and their products are then searched like a
+ * prefix. Both costs grow with the vocabulary and the number of matches,
+ * never with the number of products, so searches don't scan rows.
+ *
+ * Products added after the index was built are scanned on every search
+ * until it is rebuilt.
+ */
+class NameIndex {
+public:
+	/**
+	 * @brief Indexes the names of all products, replacing any existing
+	 *
+	 * The products are split into contiguous chunks indexed in parallel on
+	 * the shared thread_pool, then the chunks' lists are concatenated in
+	 * order.
+	 *
+	 * @param threads    Chunks to split the products into, 0 for one per
+	 *                   pool thread
+	 *
+	 * @throws std::length_error if there are more products than positions
+	 * fit in 32 bits
+	 */
+	void build(const std::vector<Product>& products, size_t threads = 0);
+
+	/**
+	 * @brief Finds the products whose name best matches text
+	 *
+	 * Every word of text must start a word of the name. Names needing
+	 * corrections come after those that don't, fewest edits first; a
+	 * corrected word must be within the allowed edits of a whole word of
+	 * the name, not just its start. Words of 3 to 7 characters allow one
+	 * edit, longer words two.
+	 *
+	 * @param products   The products the index was built from, possibly
+	 *                   with more added since
+	 *
+	 * @returns Up to limit product positions, best match first
+	 */
+	std::vector<size_t> search(const std::vector<Product>& products, const std::string& text, size_t limit) const;
+
+	/**
+	 * @brief Number of products in the index, later ones are scanned
+	 */
+	size_t indexed() const { return indexed_; }
+
+	void clear();
+
+private:
+	/**
+	 * @brief Half-open range of dictionary words
+	 */
+	using WordRange = std::pair<size_t, size_t>;
+
+	/**
+	 * @brief Dictionary word and its edit distance from a query word
+	 */
+	using Correction = std::pair<size_t, size_t>;
+
+	WordRange prefixRange(const std::string& prefix) const;
+	size_t postingCount(size_t word) const { return wordOffsets_[word + 1] - wordOffsets_[word]; }
+
+	/**
+	 * @brief Appends products with a word starting with each query word
+	 */
+	void prefixMatches(const std::vector<Product>& products, const std::vector<std::string>& query,
+	                   size_t limit, std::vector<size_t>& results) const;
+
+	/**
+	 * @brief Appends products matching the query after correcting words
+	 */
+	void fuzzyMatches(const std::vector<Product>& products, const std::vector<std::string>& query,
+	                  size_t limit, std::vector<size_t>& results) const;
+
+	/**
+	 * @brief Finds the dictionary words within maxEdits of word
+	 */
+	std::vector<Correction> corrections(const std::string& word, size_t maxEdits) const;
+
+	size_t indexed_ = 0;
+
+	// Postings of words_[i] are wordPostings_[wordOffsets_[i], wordOffsets_[i + 1])
+	std::vector<std::string> words_; // Sorted
+	std::vector<uint32_t> wordOffsets_;
+	std::vector<uint32_t> wordPostings_;
+
+	// Same layout, mapping the trigrams of each padded word to its index in
+	// words_. Trigrams are three bytes packed into the low 24 bits.
+	std::vector<uint32_t> trigrams_; // Sorted
+	std::vector<uint32_t> trigramOffsets_;
+	std::vector<uint32_t> trigramWords_;
+};
+
+/**
+ * @brief Splits a name into lowercase words of letters, digits and
+ * non-ASCII characters
+ */
+std::vector<std::string> nameWords(const std::string& name);
+
+/**
+ * @brief Gets the sorted, distinct trigrams of a word padded by a space on
+ * each side
+ */
+std::vector<uint32_t> wordTrigrams(const std::string& word);
+
+/**
+ * @brief Edits allowed in a query word of the given length
+ */
+size_t allowedEdits(size_t length);
+
+/**
+ * @brief Optimal string alignment distance, counting insertions, deletions,
+ * substitutions and transpositions of adjacent characters
+ *
+ * @returns The distance, or bound + 1 if it is larger than bound
+ */
+size_t editDistance(const std::string& a, const std::string& b, size_t bound);
+
+} // namespace inventory
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace inventory {
+
+struct Product;
+
+/**
+ * @brief The numeric attributes of every product, stored column by column
+ *
+ * Row i of each column belongs to the product at position i. Filters and
+ * aggregates scan a column as one contiguous array of doubles instead of
+ * visiting each product, or each CSV cell. Missing values are NaN, which
+ * compares false against everything but "!=".
+ *
+ * Each column can also keep its rows sorted by value, so ordered listings
+ * read the rows in order instead of sorting them.
+ */
+class NumericColumns {
+public:
+	enum Column {
+		price,
+		listPrice,
+		rating,
+		quantity,
+		stock,
+		columnCount
+	};
+
+	/**
+	 * @brief Appends a product's attributes as the next row
+	 *
+	 * Discards the sort orders, see buildSortOrders.
+	 */
+	void append(const Product& product);
+
+	/**
+	 * @brief Sorts the rows of every column, the columns in parallel on the
+	 * shared thread_pool
+	 *
+	 * Does nothing if there are more rows than fit in 32 bits.
+	 */
+	void buildSortOrders();
+	bool sorted() const { return sorted_; }
+
+	/**
+	 * @brief Gets the rows by ascending value, ties in row order, rows with
+	 * missing values last in row order
+	 *
+	 * Empty unless sorted.
+	 */
+	const std::vector<uint32_t>& sortOrder(Column column) const { return sortOrders_[column]; }
+
+	/**
+	 * @brief Number of rows with a value, which come first in sortOrder
+	 */
+	size_t presentCount(Column column) const { return presentCounts_[column]; }
+
+	const std::vector<double>& column(Column column) const { return columns_[column]; }
+	size_t rows() const { return columns_[price].size(); }
+
+	void reserve(size_t rows);
+	void clear();
+
+	/**
+	 * @brief Gets a column's name in queries, e.g. "list_price"
+	 */
+	static const char* name(Column column);
+
+	/**
+	 * @brief Finds a column by its case-insensitive name
+	 *
+	 * @returns The column, or columnCount if there is none
+	 */
+	static Column find(const std::string& name);
+
+private:
+	void sortColumn(Column column);
+
+	std::vector<double> columns_[columnCount];
+
+	std::vector<uint32_t> sortOrders_[columnCount];
+	size_t presentCounts_[columnCount] = {};
+	bool sorted_ = false;
+};
+
+} // namespace inventory
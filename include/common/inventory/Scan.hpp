@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace inventory {
+
+/**
+ * @brief Comparison applied by a scan, value op operand
+ */
+enum class CompareOp {
+	less,
+	lessEqual,
+	greater,
+	greaterEqual,
+	equal,
+	notEqual
+};
+
+/**
+ * @brief Instruction set used by the scan kernels
+ */
+enum class ScanIsa {
+	scalar,
+	sse2,
+	avx2
+};
+
+/**
+ * @brief Gets the widest instruction set the running CPU supports
+ */
+ScanIsa bestScanIsa();
+
+const char* scanIsaName(ScanIsa isa);
+
+/**
+ * @brief Words in a selection bitmap of count rows
+ */
+inline size_t selectionWords(size_t count) { return (count + 63) / 64; }
+
+/**
+ * @brief Compares every value against an operand, setting bit i of the
+ * selection bitmap if values[i] op operand holds
+ *
+ * Comparisons follow C++: NaN matches only notEqual. Bits past count in the
+ * last word are cleared. Uses the best instruction set, see bestScanIsa.
+ *
+ * @param selection   selectionWords(count) words to overwrite
+ */
+void compareScan(const double* values, size_t count, CompareOp op, double operand, uint64_t* selection);
+
+/**
+ * @brief compareScan with a given instruction set, which must be supported
+ */
+void compareScan(ScanIsa isa, const double* values, size_t count, CompareOp op, double operand, uint64_t* selection);
+
+/**
+ * @brief dst &= src over words
+ */
+void selectionAnd(uint64_t* dst, const uint64_t* src, size_t words);
+
+/**
+ * @brief dst |= src over words
+ */
+void selectionOr(uint64_t* dst, const uint64_t* src, size_t words);
+
+/**
+ * @brief Counts the selected rows
+ */
+size_t selectionCount(const uint64_t* selection, size_t words);
+
+/**
+ * @brief Calls fn(row) for each selected row in order, until it returns
+ * false
+ */
+template <typename FN_T>
+void forEachSelected(const uint64_t* selection, size_t words, FN_T fn) {
+	for (size_t w = 0; w < words; ++w) {
+		for (uint64_t bits = selection[w]; bits != 0; bits &= bits - 1) {
+			if (!fn(w * 64 + __builtin_ctzll(bits))) {
+				return;
+			}
+		}
+	}
+}
+
+} // namespace inventory
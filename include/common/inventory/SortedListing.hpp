@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "inventory/NumericColumns.hpp"
+
+namespace inventory {
+
+class Inventory;
+
+/**
+ * @brief Lists a category's products ordered by a numeric column, one at a
+ * time, for listInventory's "order by"
+ *
+ * Products are produced as soon as their place is known, so the first ones
+ * can be printed while the rest are still being ordered. Products missing
+ * the value come last in position order. In descending order ties are
+ * reversed too, making it the exact reverse of ascending order.
+ *
+ * There are two strategies:
+ *  - Large categories, unless the limit is large compared to the category,
+ *    walk the column's sort order, see NumericColumns::sortOrder, skipping
+ *    products of other categories. Without sorting anything, a page of a
+ *    category holding a twentieth of the products takes about twenty times
+ *    the page in steps, and a whole category at most a step per product.
+ *  - Otherwise the first page of the category's products is selected with
+ *    nth_element and sorted, so it is ready after a single pass. The rest,
+ *    up to the limit, is then selected and sorted the same way. A limit of
+ *    N costs O(n + N log N) instead of O(n log n).
+ */
+class SortedListing {
+public:
+	static const size_t unlimited = SIZE_MAX;
+
+	/**
+	 * @param category   Id of the category to list, see
+	 *                   Inventory::findCategory
+	 * @param limit      Products to list at most
+	 */
+	SortedListing(const Inventory& inventory, size_t category, NumericColumns::Column column,
+	              bool descending, size_t limit = unlimited);
+
+	/**
+	 * @brief Gets the position of the next product
+	 *
+	 * @returns false once every product, or limit products, were listed
+	 */
+	bool next(size_t& pos);
+
+	/**
+	 * @brief Checks if the column's sort order is walked, rather than the
+	 * category's products selected
+	 */
+	bool walking() const { return walk_; }
+
+private:
+	static const size_t firstPage = 16;
+
+	bool nextInOrder(size_t& pos);
+	bool nextSelected(size_t& pos);
+	bool isMember(size_t row) const;
+	bool ordered(size_t a, size_t b) const;
+
+	const Inventory& inventory_;
+	size_t category_;
+	const std::vector<double>& values_;
+	bool descending_;
+	size_t remaining_;
+
+	bool walk_;
+
+	// Walking the sort order, until every member was found
+	const std::vector<uint32_t>& order_;
+	size_t present_;
+	size_t step_ = 0;
+	size_t unlisted_;
+	std::vector<bool> isMember_; // Only for long walks
+
+	// Selecting from the members, those with a value first. The first
+	// selected_ are in their final order, and the first listed_ of those
+	// were returned. Positions are kept whole, as this is also how lists
+	// are made when there are too many rows for the 32 bit sort orders.
+	std::vector<size_t> rows_;
+	size_t presentRows_ = 0;
+	size_t selected_ = 0;
+	size_t listed_ = 0;
+	size_t page_ = firstPage; // Then the rest
+};
+
+} // namespace inventory
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace inventory {
+
+/**
+ * @brief Inverted index for keyword search over long product text, such
+ * as the descriptions
+ *
+ * Every word maps to the sorted list of documents containing it, with the
+ * number of times it occurs in each. Lists are compressed: document ids
+ * are stored as varint encoded differences from the previous one, so the
+ * index is a fraction of the size of the text. Each list is split into
+ * blocks of 128 documents with the last id and end of every block kept
+ * uncompressed. Intersections gallop over those to skip whole blocks
+ * without decoding them.
+ *
+ * Building splits the documents into contiguous chunks indexed in parallel
+ * on the shared thread_pool, then merges the chunk lists in order.
+ */
+class TextIndex {
+public:
+	/**
+	 * @brief Indexes documents, replacing any existing
+	 *
+	 * Document ids are positions in @p documents, which match product
+	 * positions when indexing the inventory.
+	 *
+	 * @param threads   Chunks to split the documents into, 0 for one per
+	 *                  pool thread
+	 *
+	 * @throws std::length_error if there are more documents than ids fit
+	 * in 32 bits
+	 */
+	void build(const std::vector<std::string>& documents, size_t threads = 0);
+
+	/**
+	 * @brief Finds the documents matching a query, best first
+	 *
+	 * Every word of the query is required, and "OR" separates alternatives,
+	 * so "usb cable OR charger" matches documents with both "usb" and
+	 * "cable", or with "charger". Documents are ranked by the sum of
+	 * (1 + ln tf) * ln(1 + N / df) over the words they matched, where tf
+	 * is the word's count in the document and df the documents containing
+	 * it out of N.
+	 *
+	 * @returns Up to limit document ids
+	 */
+	std::vector<size_t> search(const std::string& query, size_t limit) const;
+
+	size_t documentCount() const { return documents_; }
+	size_t termCount() const { return terms_.size(); }
+
+	/**
+	 * @brief Size of the postings, block table and dictionary in bytes
+	 */
+	size_t indexBytes() const;
+
+	/**
+	 * @brief Size of the text that was indexed in bytes
+	 */
+	size_t textBytes() const { return textBytes_; }
+
+	void clear();
+
+private:
+	static const size_t blockSize = 128; // Postings per block
+
+	struct Term {
+		uint32_t documents;  // Number of documents containing the term
+		uint32_t firstBlock; // Index of its first block in blocks_
+		uint32_t blocks;
+		uint64_t offset;     // Start of its postings in postings_
+	};
+
+	struct Block {
+		uint32_t lastDocument;
+		uint32_t end; // End of the block's postings, relative to Term::offset
+	};
+
+	/**
+	 * @brief Reads one term's postings in order, see TextIndex.cpp
+	 */
+	class Cursor;
+
+	/**
+	 * @brief Gets the index of a term in terms_, or terms_.size()
+	 */
+	size_t findTerm(const std::string& term) const;
+
+	std::vector<std::string> terms_; // Sorted
+	std::vector<Term> termInfo_;
+	std::vector<Block> blocks_;
+	std::vector<uint8_t> postings_;
+
+	size_t documents_ = 0;
+	size_t textBytes_ = 0;
+};
+
+} // namespace inventory
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <string>
+
+namespace inventory {
+
+/**
+ * @brief Checks if a byte is part of a word: ASCII letters and digits, and
+ * every byte of a non-ASCII character
+ */
+inline bool isWordChar(unsigned char c) {
+	return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+/**
+ * @brief Calls fn(word) for each word of text, lowercased
+ *
+ * The same string is reused for every word, copy it to keep it.
+ */
+template <typename FN_T>
+void forEachWord(const std::string& text, FN_T fn) {
+	std::string word;
+
+	for (char c : text) {
+		unsigned char uc = static_cast<unsigned char>(c);
+
+		if (isWordChar(uc)) {
+			word += (uc >= 'A' && uc <= 'Z') ? static_cast<char>(uc - 'A' + 'a') : c;
+		} else if (!word.empty()) {
+			fn(word);
+			word.clear();
+		}
+	}
+
+	if (!word.empty()) {
+		fn(word);
+	}
+}
+
+} // namespace inventory
@@ -46,7 +46,14 @@ public:
 	}
 
 	optional<T>& operator=(optional<T> rhs) {
-		swap(rhs);
+		// Not using swap, T may not be swappable (e.g. pair with const key)
+		reset();
+
+		if (rhs.m_exists) {
+			m_val = new (m_buf) T(std::move(*rhs.m_val));
+			m_exists = true;
+		}
+
 		return *this;
 	}
 
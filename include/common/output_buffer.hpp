@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <istream>
+#include <streambuf>
+#include <vector>
+
+/**
+ * @brief Stream buffer that writes to a file descriptor in large chunks
+ *
+ * Nothing is written until the buffer fills or flush() is called, so output
+ * of many lines costs one write call per buffer rather than one per line.
+ * std::flush and std::endl flush it too, which is why the REPL's commands
+ * end lines with '\n' instead.
+ */
+class output_buffer : public std::streambuf {
+public:
+	static const size_t default_capacity = 1 << 16;
+
+	explicit output_buffer(int fd, size_t capacity = default_capacity);
+
+	/**
+	 * @brief Flushes what is left
+	 */
+	~output_buffer();
+
+	output_buffer(const output_buffer&) = delete;
+	output_buffer& operator=(const output_buffer&) = delete;
+
+	/**
+	 * @brief Writes the buffered output, retrying interrupted and partial
+	 * writes
+	 *
+	 * @returns false if a write failed, the output is discarded then
+	 */
+	bool flush();
+
+	/**
+	 * @brief Number of write calls made so far
+	 */
+	size_t writes() const { return m_writes; }
+
+protected:
+	int_type overflow(int_type ch) override;
+	std::streamsize xsputn(const char* data, std::streamsize count) override;
+	int sync() override;
+
+private:
+	bool write_all(const char* data, size_t size);
+
+	int m_fd;
+	std::vector<char> m_buffer;
+	size_t m_writes = 0;
+};
+
+/**
+ * @brief Checks if input is ready, so reading a line from the stream would
+ * likely not block
+ *
+ * True if the stream has buffered characters or the file descriptor it
+ * reads from is readable, including at end of file. Output is best flushed
+ * only when this is false, right before waiting for the next command.
+ */
+bool input_pending(std::istream& in, int fd);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Hardware counter totals read from perf_event_open
+ *
+ * A counter that could not be opened (unsupported hardware, containers,
+ * perf_event_paranoid) is reported as unavailable rather than zero.
+ */
+struct perf_counters {
+	enum counter {
+		cycles,
+		instructions,
+		cache_misses,
+		branch_misses,
+		counter_count
+	};
+
+	uint64_t values[counter_count] = {};
+	bool available[counter_count] = {};
+
+	bool any_available() const;
+
+	double instructions_per_cycle() const;
+
+	perf_counters& operator+=(const perf_counters& rhs);
+
+	static const char* name(counter c);
+};
+
+/**
+ * @brief Group of hardware counters for the calling thread
+ *
+ * Counts user space events only, so it works with the default
+ * perf_event_paranoid setting of 2. On platforms without perf_event_open
+ * every counter is unavailable and all operations do nothing.
+ */
+class perf_counter_group {
+public:
+	perf_counter_group();
+	~perf_counter_group();
+
+	perf_counter_group(const perf_counter_group&) = delete;
+	perf_counter_group& operator=(const perf_counter_group&) = delete;
+
+	bool available() const { return m_fds[0] >= 0; }
+
+	/**
+	 * @brief Resets and starts all counters
+	 */
+	void start();
+
+	/**
+	 * @brief Stops all counters and reads their values since start
+	 */
+	perf_counters stop();
+
+private:
+	int m_fds[perf_counters::counter_count];
+	uint64_t m_ids[perf_counters::counter_count]; // Ids used to match group reads
+};
@@ -1,15 +1,82 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
+#include <memory>
 #include <time.h>
 #include <stdexcept>
+#include <vector>
 
+#include "perf_counters.hpp"
+
+/**
+ * @brief Summary statistics over a set of timing samples, in milliseconds
+ */
+struct profiler_stats {
+	size_t samples = 0;
+
+	double min = 0.0;
+	double median = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	double mean = 0.0;
+	double stddev = 0.0; // Sample standard deviation
+
+	/**
+	 * @brief Computes statistics from unsorted samples
+	 */
+	static profiler_stats from_samples(std::vector<double> samples);
+
+	/**
+	 * @brief Gets a nearest-rank percentile from sorted samples
+	 */
+	static double percentile(const std::vector<double>& sorted, double pct);
+};
+
+/**
+ * @brief Times a function over repeated calls
+ *
+ * A single call can be timed with @c start, or @c run makes a number of
+ * untimed warmup calls followed by timed iterations, each recorded as a
+ * sample. Wall time uses the monotonic clock so it cannot jump, CPU time is
+ * the process CPU time.
+ *
+ * Hardware counters can be enabled with @c hardware_counters, they are summed
+ * over all timed iterations and only count the calling thread.
+ */
 template <typename FUNC_T>
 class profiler {
 public:
 	profiler(FUNC_T function) :
 		m_function(function) {}
 
+	/**
+	 * @brief Sets the number of untimed calls made before measuring
+	 */
+	profiler& warmup(size_t count) { m_warmup = count; return *this; }
+
+	/**
+	 * @brief Sets the number of timed calls made by @c run
+	 */
+	profiler& iterations(size_t count) { m_iterations = std::max<size_t>(count, 1); return *this; }
+
+	/**
+	 * @brief Enables or disables reading hardware counters
+	 */
+	profiler& hardware_counters(bool enable) {
+		if (enable && m_counter_group == nullptr) {
+			m_counter_group.reset(new perf_counter_group());
+		} else if (!enable) {
+			m_counter_group.reset();
+		}
+
+		return *this;
+	}
+
+	/**
+	 * @brief Times a single call
+	 */
 	template <typename... ARGS_T>
 	void start(ARGS_T... args) {
 		start_timer();
@@ -17,39 +84,99 @@ public:
 		stop_timer();
 	}
 
-	double realtime_ms() {
-		double time_s = m_realtime_end.tv_sec - m_realtime_begin.tv_sec;
-		double time_ns = m_realtime_end.tv_nsec - m_realtime_begin.tv_nsec;
-		return time_s * 1000.0 + time_ns / 1000000.0;
+	/**
+	 * @brief Makes the warmup calls, then times each iteration
+	 *
+	 * Previous samples and counters are discarded.
+	 */
+	template <typename... ARGS_T>
+	void run(ARGS_T... args) {
+		m_realtime_samples.clear();
+		m_cputime_samples.clear();
+		m_counters = perf_counters();
+
+		for (size_t i = 0; i < m_warmup; ++i) {
+			m_function(args...);
+		}
+
+		for (size_t i = 0; i < m_iterations; ++i) {
+			if (m_counter_group != nullptr) {
+				m_counter_group->start();
+			}
+
+			start(args...);
+
+			if (m_counter_group != nullptr) {
+				m_counters += m_counter_group->stop();
+			}
+
+			m_realtime_samples.push_back(realtime_ms());
+			m_cputime_samples.push_back(cputime_ms());
+		}
+	}
+
+	/**
+	 * @brief Wall time of the last timed call
+	 */
+	double realtime_ms() const {
+		return elapsed_ms(m_realtime_begin, m_realtime_end);
 	}
 
-	double cputime_ms() {
-		double time_s = m_cputime_end.tv_sec - m_cputime_begin.tv_sec;
-		double time_ns = m_cputime_end.tv_nsec - m_cputime_begin.tv_nsec;
-		return time_s * 1000.0 + time_ns / 1000000.0;
+	/**
+	 * @brief Process CPU time of the last timed call
+	 */
+	double cputime_ms() const {
+		return elapsed_ms(m_cputime_begin, m_cputime_end);
 	}
 
+	profiler_stats realtime_stats() const { return profiler_stats::from_samples(m_realtime_samples); }
+	profiler_stats cputime_stats() const { return profiler_stats::from_samples(m_cputime_samples); }
+
+	const std::vector<double>& realtime_samples() const { return m_realtime_samples; }
+	const std::vector<double>& cputime_samples() const { return m_cputime_samples; }
+
+	/**
+	 * @brief Hardware counter totals over all timed iterations of the last run
+	 */
+	const perf_counters& counters() const { return m_counters; }
+
 private:
 	static const long ns_per_ms = 1000000;
 	static const long ms_per_s = 1000;
 
+	static double elapsed_ms(const timespec& begin, const timespec& end) {
+		double time_s = end.tv_sec - begin.tv_sec;
+		double time_ns = end.tv_nsec - begin.tv_nsec;
+		return time_s * ms_per_s + time_ns / ns_per_ms;
+	}
+
 	void start_timer() {
 		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &m_cputime_begin);
-		clock_gettime(CLOCK_REALTIME, &m_realtime_begin);
+		clock_gettime(CLOCK_MONOTONIC, &m_realtime_begin);
 	}
 
 	void stop_timer() {
+		clock_gettime(CLOCK_MONOTONIC, &m_realtime_end);
 		clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &m_cputime_end);
-		clock_gettime(CLOCK_REALTIME, &m_realtime_end);
 	}
 
 	FUNC_T m_function;
 
+	size_t m_warmup = 1;
+	size_t m_iterations = 1;
+
 	timespec m_cputime_begin;
 	timespec m_cputime_end;
 
 	timespec m_realtime_begin;
 	timespec m_realtime_end;
+
+	std::vector<double> m_realtime_samples;
+	std::vector<double> m_cputime_samples;
+
+	// Allocated only when enabled, opening counters costs several syscalls
+	std::shared_ptr<perf_counter_group> m_counter_group;
+	perf_counters m_counters;
 };
 
 template <typename FUNC_T>
@@ -57,3 +184,45 @@ profiler<FUNC_T> make_profiler(FUNC_T function) {
 	return profiler<FUNC_T>(function);
 }
 
+inline double profiler_stats::percentile(const std::vector<double>& sorted, double pct) {
+	if (sorted.empty()) {
+		return 0.0;
+	}
+
+	size_t rank = static_cast<size_t>(std::ceil(pct / 100.0 * sorted.size()));
+	return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+inline profiler_stats profiler_stats::from_samples(std::vector<double> samples) {
+	profiler_stats stats;
+
+	if (samples.empty()) {
+		return stats;
+	}
+
+	std::sort(samples.begin(), samples.end());
+
+	stats.samples = samples.size();
+	stats.min = samples.front();
+	stats.max = samples.back();
+	stats.p99 = percentile(samples, 99.0);
+
+	size_t mid = samples.size() / 2;
+	stats.median = (samples.size() % 2 == 0) ? (samples[mid - 1] + samples[mid]) / 2.0 : samples[mid];
+
+	double sum = 0.0;
+	for (double sample : samples) {
+		sum += sample;
+	}
+	stats.mean = sum / samples.size();
+
+	if (samples.size() > 1) {
+		double sq_sum = 0.0;
+		for (double sample : samples) {
+			sq_sum += (sample - stats.mean) * (sample - stats.mean);
+		}
+		stats.stddev = std::sqrt(sq_sum / (samples.size() - 1));
+	}
+
+	return stats;
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Reads a file block by block in order, keeping reads of the next
+ * blocks in flight while the caller works on the current one
+ *
+ * The blocks live in a ring of page-aligned buffers, one per read in
+ * flight. Reads are queued on an io_uring, so a cold page cache is read
+ * at the device's queue depth rather than one request at a time. Taking
+ * the next block queues the read of the block after the ring in the buffer
+ * just handed back.
+ *
+ * Where io_uring is unavailable, such as on older kernels or under seccomp
+ * filters blocking it, blocks are read with pread instead, after asking the
+ * kernel to read the next blocks ahead in the background.
+ */
+class read_ahead {
+public:
+	static const size_t default_block_size = 1 << 20;
+	static const size_t default_depth = 4;
+
+	/**
+	 * @param block_size   Bytes per read, rounded up to whole pages
+	 * @param depth        Reads kept in flight, and buffers in the ring
+	 * @param use_uring    Tries io_uring before falling back to pread
+	 *
+	 * @throws std::runtime_error if the file can't be opened
+	 */
+	explicit read_ahead(const std::string& filename, size_t block_size = default_block_size,
+	                    size_t depth = default_depth, bool use_uring = true);
+
+	/**
+	 * @brief Waits for the reads still in flight before freeing the buffers
+	 */
+	~read_ahead();
+
+	read_ahead(const read_ahead&) = delete;
+	read_ahead& operator=(const read_ahead&) = delete;
+
+	/**
+	 * @brief Gets the next block of the file
+	 *
+	 * The block stays valid until the next call. Only the last block is
+	 * shorter than the block size.
+	 *
+	 * @returns false at the end of the file
+	 *
+	 * @throws std::runtime_error if a read failed
+	 */
+	bool next(const char*& data, size_t& size);
+
+	/**
+	 * @brief Size of the file when it was opened, the bytes next returns
+	 */
+	uint64_t file_size() const { return m_file_size; }
+
+	/**
+	 * @brief Checks if reads go through io_uring rather than pread
+	 */
+	bool uring() const { return m_ring != nullptr; }
+
+private:
+	struct ring;
+
+	struct buffer {
+		char* data = nullptr;
+		uint64_t offset = 0;
+		size_t size = 0;   // Bytes the block should hold
+		size_t filled = 0; // Bytes read so far
+		bool pending = false;
+		int error = 0;
+	};
+
+	uint64_t block_offset(uint64_t block) const { return block * m_block_size; }
+	size_t block_bytes(uint64_t block) const;
+
+	/**
+	 * @brief Starts reading a block into its buffer, if it is in the file
+	 */
+	void queue(uint64_t block);
+
+	/**
+	 * @brief Submits a read of what is left of a buffer's block, io_uring
+	 * only
+	 */
+	void submit(buffer& buf);
+
+	/**
+	 * @brief Handles the completed reads, io_uring only
+	 *
+	 * @param wait   Blocks until at least one read completes
+	 */
+	void reap(bool wait);
+
+	/**
+	 * @brief Waits for the reads in flight, then frees everything
+	 */
+	void release();
+
+	std::string m_filename;
+	int m_fd = -1;
+	uint64_t m_file_size = 0;
+	size_t m_block_size;
+	uint64_t m_blocks = 0;
+
+	std::vector<buffer> m_buffers; // Block b is read into m_buffers[b % depth]
+	uint64_t m_next = 0;           // Block next returns
+	size_t m_in_flight = 0;
+
+	std::unique_ptr<ring> m_ring;
+};
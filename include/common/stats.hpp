@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <time.h>
+
+/**
+ * Always-on hot path statistics
+ *
+ * Counters and log2 histograms are kept per thread. Recording only touches
+ * the calling thread's block with relaxed atomics, so there is no locking or
+ * cache line sharing on the hot path. Collecting a snapshot sums every live
+ * thread's block plus the totals of threads that have exited.
+ *
+ * Building with -DPA3_STATS=OFF compiles every PA3_STATS_* macro out.
+ */
+
+#ifndef PA3_STATS
+#define PA3_STATS 1
+#endif
+
+namespace stats {
+
+enum histogram_id {
+	command_find_ns,
+	command_list_inventory_ns,
+	command_search_ns,
+	command_search_text_ns,
+	command_where_ns,
+	command_stats_ns,
+	hash_probe_length,    // Probe attempts per unordered_map lookup or insert
+	avl_lookup_depth,     // Nodes visited per avl_map lookup
+	rehash_ns,
+	load_parse_ns,        // CSVReader::read, or parsing in Inventory::loadFile
+	load_index_ns,        // Building the indexes in Inventory::load and loadFile
+	histogram_count
+};
+
+enum counter_id {
+	rehash_count,
+	filter_reject,         // Bloom filter lookups answered "definitely absent"
+	filter_pass,           // Bloom filter lookups answered "maybe present"
+	filter_false_positive, // Passed lookups whose key was then not found
+	counter_count
+};
+
+// Bucket 0 holds zero, bucket i holds values in [2^(i-1), 2^i)
+static const int bucket_count = 65;
+
+struct histogram_snapshot {
+	uint64_t count = 0;
+	uint64_t sum = 0;
+	uint64_t max = 0;
+	uint64_t buckets[bucket_count] = {};
+
+	double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+
+	/**
+	 * @brief Estimates a percentile as the upper bound of its bucket
+	 */
+	uint64_t percentile(double pct) const;
+};
+
+struct snapshot {
+	histogram_snapshot histograms[histogram_count];
+	uint64_t counters[counter_count] = {};
+};
+
+/**
+ * @brief Per-thread storage, only ever written by its owning thread
+ */
+struct thread_block {
+	struct histogram {
+		std::atomic<uint64_t> count;
+		std::atomic<uint64_t> sum;
+		std::atomic<uint64_t> max;
+		std::atomic<uint64_t> buckets[bucket_count];
+	};
+
+	thread_block();
+	~thread_block();
+
+	histogram histograms[histogram_count];
+	std::atomic<uint64_t> counters[counter_count];
+};
+
+inline thread_block& local_block() {
+	static thread_local thread_block block;
+	return block;
+}
+
+inline int bucket_of(uint64_t value) {
+	return value == 0 ? 0 : 64 - __builtin_clzll(value);
+}
+
+// Single writer per block, a relaxed load and store is enough and avoids a
+// locked read-modify-write
+inline void add_relaxed(std::atomic<uint64_t>& value, uint64_t amount) {
+	value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+inline void record(histogram_id id, uint64_t value) {
+	thread_block::histogram& hist = local_block().histograms[id];
+
+	add_relaxed(hist.count, 1);
+	add_relaxed(hist.sum, value);
+	add_relaxed(hist.buckets[bucket_of(value)], 1);
+
+	if (value > hist.max.load(std::memory_order_relaxed)) {
+		hist.max.store(value, std::memory_order_relaxed);
+	}
+}
+
+inline void increment(counter_id id, uint64_t amount = 1) {
+	add_relaxed(local_block().counters[id], amount);
+}
+
+inline uint64_t now_ns() {
+	timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+}
+
+/**
+ * @brief Records the lifetime of the timer into a histogram, in nanoseconds
+ */
+class scoped_timer {
+public:
+	scoped_timer(histogram_id id) : m_id(id), m_begin(now_ns()) {}
+	~scoped_timer() { record(m_id, now_ns() - m_begin); }
+
+	scoped_timer(const scoped_timer&) = delete;
+	scoped_timer& operator=(const scoped_timer&) = delete;
+
+private:
+	histogram_id m_id;
+	uint64_t m_begin;
+};
+
+/**
+ * @brief Whether statistics were compiled in
+ */
+inline bool enabled() { return PA3_STATS; }
+
+/**
+ * @brief Sums the statistics of all threads, past and present
+ */
+snapshot collect();
+
+const char* name(histogram_id id);
+const char* name(counter_id id);
+
+/**
+ * @brief Writes a human readable table of a snapshot
+ */
+void write_text(std::ostream& out, const snapshot& snap);
+
+/**
+ * @brief Writes a snapshot as a single JSON object
+ */
+void write_json(std::ostream& out, const snapshot& snap);
+
+} // namespace stats
+
+#if PA3_STATS
+#define PA3_STATS_RECORD(ID, VALUE) ::stats::record(::stats::ID, (VALUE))
+#define PA3_STATS_INCREMENT(ID) ::stats::increment(::stats::ID)
+#define PA3_STATS_TIMER(VAR, ID) ::stats::scoped_timer VAR(::stats::ID)
+#else
+#define PA3_STATS_RECORD(ID, VALUE) ((void)0)
+#define PA3_STATS_INCREMENT(ID) ((void)0)
+#define PA3_STATS_TIMER(VAR, ID) ((void)0)
+#endif
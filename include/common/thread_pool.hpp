@@ -0,0 +1,194 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class thread_pool;
+
+/**
+ * @brief Tasks run on a thread_pool and waited for together
+ *
+ * wait() runs queued tasks itself until the group's are done, so groups
+ * nest: a task may start a group of its own and wait for it without
+ * blocking a worker, and a pool without workers still makes progress.
+ *
+ * Cancelling skips the tasks that haven't started yet, running tasks may
+ * check cancelled() to stop early. The first exception a task throws
+ * cancels the group and is rethrown by wait.
+ */
+class task_group {
+public:
+	explicit task_group(thread_pool& pool);
+
+	/**
+	 * @brief Waits for the tasks, without rethrowing their exceptions
+	 */
+	~task_group();
+
+	task_group(const task_group&) = delete;
+	task_group& operator=(const task_group&) = delete;
+
+	/**
+	 * @brief Queues a task, preferably on the calling worker's own queue
+	 */
+	void run(std::function<void()> fn);
+
+	/**
+	 * @brief Runs queued tasks until every task of the group is done
+	 *
+	 * @throws The first exception thrown by a task
+	 */
+	void wait();
+
+	void cancel() { m_cancelled = true; }
+	bool cancelled() const { return m_cancelled; }
+
+private:
+	friend class thread_pool;
+
+	/**
+	 * @brief Marks a task done, keeping its exception if it is the first
+	 */
+	void finish(std::exception_ptr error);
+
+	thread_pool& m_pool;
+	std::atomic<size_t> m_pending;
+	std::atomic<bool> m_cancelled;
+
+	std::mutex m_error_mutex;
+	std::exception_ptr m_error;
+};
+
+/**
+ * @brief Work-stealing thread pool for CPU-heavy work
+ *
+ * Each worker has its own deque. Tasks queued by a worker go to the back of
+ * its deque and the worker takes them back from there, newest first, while
+ * idle workers steal from the front of other deques, oldest first. Tasks
+ * queued by other threads go to a shared queue. Threads waiting for a
+ * task_group run tasks too, so the waiting thread is never idle.
+ *
+ * On Linux with several NUMA nodes, the workers can be pinned to the CPUs
+ * of a node each, consecutive workers on the same node. parallel_for hands
+ * consecutive chunks to consecutive tasks, so neighbouring data tends to
+ * stay on one node.
+ *
+ * Use shared() rather than a pool of your own, so nested parallel code
+ * doesn't start more threads than there are CPUs.
+ */
+class thread_pool {
+public:
+	/**
+	 * @param workers        Worker threads, the thread waiting for tasks
+	 *                       runs them as well
+	 * @param numa_pinning   Pins workers to NUMA nodes, if there are several
+	 */
+	explicit thread_pool(size_t workers, bool numa_pinning = false);
+	~thread_pool();
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+
+	/**
+	 * @brief Gets the process-wide pool, with a worker per hardware thread
+	 * but one, pinned to NUMA nodes
+	 */
+	static thread_pool& shared();
+
+	size_t workers() const { return m_threads.size(); }
+
+	/**
+	 * @brief Threads that can run tasks at once, the waiting thread included
+	 */
+	size_t concurrency() const { return m_threads.size() + 1; }
+
+	/**
+	 * @brief Number of NUMA nodes the workers are pinned to, 0 if they are
+	 * not pinned
+	 */
+	size_t numa_nodes() const { return m_numa_nodes; }
+
+	/**
+	 * @brief Splits [begin, end) into contiguous chunks and runs them in
+	 * parallel, the calling thread taking the first
+	 *
+	 * @param chunks   Number of chunks, 0 for one per thread, never more
+	 *                 than there are indexes
+	 * @param fn       Called as fn(chunk, chunk_begin, chunk_end), chunks
+	 *                 numbered from 0 in index order
+	 *
+	 * @throws The first exception thrown by fn, the chunks not yet started
+	 * are skipped
+	 */
+	template <typename FN_T>
+	void parallel_for(size_t begin, size_t end, size_t chunks, FN_T fn);
+
+	/**
+	 * @brief Maps contiguous chunks of [begin, end) in parallel, then reduces
+	 * the results in chunk order
+	 *
+	 * Reducing in order keeps results such as floating point sums the same
+	 * from run to run.
+	 *
+	 * @param map      Called as map(chunk_begin, chunk_end), returning a T
+	 * @param reduce   Called as reduce(T accumulated, T chunk), returning a T
+	 */
+	template <typename T, typename MAP_F, typename REDUCE_F>
+	T parallel_reduce(size_t begin, size_t end, size_t chunks, T identity, MAP_F map, REDUCE_F reduce);
+
+	/**
+	 * @brief Gets the number of chunks parallel_for splits a range into
+	 */
+	size_t chunk_count(size_t begin, size_t end, size_t chunks) const;
+
+private:
+	friend class task_group;
+
+	struct task {
+		std::function<void()> fn;
+		task_group* group;
+	};
+
+	struct task_queue {
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
+
+	void push(task t);
+
+	/**
+	 * @brief Takes a task from the own queue, else the shared queue, else
+	 * steals one
+	 */
+	bool pop(task& t);
+	bool take(task_queue& queue, bool newest, task& t);
+
+	void execute(task& t);
+	void work(size_t index);
+	void wait_for(task_group& group);
+
+	void pin_workers();
+
+	// A queue per worker, then the shared queue
+	std::vector<std::unique_ptr<task_queue>> m_queues;
+	std::vector<std::thread> m_threads;
+	std::atomic<size_t> m_queued;
+
+	// Idle workers and waiting threads sleep until a task is queued or a
+	// group finishes
+	std::mutex m_sleep_mutex;
+	std::condition_variable m_wake;
+	bool m_stopping = false;
+
+	size_t m_numa_nodes = 0;
+};
+
+#include "thread_pool.inl.hpp"
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <utility>
+
+template <typename FN_T>
+void thread_pool::parallel_for(size_t begin, size_t end, size_t chunks, FN_T fn) {
+	if (begin >= end) {
+		return;
+	}
+
+	chunks = chunk_count(begin, end, chunks);
+
+	task_group group(*this);
+	size_t size = end - begin;
+
+	for (size_t c = 1; c < chunks; ++c) {
+		size_t chunk_begin = begin + size * c / chunks;
+		size_t chunk_end = begin + size * (c + 1) / chunks;
+
+		group.run([&fn, c, chunk_begin, chunk_end] {
+			fn(c, chunk_begin, chunk_end);
+		});
+	}
+
+	try {
+		fn(0, begin, begin + size / chunks);
+	} catch (...) {
+		// The group waits for the running chunks before fn goes away
+		group.cancel();
+		throw;
+	}
+
+	group.wait();
+}
+
+template <typename T, typename MAP_F, typename REDUCE_F>
+T thread_pool::parallel_reduce(size_t begin, size_t end, size_t chunks, T identity, MAP_F map, REDUCE_F reduce) {
+	if (begin >= end) {
+		return identity;
+	}
+
+	std::vector<T> partials(chunk_count(begin, end, chunks), identity);
+
+	parallel_for(begin, end, partials.size(), [&](size_t chunk, size_t chunk_begin, size_t chunk_end) {
+		partials[chunk] = map(chunk_begin, chunk_end);
+	});
+
+	T result = std::move(identity);
+
+	for (T& partial : partials) {
+		result = reduce(std::move(result), std::move(partial));
+	}
+
+	return result;
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <cmath>
+#include <string>
 
 /**
  * @brief Implementation of std::make_unique
@@ -13,13 +15,36 @@ std::unique_ptr<CLASS_T> make_unique(ARGS_T&&... args) {
 	return std::unique_ptr<CLASS_T>(new CLASS_T(std::forward<ARGS_T>(args)...));
 }
 
+/**
+ * @brief Hints that the cache line holding addr will be read soon, so its
+ * load overlaps with other work
+ */
+inline void prefetch(const void* addr) {
+#if defined(__GNUC__)
+	__builtin_prefetch(addr);
+#endif
+}
+
+/**
+ * @brief Prefetches the data a value keeps out of line, such as a string's
+ * characters, nothing for other values
+ */
+template <typename T>
+inline void prefetch_contents(const T&) {}
+
+inline void prefetch_contents(const std::string& value) {
+	prefetch(value.data());
+}
+
 /**
  * @brief Naive isprime
  */
-inline bool is_prime(int x) {
-	int range = sqrt(x);
+inline bool is_prime(size_t x) {
+	if (x < 2) { return false; }
+
+	size_t range = sqrt(x);
 
-	for (int i = 0; i <= range; ++i) {
+	for (size_t i = 2; i <= range; ++i) {
 		if (x % i == 0) { return false; }
 	}
 
@@ -29,7 +54,7 @@ inline bool is_prime(int x) {
 /**
  * @brief Find next prime >= x
  */
-inline int next_prime(int x) {
+inline size_t next_prime(size_t x) {
 	while (!is_prime(x)) { ++x; }
 	return x;
 }
@@ -0,0 +1,179 @@
+#include "bench.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+
+namespace bench {
+
+namespace {
+
+std::string json_escape(const std::string& str) {
+	std::string escaped;
+
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			escaped += '\\';
+		}
+		escaped += c;
+	}
+
+	return escaped;
+}
+
+} // namespace
+
+std::vector<std::pair<std::string, benchmark_fn>>& registry() {
+	static std::vector<std::pair<std::string, benchmark_fn>> benchmarks;
+	return benchmarks;
+}
+
+bool runner::selected(const std::string& name) const {
+	return m_config.filter.empty() || name.find(m_config.filter) != std::string::npos;
+}
+
+void runner::add_result(const std::string& name, size_t ops, const profiler_stats& stats_ms,
+                        const perf_counters& counters) {
+	const double ns_per_ms = 1000000.0;
+	const double scale = ns_per_ms / ops;
+
+	result res;
+	res.name = name;
+	res.ops_per_sample = ops;
+	res.samples = stats_ms.samples;
+	res.ns_per_op = stats_ms.mean * scale;
+	res.ops_per_sec = res.ns_per_op > 0.0 ? 1e9 / res.ns_per_op : 0.0;
+	res.min_ns = stats_ms.min * scale;
+	res.p50_ns = stats_ms.median * scale;
+	res.p99_ns = stats_ms.p99 * scale;
+	res.max_ns = stats_ms.max * scale;
+	res.stddev_ns = stats_ms.stddev * scale;
+	res.counters = counters;
+
+	m_results.push_back(res);
+}
+
+void runner::record(const std::string& name, size_t ops, const std::vector<double>& samples_ns) {
+	if (!selected(name) || ops == 0) {
+		return;
+	}
+
+	std::vector<double> samples_ms;
+	for (double sample : samples_ns) {
+		samples_ms.push_back(sample / 1000000.0);
+	}
+
+	add_result(name, ops, profiler_stats::from_samples(samples_ms), perf_counters());
+}
+
+double result::counter_per_op(perf_counters::counter c) const {
+	size_t total_ops = ops_per_sample * std::max<size_t>(1, samples);
+	return static_cast<double>(counters.values[c]) / total_ops;
+}
+
+void write_json(std::ostream& out, const config& config, const std::vector<result>& results) {
+	out << std::fixed << std::setprecision(3);
+
+	out << "{\n"
+	    << "  \"config\": { \"rows\": " << config.rows
+	    << ", \"samples\": " << config.samples
+	    << ", \"warmup\": " << config.warmup
+	    << ", \"seed\": " << config.seed << " },\n"
+	    << "  \"results\": [\n";
+
+	for (size_t i = 0; i < results.size(); ++i) {
+		const result& res = results[i];
+
+		out << "    { \"name\": \"" << json_escape(res.name) << "\""
+		    << ", \"ops\": " << res.ops_per_sample
+		    << ", \"ns_per_op\": " << res.ns_per_op
+		    << ", \"ops_per_sec\": " << res.ops_per_sec
+		    << ", \"min_ns\": " << res.min_ns
+		    << ", \"p50_ns\": " << res.p50_ns
+		    << ", \"p99_ns\": " << res.p99_ns
+		    << ", \"max_ns\": " << res.max_ns
+		    << ", \"stddev_ns\": " << res.stddev_ns;
+
+		for (int c = 0; c < perf_counters::counter_count; ++c) {
+			perf_counters::counter counter = static_cast<perf_counters::counter>(c);
+
+			if (res.counters.available[c]) {
+				out << ", \"" << perf_counters::name(counter) << "_per_op\": "
+				    << res.counter_per_op(counter);
+			}
+		}
+
+		out << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+
+	out << "  ]\n"
+	    << "}" << std::endl;
+}
+
+std::vector<std::pair<std::string, double>> read_baseline(std::istream& in) {
+	static const std::string name_key = "\"name\": \"";
+	static const std::string ns_key = "\"ns_per_op\": ";
+
+	std::vector<std::pair<std::string, double>> baseline;
+	std::string line;
+
+	// write_json puts each result on its own line, no need for a full parser
+	while (std::getline(in, line)) {
+		std::string::size_type name_pos = line.find(name_key);
+		std::string::size_type ns_pos = line.find(ns_key);
+
+		if (name_pos == std::string::npos || ns_pos == std::string::npos) {
+			continue;
+		}
+
+		name_pos += name_key.size();
+
+		std::string name;
+
+		for (std::string::size_type i = name_pos; i < line.size() && line[i] != '"'; ++i) {
+			if (line[i] == '\\' && i + 1 < line.size()) {
+				++i;
+			}
+			name += line[i];
+		}
+
+		baseline.emplace_back(name, std::stod(line.substr(ns_pos + ns_key.size())));
+	}
+
+	return baseline;
+}
+
+size_t compare_baseline(std::ostream& out, const std::vector<result>& results,
+                        const std::vector<std::pair<std::string, double>>& baseline,
+                        double threshold) {
+	size_t regressions = 0;
+
+	out << std::fixed << std::setprecision(1);
+
+	for (const result& res : results) {
+		auto it = std::find_if(baseline.begin(), baseline.end(),
+		                       [&](const std::pair<std::string, double>& entry) {
+		                               return entry.first == res.name;
+		                       });
+
+		out << std::left << std::setw(40) << res.name << std::right;
+
+		if (it == baseline.end() || it->second <= 0.0) {
+			out << "  (no baseline)" << std::endl;
+			continue;
+		}
+
+		double change = (res.ns_per_op - it->second) / it->second;
+		bool regressed = change > threshold;
+
+		out << std::setw(12) << it->second << " -> " << std::setw(12) << res.ns_per_op
+		    << " ns/op  " << std::showpos << change * 100.0 << std::noshowpos << "%"
+		    << (regressed ? "  REGRESSION" : "") << std::endl;
+
+		regressions += regressed;
+	}
+
+	return regressions;
+}
+
+} // namespace bench
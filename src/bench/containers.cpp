@@ -0,0 +1,564 @@
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+#include "stats.hpp"
+#include "synthetic.hpp"
+#include "thread_pool.hpp"
+
+#include "dsa/List.hpp"
+#include "dsa/avl_map.hpp"
+#include "dsa/concurrent_map.hpp"
+#include "dsa/frozen_map.hpp"
+#include "dsa/frozen_ordered_map.hpp"
+#include "dsa/hash.hpp"
+#include "dsa/persistent_avl_map.hpp"
+#include "dsa/robin_hood_map.hpp"
+#include "dsa/sharded_map.hpp"
+#include "dsa/unordered_map.hpp"
+
+namespace {
+
+// List::insertBack and operator[] are O(n), keep their sizes small
+const size_t list_linear_limit = 2000;
+
+struct keyset {
+	std::vector<std::string> keys;    // Inserted keys, in insertion order
+	std::vector<std::string> lookups; // Inserted keys, shuffled
+	std::vector<std::string> misses;  // Keys that were never inserted
+};
+
+keyset make_keys(size_t count, uint64_t seed) {
+	std::mt19937_64 rng(seed);
+	keyset set;
+
+	for (size_t i = 0; i < count; ++i) {
+		set.keys.push_back(bench::random_id(rng));
+	}
+	for (size_t i = 0; i < count; ++i) {
+		set.misses.push_back(bench::random_id(rng));
+	}
+
+	set.lookups = set.keys;
+	std::shuffle(set.lookups.begin(), set.lookups.end(), rng);
+
+	return set;
+}
+
+} // namespace
+
+BENCHMARK(unordered_map) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+
+	runner.measure("unordered_map/insert", n, [&] {
+		dsa::unordered_map<std::string, size_t> map;
+		for (size_t i = 0; i < n; ++i) {
+			map.insert({ set.keys[i], i });
+		}
+		bench::do_not_optimize(map);
+	});
+
+	dsa::unordered_map<std::string, size_t> map;
+	for (size_t i = 0; i < n; ++i) {
+		map.insert({ set.keys[i], i });
+	}
+
+	runner.measure("unordered_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("unordered_map/find_miss", n, [&] {
+		for (const std::string& key : set.misses) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("unordered_map/find_many_hit", n, [&] {
+		bench::do_not_optimize(map.find_many(set.lookups.data(), set.lookups.size()));
+	});
+
+	runner.measure("unordered_map/contains_many_miss", n, [&] {
+		bench::do_not_optimize(map.contains_many(set.misses.data(), set.misses.size()));
+	});
+
+	runner.measure("unordered_map/iterate", n, [&] {
+		size_t sum = 0;
+		for (const auto& pair : map) {
+			sum += pair.second;
+		}
+		bench::do_not_optimize(sum);
+	});
+}
+
+BENCHMARK(hash) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+
+	runner.measure("hash/std_hash", n, [&] {
+		size_t sum = 0;
+		for (const std::string& key : set.keys) {
+			sum += std::hash<std::string>{}(key);
+		}
+		bench::do_not_optimize(sum);
+	});
+
+	runner.measure("hash/wyhash", n, [&] {
+		size_t sum = 0;
+		for (const std::string& key : set.keys) {
+			sum += dsa::wyhash{}(key);
+		}
+		bench::do_not_optimize(sum);
+	});
+
+	dsa::unordered_map<std::string, size_t, dsa::wyhash> map;
+	for (size_t i = 0; i < n; ++i) {
+		map.insert({ set.keys[i], i });
+	}
+
+	runner.measure("unordered_map_wyhash/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("unordered_map_wyhash/find_miss", n, [&] {
+		for (const std::string& key : set.misses) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+}
+
+/*
+ * Latency of small batches of inserts while the map grows from empty. The
+ * max shows the cost of the slowest batch, which includes a full rehash
+ * unless the rehash is incremental.
+ */
+BENCHMARK(unordered_map_growth) {
+	const size_t n = runner.config().rows;
+	const size_t batch = 16;
+	keyset set = make_keys(n, runner.config().seed);
+
+	for (bool incremental : { false, true }) {
+		std::string name = incremental ? "unordered_map/insert_latency_incremental" : "unordered_map/insert_latency";
+
+		if (!runner.selected(name)) {
+			continue;
+		}
+
+		std::vector<double> samples;
+
+		for (size_t run = 0; run < runner.config().samples; ++run) {
+			dsa::unordered_map<std::string, size_t> map;
+			map.incremental_rehash(incremental);
+
+			for (size_t begin = 0; begin + batch <= n; begin += batch) {
+				uint64_t start = stats::now_ns();
+
+				for (size_t i = begin; i < begin + batch; ++i) {
+					map.insert({ set.keys[i], i });
+				}
+
+				samples.push_back(stats::now_ns() - start);
+			}
+
+			bench::do_not_optimize(map);
+		}
+
+		runner.record(name, batch, samples);
+	}
+}
+
+BENCHMARK(robin_hood_map) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+
+	runner.measure("robin_hood_map/insert", n, [&] {
+		dsa::robin_hood_map<std::string, size_t> map;
+		for (size_t i = 0; i < n; ++i) {
+			map.insert({ set.keys[i], i });
+		}
+		bench::do_not_optimize(map);
+	});
+
+	dsa::robin_hood_map<std::string, size_t> map;
+	for (size_t i = 0; i < n; ++i) {
+		map.insert({ set.keys[i], i });
+	}
+
+	runner.measure("robin_hood_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("robin_hood_map/find_miss", n, [&] {
+		for (const std::string& key : set.misses) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("robin_hood_map/iterate", n, [&] {
+		size_t sum = 0;
+		for (const auto& pair : map) {
+			sum += pair.second;
+		}
+		bench::do_not_optimize(sum);
+	});
+}
+
+BENCHMARK(frozen_map) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+
+	std::vector<std::pair<std::string, size_t>> pairs;
+	for (size_t i = 0; i < n; ++i) {
+		pairs.emplace_back(set.keys[i], i);
+	}
+
+	runner.measure("frozen_map/build", n, [&] {
+		dsa::frozen_map<std::string, size_t, dsa::wyhash> map(pairs.begin(), pairs.end());
+		bench::do_not_optimize(map);
+	});
+
+	dsa::frozen_map<std::string, size_t, dsa::wyhash> map(pairs.begin(), pairs.end());
+
+	runner.measure("frozen_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("frozen_map/find_miss", n, [&] {
+		for (const std::string& key : set.misses) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+}
+
+/*
+ * Miss latency as the occupied fraction of the table grows. The robin hood
+ * table is filled to each load factor directly. unordered_map grows before
+ * its live load passes 0.5, so it is aged instead: filled to 0.45, then
+ * churned with erase/insert pairs until sentinels make up the rest.
+ */
+BENCHMARK(hash_miss_by_load) {
+	const size_t n = runner.config().rows;
+	const double loads[] = { 0.5, 0.6, 0.7, 0.8, 0.9 };
+
+	std::mt19937_64 rng(runner.config().seed);
+	std::vector<std::string> misses;
+	for (size_t i = 0; i < n; ++i) {
+		misses.push_back(bench::random_id(rng));
+	}
+
+	for (double load : loads) {
+		std::string suffix = "@" + std::to_string(load).substr(0, 3);
+
+		std::string robin_name = "hash_miss/robin_hood_map" + suffix;
+		if (runner.selected(robin_name)) {
+			dsa::robin_hood_map<std::string, size_t> map(2 * n);
+			map.max_load_factor(0.95);
+
+			size_t count = load * map.bucket_count();
+			for (size_t i = 0; i < count; ++i) {
+				map.insert({ bench::random_id(rng), i });
+			}
+
+			runner.measure(robin_name, n, [&] {
+				for (const std::string& key : misses) {
+					bench::do_not_optimize(map.find(key));
+				}
+			});
+		}
+
+		std::string aged_name = "hash_miss/unordered_map" + suffix;
+		if (runner.selected(aged_name)) {
+			dsa::unordered_map<std::string, size_t> map(2 * n);
+			std::vector<std::string> live;
+
+			size_t buckets = map.bucket_count();
+			size_t count = 0.45 * buckets;
+			for (size_t i = 0; i < count; ++i) {
+				live.push_back(bench::random_id(rng));
+				map.insert({ live.back(), i });
+			}
+
+			// Reinserts may reuse sentinels, so bound the churn
+			size_t target = load * buckets;
+			for (size_t step = 0; map.size() + map.sentinel_count() < target && step < 64 * buckets; ++step) {
+				std::string& victim = live[rng() % live.size()];
+				map.erase(victim);
+				victim = bench::random_id(rng);
+				map.insert({ victim, step });
+			}
+
+			runner.measure(aged_name, n, [&] {
+				for (const std::string& key : misses) {
+					bench::do_not_optimize(map.find(key));
+				}
+			});
+		}
+	}
+}
+
+BENCHMARK(concurrent_map) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+
+	runner.measure("concurrent_map/insert", n, [&] {
+		dsa::concurrent_map<std::string, size_t> map;
+		for (size_t i = 0; i < n; ++i) {
+			map.insert(set.keys[i], i);
+		}
+		bench::do_not_optimize(map);
+	});
+
+	dsa::concurrent_map<std::string, size_t> map;
+	for (size_t i = 0; i < n; ++i) {
+		map.insert(set.keys[i], i);
+	}
+
+	runner.measure("concurrent_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("concurrent_map/find_miss", n, [&] {
+		for (const std::string& key : set.misses) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	if (!runner.selected("concurrent_map/find_hit_with_writer")) {
+		return;
+	}
+
+	// Lookups while another thread keeps updating and growing the map
+	std::atomic<bool> done(false);
+	std::thread writer([&] {
+		for (size_t i = 0; !done.load(std::memory_order_relaxed); ++i) {
+			map.insert_or_assign(set.keys[i % n], i);
+			map.insert(set.misses[i % n], i);
+
+			if (i % n == n - 1) {
+				for (const std::string& key : set.misses) {
+					map.erase(key);
+				}
+			}
+		}
+	});
+
+	runner.measure("concurrent_map/find_hit_with_writer", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	done.store(true);
+	writer.join();
+}
+
+BENCHMARK(sharded_map) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+	thread_pool& pool = thread_pool::shared();
+
+	runner.measure("sharded_map/insert", n, [&] {
+		dsa::sharded_map<std::string, size_t, dsa::wyhash> map;
+		for (size_t i = 0; i < n; ++i) {
+			map.insert({ set.keys[i], i });
+		}
+		bench::do_not_optimize(map);
+	});
+
+	// Compare with unordered_map/insert, the same keys into one table
+	runner.measure("sharded_map/insert_bulk", n, [&] {
+		dsa::sharded_map<std::string, size_t, dsa::wyhash> map;
+		bench::do_not_optimize(map.insert_bulk(pool, n, [&set](size_t i) -> const std::string& {
+			return set.keys[i];
+		}, [](size_t i) {
+			return i;
+		}));
+		bench::do_not_optimize(map);
+	});
+
+	dsa::sharded_map<std::string, size_t, dsa::wyhash> map;
+	for (size_t i = 0; i < n; ++i) {
+		map.insert({ set.keys[i], i });
+	}
+
+	runner.measure("sharded_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+}
+
+BENCHMARK(avl_map) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+
+	runner.measure("avl_map/insert", n, [&] {
+		::avl_map<std::string, size_t> map;
+		for (size_t i = 0; i < n; ++i) {
+			map.insert({ set.keys[i], i });
+		}
+		bench::do_not_optimize(map);
+	});
+
+	::avl_map<std::string, size_t> map;
+	for (size_t i = 0; i < n; ++i) {
+		map.insert({ set.keys[i], i });
+	}
+
+	runner.measure("avl_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("avl_map/find_miss", n, [&] {
+		for (const std::string& key : set.misses) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	runner.measure("avl_map/find_many_hit", n, [&] {
+		bench::do_not_optimize(map.find_many(set.lookups.data(), set.lookups.size()));
+	});
+
+	runner.measure("avl_map/iterate", n, [&] {
+		size_t sum = 0;
+		for (const auto& pair : map) {
+			sum += pair.second;
+		}
+		bench::do_not_optimize(sum);
+	});
+
+	runner.measure("avl_map/copy", n, [&] {
+		::avl_map<std::string, size_t> copy(map);
+		bench::do_not_optimize(copy);
+	});
+
+	runner.measure("avl_map/copy_clear", n, [&] {
+		::avl_map<std::string, size_t> copy(map);
+		copy.clear();
+		bench::do_not_optimize(copy);
+	});
+
+	runner.measure("frozen_ordered_map/build", n, [&] {
+		dsa::frozen_ordered_map<std::string, size_t> frozen(map.begin(), map.end());
+		bench::do_not_optimize(frozen);
+	});
+
+	dsa::frozen_ordered_map<std::string, size_t> frozen(map.begin(), map.end());
+
+	runner.measure("frozen_ordered_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(frozen.find(key));
+		}
+	});
+
+	runner.measure("frozen_ordered_map/find_miss", n, [&] {
+		for (const std::string& key : set.misses) {
+			bench::do_not_optimize(frozen.find(key));
+		}
+	});
+
+	runner.measure("frozen_ordered_map/iterate", n, [&] {
+		size_t sum = 0;
+		for (const auto& pair : frozen) {
+			sum += pair.second;
+		}
+		bench::do_not_optimize(sum);
+	});
+}
+
+BENCHMARK(persistent_avl_map) {
+	const size_t n = runner.config().rows;
+	keyset set = make_keys(n, runner.config().seed);
+
+	runner.measure("persistent_avl_map/insert", n, [&] {
+		dsa::persistent_avl_map<std::string, size_t> map;
+		for (size_t i = 0; i < n; ++i) {
+			map.insert({ set.keys[i], i });
+		}
+		bench::do_not_optimize(map);
+	});
+
+	dsa::persistent_avl_map<std::string, size_t> map;
+	for (size_t i = 0; i < n; ++i) {
+		map.insert({ set.keys[i], i });
+	}
+
+	runner.measure("persistent_avl_map/find_hit", n, [&] {
+		for (const std::string& key : set.lookups) {
+			bench::do_not_optimize(map.find(key));
+		}
+	});
+
+	// A snapshot then one write to it, what a reader pinning a version and
+	// the writer's next update cost
+	runner.measure("persistent_avl_map/snapshot_write", n, [&] {
+		for (size_t i = 0; i < n; ++i) {
+			dsa::persistent_avl_map<std::string, size_t> next(map);
+			next.insert_or_assign({ set.lookups[i], i });
+			bench::do_not_optimize(next);
+		}
+	});
+}
+
+BENCHMARK(list) {
+	const size_t n = runner.config().rows;
+	const size_t small_n = std::min(n, list_linear_limit);
+
+	runner.measure("List/insert_front", n, [&] {
+		List<size_t> list;
+		for (size_t i = 0; i < n; ++i) {
+			list.insertFront(i);
+		}
+		bench::do_not_optimize(list);
+	});
+
+	runner.measure("List/insert_back", small_n, [&] {
+		List<size_t> list;
+		for (size_t i = 0; i < small_n; ++i) {
+			list.insertBack(i);
+		}
+		bench::do_not_optimize(list);
+	});
+
+	List<size_t> list;
+	for (size_t i = 0; i < n; ++i) {
+		list.insertFront(i);
+	}
+
+	runner.measure("List/iterate", n, [&] {
+		size_t sum = 0;
+		for (size_t value : list) {
+			sum += value;
+		}
+		bench::do_not_optimize(sum);
+	});
+
+	List<size_t> small_list;
+	for (size_t i = 0; i < small_n; ++i) {
+		small_list.insertFront(i);
+	}
+
+	runner.measure("List/index", small_n, [&] {
+		size_t sum = 0;
+		for (size_t i = 0; i < small_n; ++i) {
+			sum += small_list[i];
+		}
+		bench::do_not_optimize(sum);
+	});
+}
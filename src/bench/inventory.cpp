@@ -0,0 +1,177 @@
+#include <fcntl.h>
+#include <ostream>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "CSV/CSVStringReader.hpp"
+#include "inventory/Commands.hpp"
+#include "inventory/Inventory.hpp"
+#include "output_buffer.hpp"
+
+BENCHMARK(inventory) {
+	const size_t n = runner.config().rows;
+	std::mt19937_64 rng(runner.config().seed);
+
+	bench::synthetic_inventory generated = bench::make_inventory(n, runner.config().seed);
+	CSV::CSVStringReader reader(generated.csv);
+	CSV::CSVData csv = reader.read();
+
+	runner.measure("inventory/load", n, [&] {
+		inventory::Inventory inv(csv);
+		bench::do_not_optimize(inv);
+	});
+
+	inventory::Inventory inv(csv);
+	bench::null_ostream out;
+
+	// Whole command lines, so argument parsing is included
+	std::vector<std::string> hits;
+	std::vector<std::string> misses;
+
+	for (size_t i = 0; i < n; ++i) {
+		hits.push_back("find " + generated.ids[rng() % generated.ids.size()]);
+		misses.push_back("find " + bench::random_id(rng));
+	}
+
+	runner.measure("repl/find_hit", n, [&] {
+		for (const std::string& line : hits) {
+			inventory::findCommand(inv, inventory::commandArgument(line, "find"), out);
+		}
+	});
+
+	runner.measure("repl/find_miss", n, [&] {
+		for (const std::string& line : misses) {
+			inventory::findCommand(inv, inventory::commandArgument(line, "find"), out);
+		}
+	});
+
+	inventory::Inventory unfiltered(csv);
+	unfiltered.setIdFilterRate(0.0);
+
+	runner.measure("repl/find_miss_unfiltered", n, [&] {
+		for (const std::string& line : misses) {
+			inventory::findCommand(unfiltered, inventory::commandArgument(line, "find"), out);
+		}
+	});
+
+	// Searches for the start of a word of a product's name, and for a word
+	// with one character dropped
+	std::vector<std::string> prefixes;
+	std::vector<std::string> typos;
+
+	for (size_t i = 0; i < n; ++i) {
+		std::vector<std::string> words = inventory::nameWords(inv.product(rng() % inv.size()).name);
+		const std::string& word = words[rng() % words.size()];
+
+		prefixes.push_back("search " + word.substr(0, 3));
+		typos.push_back("search " + (word.size() > 4 ? word.substr(0, 2) + word.substr(3) : word));
+	}
+
+	runner.measure("repl/search_prefix", n, [&] {
+		for (const std::string& line : prefixes) {
+			inventory::searchCommand(inv, inventory::commandArgument(line, "search"), out);
+		}
+	});
+
+	runner.measure("repl/search_typo", n, [&] {
+		for (const std::string& line : typos) {
+			inventory::searchCommand(inv, inventory::commandArgument(line, "search"), out);
+		}
+	});
+
+	// Descriptions share the generator's vocabulary with names, so name
+	// words make queries matching a fair share of the products
+	std::vector<std::string> conjunctions;
+	std::vector<std::string> disjunctions;
+
+	for (size_t i = 0; i < n; ++i) {
+		std::vector<std::string> first = inventory::nameWords(inv.product(rng() % inv.size()).name);
+		std::vector<std::string> second = inventory::nameWords(inv.product(rng() % inv.size()).name);
+		const std::string& a = first[rng() % first.size()];
+		const std::string& b = second[rng() % second.size()];
+
+		conjunctions.push_back("searchText " + a + " " + b);
+		disjunctions.push_back("searchText " + a + " OR " + b);
+	}
+
+	runner.measure("repl/search_text_and", n, [&] {
+		for (const std::string& line : conjunctions) {
+			inventory::searchTextCommand(inv, inventory::commandArgument(line, "searchText"), out);
+		}
+	});
+
+	runner.measure("repl/search_text_or", n, [&] {
+		for (const std::string& line : disjunctions) {
+			inventory::searchTextCommand(inv, inventory::commandArgument(line, "searchText"), out);
+		}
+	});
+
+	// Per row, a single pass over the inventory each
+	runner.measure("repl/stats_by_category", n, [&] {
+		inventory::statsCommand(inv, "price by category", out);
+	});
+
+	runner.measure("repl/stats_by_brand", n, [&] {
+		inventory::statsCommand(inv, "price by brand", out);
+	});
+
+	std::vector<std::string> listings;
+	for (const std::string& category : generated.categories) {
+		listings.push_back("listInventory " + category);
+	}
+
+	runner.measure("repl/list_inventory", listings.size(), [&] {
+		for (const std::string& line : listings) {
+			inventory::listInventoryCommand(inv, inventory::commandArgument(line, "listInventory"), out);
+		}
+	});
+
+	// Through the REPL's output buffer to /dev/null, so write calls count
+	int null_fd = ::open("/dev/null", O_WRONLY);
+	output_buffer fd_buffer(null_fd);
+	std::ostream fd_out(&fd_buffer);
+
+	runner.measure("repl/list_inventory_to_fd", listings.size(), [&] {
+		for (const std::string& line : listings) {
+			inventory::listInventoryCommand(inv, inventory::commandArgument(line, "listInventory"), fd_out);
+		}
+
+		fd_buffer.flush();
+	});
+
+	::close(null_fd);
+
+	// The first page of the largest category, and all of it, by price
+	// Small row counts leave some generated categories without products
+	std::string largest;
+	size_t largestSize = 0;
+
+	for (const std::string& category : generated.categories) {
+		const std::vector<size_t>* members = inv.category(category);
+
+		if (members != nullptr && members->size() > largestSize) {
+			largest = category;
+			largestSize = members->size();
+		}
+	}
+
+	if (largestSize == 0) {
+		return;
+	}
+
+	std::string page = "listInventory " + largest + " order by price desc limit 50";
+	std::string whole = "listInventory " + largest + " order by price desc";
+
+	runner.measure("repl/list_ordered_page", 1, [&] {
+		inventory::listInventoryCommand(inv, inventory::commandArgument(page, "listInventory"), out);
+	});
+
+	runner.measure("repl/list_ordered_all", 1, [&] {
+		inventory::listInventoryCommand(inv, inventory::commandArgument(whole, "listInventory"), out);
+	});
+}
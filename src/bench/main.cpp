@@ -0,0 +1,109 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "bench.hpp"
+
+namespace {
+
+void usage(const char* program) {
+	std::cerr << "Usage: " << program << " [options]\n"
+	          << "  --rows N         Size of generated inventories and containers (default 10000)\n"
+	          << "  --samples N      Timed samples per measurement (default 20)\n"
+	          << "  --warmup N       Untimed calls before the samples (default 1)\n"
+	          << "  --counters       Report hardware counters per op (perf_event_open)\n"
+	          << "  --seed N         Seed for generated data (default 42)\n"
+	          << "  --filter TEXT    Only run measurements whose name contains TEXT\n"
+	          << "  --out FILE       Write JSON results to FILE instead of stdout\n"
+	          << "  --baseline FILE  Compare against JSON results saved by a previous run\n"
+	          << "  --threshold PCT  Slowdown against the baseline counted as a regression (default 10)\n"
+	          << "  --list           List registered benchmarks and exit" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, const char** argv) {
+	bench::config config;
+	std::string out_file;
+	std::string baseline_file;
+	double threshold = 10.0;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool has_value = i + 1 < argc;
+
+		if (arg == "--list") {
+			for (const auto& benchmark : bench::registry()) {
+				std::cout << benchmark.first << std::endl;
+			}
+			return 0;
+		} else if (arg == "--rows" && has_value) {
+			config.rows = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--samples" && has_value) {
+			config.samples = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--warmup" && has_value) {
+			config.warmup = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--counters") {
+			config.counters = true;
+		} else if (arg == "--seed" && has_value) {
+			config.seed = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--filter" && has_value) {
+			config.filter = argv[++i];
+		} else if (arg == "--out" && has_value) {
+			out_file = argv[++i];
+		} else if (arg == "--baseline" && has_value) {
+			baseline_file = argv[++i];
+		} else if (arg == "--threshold" && has_value) {
+			threshold = std::strtod(argv[++i], nullptr);
+		} else {
+			usage(argv[0]);
+			return -1;
+		}
+	}
+
+	if (config.samples == 0) {
+		config.samples = 1;
+	}
+
+	bench::runner runner(config);
+
+	for (const auto& benchmark : bench::registry()) {
+		std::cerr << "Running " << benchmark.first << "..." << std::endl;
+		benchmark.second(runner);
+	}
+
+	if (out_file.empty()) {
+		bench::write_json(std::cout, config, runner.results());
+	} else {
+		std::ofstream out(out_file);
+
+		if (!out.is_open()) {
+			std::cerr << "Failed to open " << out_file << std::endl;
+			return -2;
+		}
+
+		bench::write_json(out, config, runner.results());
+	}
+
+	if (!baseline_file.empty()) {
+		std::ifstream in(baseline_file);
+
+		if (!in.is_open()) {
+			std::cerr << "Failed to open baseline " << baseline_file << std::endl;
+			return -3;
+		}
+
+		size_t regressions = bench::compare_baseline(std::cerr, runner.results(),
+		                                             bench::read_baseline(in),
+		                                             threshold / 100.0);
+
+		if (regressions > 0) {
+			std::cerr << regressions << " regression(s) over " << threshold << "%" << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
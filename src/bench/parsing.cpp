@@ -0,0 +1,48 @@
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+#include "synthetic.hpp"
+
+#include "CSV/CSVStringReader.hpp"
+#include "CSV/Parsing.hpp"
+
+BENCHMARK(parsing) {
+	const size_t n = runner.config().rows;
+	bench::synthetic_inventory inventory = bench::make_inventory(n, runner.config().seed);
+
+	std::vector<std::string> lines;
+	std::istringstream ss(inventory.csv);
+	std::string line;
+
+	std::getline(ss, line); // Skip header
+	while (std::getline(ss, line)) {
+		lines.push_back(line);
+	}
+
+	size_t tokens = 0;
+	for (const std::string& row : lines) {
+		CSV::Parsing::SplitToken stok = { false, "", row };
+		while (!stok.last) {
+			stok = CSV::Parsing::splitFirstToken(stok.residue);
+			++tokens;
+		}
+	}
+
+	runner.measure("Parsing/split_first_token", tokens, [&] {
+		for (const std::string& row : lines) {
+			CSV::Parsing::SplitToken stok = { false, "", row };
+			while (!stok.last) {
+				stok = CSV::Parsing::splitFirstToken(stok.residue);
+				bench::do_not_optimize(stok);
+			}
+		}
+	});
+
+	runner.measure("CSVReader/read", n, [&] {
+		CSV::CSVStringReader reader(inventory.csv);
+		CSV::CSVData csv = reader.read();
+		bench::do_not_optimize(csv);
+	});
+}
@@ -0,0 +1,57 @@
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "bench.hpp"
+
+#include "inventory/Filter.hpp"
+#include "inventory/Inventory.hpp"
+#include "inventory/NumericColumns.hpp"
+#include "inventory/Scan.hpp"
+
+BENCHMARK(scan) {
+	// Columns much larger than the caches, so scans are bound by memory
+	const size_t n = runner.config().rows * 100;
+	std::mt19937_64 rng(runner.config().seed);
+
+	inventory::NumericColumns columns;
+	columns.reserve(n);
+
+	for (size_t i = 0; i < n; ++i) {
+		inventory::Product product;
+		product.price = (rng() % 25000) / 100.0;
+		product.rating = (rng() % 8 == 0) ? std::numeric_limits<double>::quiet_NaN() : 1.0 + (rng() % 41) / 10.0;
+		product.stock = rng() % 500;
+		columns.append(product);
+	}
+
+	const double* prices = columns.column(inventory::NumericColumns::price).data();
+	std::vector<uint64_t> selection(inventory::selectionWords(n));
+
+	std::vector<inventory::ScanIsa> isas = { inventory::ScanIsa::scalar };
+
+	if (inventory::bestScanIsa() != inventory::ScanIsa::scalar) {
+		isas.push_back(inventory::ScanIsa::sse2);
+	}
+
+	if (inventory::bestScanIsa() == inventory::ScanIsa::avx2) {
+		isas.push_back(inventory::ScanIsa::avx2);
+	}
+
+	for (inventory::ScanIsa isa : isas) {
+		runner.measure(std::string("scan/compare_") + inventory::scanIsaName(isa), n, [&] {
+			inventory::compareScan(isa, prices, n, inventory::CompareOp::less, 20.0, selection.data());
+			bench::do_not_optimize(selection);
+		});
+	}
+
+	inventory::Filter filter("price < 20 and rating >= 4 or stock = 0");
+
+	for (inventory::ScanIsa isa : isas) {
+		runner.measure(std::string("scan/filter_") + inventory::scanIsaName(isa), n, [&] {
+			std::vector<uint64_t> selected = filter.select(columns, isa);
+			bench::do_not_optimize(selected);
+		});
+	}
+}
@@ -0,0 +1,39 @@
+#include "synthetic.hpp"
+
+#include <iomanip>
+#include <sstream>
+
+#include "generator/InventoryGenerator.hpp"
+
+namespace bench {
+
+std::string random_id(std::mt19937_64& rng) {
+	std::ostringstream ss;
+	ss << std::hex << std::setfill('0')
+	   << std::setw(16) << rng()
+	   << std::setw(16) << rng();
+	return ss.str();
+}
+
+synthetic_inventory make_inventory(size_t rows, uint64_t seed) {
+	generator::GeneratorOptions options;
+	options.rows = rows;
+	options.seed = seed;
+
+	generator::InventoryGenerator gen(options);
+	synthetic_inventory inventory;
+	std::ostringstream csv;
+
+	gen.write(csv);
+	inventory.csv = csv.str();
+
+	for (size_t row = 0; row < rows; ++row) {
+		inventory.ids.push_back(gen.id(row));
+	}
+
+	inventory.categories = gen.categoryNames();
+
+	return inventory;
+}
+
+} // namespace bench
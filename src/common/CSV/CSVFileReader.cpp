@@ -1,16 +1,50 @@
 #include "CSV/CSVFileReader.hpp"
 
+#include <cstring>
+#include <stdexcept>
+
 namespace CSV {
 
 bool CSVFileReader::eof() const {
-	return file_.eof();
+	return eof_;
 }
 
 std::string CSVFileReader::readline() {
 	std::string line;
-	std::getline(file_, line);
-	return line;
+
+	// Like getline, a last line without a line break sets eof
+	while (true) {
+		if (blockPos_ == blockSize_) {
+			if (!file_->next(block_, blockSize_)) {
+				blockSize_ = 0;
+				blockPos_ = 0;
+				eof_ = true;
+				return line;
+			}
+
+			blockPos_ = 0;
+		}
+
+		const char* begin = block_ + blockPos_;
+		const char* end = static_cast<const char*>(std::memchr(begin, '\n', blockSize_ - blockPos_));
+
+		if (end != nullptr) {
+			line.append(begin, end);
+			blockPos_ = end - block_ + 1;
+			return line;
+		}
+
+		line.append(begin, block_ + blockSize_);
+		blockPos_ = blockSize_;
+	}
 }
 
-} // namespace CSV
+void CSVFileReader::open() {
+	try {
+		file_.reset(new read_ahead(filename_));
+	} catch (const std::runtime_error&) {
+		throw std::invalid_argument("Failed to open file " + filename_);
+	}
+}
 
+} // namespace CSV
@@ -4,10 +4,13 @@
 
 #include "CSV/CSVRow.hpp"
 #include "CSV/CSVTuple.hpp"
+#include "stats.hpp"
 
 namespace CSV {
 
 CSVData CSVReader::read() {
+	PA3_STATS_TIMER(timer, load_parse_ns);
+
 	CSVData csv;
 
 	if (has_header_) {
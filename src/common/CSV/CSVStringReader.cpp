@@ -0,0 +1,15 @@
+#include "CSV/CSVStringReader.hpp"
+
+namespace CSV {
+
+bool CSVStringReader::eof() const {
+	return stream_.eof();
+}
+
+std::string CSVStringReader::readline() {
+	std::string line;
+	std::getline(stream_, line);
+	return line;
+}
+
+} // namespace CSV
@@ -0,0 +1,309 @@
+#include "epoch_domain.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+namespace {
+
+/**
+ * The domains alive, so a thread exiting after a domain was destroyed
+ * leaves its record alone
+ */
+struct domain_registry {
+	std::mutex mutex;
+	std::vector<std::pair<const epoch_domain*, uint64_t>> live;
+	uint64_t next_serial = 1;
+
+	bool alive(const epoch_domain* domain, uint64_t serial) const {
+		return std::find(live.begin(), live.end(), std::make_pair(domain, serial)) != live.end();
+	}
+};
+
+domain_registry& registry() {
+	// Never destroyed, threads may exit after static destructors ran
+	static domain_registry* instance = new domain_registry();
+	return *instance;
+}
+
+uint64_t register_domain(const epoch_domain* domain) {
+	domain_registry& reg = registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	uint64_t serial = reg.next_serial++;
+	reg.live.emplace_back(domain, serial);
+
+	return serial;
+}
+
+} // namespace
+
+struct epoch_domain::thread_records {
+	struct entry {
+		epoch_domain* domain;
+		uint64_t serial;
+		record* rec;
+	};
+
+	~thread_records() {
+		domain_registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.mutex);
+
+		for (const entry& e : entries) {
+			if (reg.alive(e.domain, e.serial)) {
+				e.domain->release(e.rec);
+			}
+		}
+	}
+
+	std::vector<entry> entries;
+};
+
+epoch_domain::epoch_domain(size_t batch) :
+	m_batch(std::max<size_t>(batch, 1)),
+	m_serial(register_domain(this)),
+	m_epoch(0),
+	m_records(nullptr),
+	m_has_orphans(false) {}
+
+epoch_domain::~epoch_domain() {
+	{
+		domain_registry& reg = registry();
+		std::lock_guard<std::mutex> lock(reg.mutex);
+
+		reg.live.erase(std::find(reg.live.begin(), reg.live.end(), std::make_pair(
+			static_cast<const epoch_domain*>(this), m_serial)));
+	}
+
+	record* rec = m_records.load(std::memory_order_acquire);
+
+	while (rec != nullptr) {
+		record* next = rec->next;
+
+		for (retire_list& list : rec->lists) {
+			free(list);
+		}
+
+		delete rec;
+		rec = next;
+	}
+
+	for (retire_list& list : m_orphans) {
+		free(list);
+	}
+}
+
+epoch_domain& epoch_domain::shared() {
+	static epoch_domain domain;
+	return domain;
+}
+
+epoch_domain::guard::guard(epoch_domain& domain) :
+	m_domain(domain),
+	m_record(domain.local()) {
+
+	if (m_record->nesting++ > 0) {
+		return;
+	}
+
+	// Announce an epoch that was still current after the announcement,
+	// otherwise the epoch could advance twice past a stale one
+	uint64_t epoch = m_domain.m_epoch.load(std::memory_order_relaxed);
+
+	while (true) {
+		m_record->state.store((epoch << 1) | pinned, std::memory_order_seq_cst);
+
+		uint64_t current = m_domain.m_epoch.load(std::memory_order_seq_cst);
+
+		if (current == epoch) {
+			break;
+		}
+
+		epoch = current;
+	}
+}
+
+epoch_domain::guard::~guard() {
+	if (--m_record->nesting == 0) {
+		m_record->state.store(m_record->state.load(std::memory_order_relaxed) & ~pinned, std::memory_order_release);
+	}
+}
+
+void epoch_domain::retire(void* ptr, void (*deleter)(void*)) {
+	record* rec = local();
+	uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+	retire_list& list = rec->lists[epoch % 3];
+
+	// The list last held an epoch at least three before this one
+	if (list.epoch != epoch) {
+		rec->pending -= list.items.size();
+		free(list);
+		list.epoch = epoch;
+	}
+
+	list.items.push_back(retired{ ptr, deleter });
+	++rec->pending;
+
+	if (++rec->since_collect >= m_batch) {
+		try_advance();
+		collect(rec);
+		collect_orphans();
+	}
+}
+
+void epoch_domain::quiescent() {
+	reclaim();
+}
+
+bool epoch_domain::reclaim() {
+	record* rec = local();
+
+	try_advance();
+	collect(rec);
+	collect_orphans();
+
+	return rec->pending == 0 && !m_has_orphans.load(std::memory_order_acquire);
+}
+
+size_t epoch_domain::pending() {
+	return local()->pending;
+}
+
+void* epoch_domain::record::operator new(size_t size) {
+	void* ptr = nullptr;
+
+	if (posix_memalign(&ptr, alignof(record), size) != 0) {
+		throw std::bad_alloc();
+	}
+
+	return ptr;
+}
+
+void epoch_domain::record::operator delete(void* ptr) {
+	std::free(ptr);
+}
+
+epoch_domain::record* epoch_domain::local() {
+	static thread_local thread_records records;
+
+	for (const thread_records::entry& e : records.entries) {
+		if (e.domain == this && e.serial == m_serial) {
+			return e.rec;
+		}
+	}
+
+	// Forget a destroyed domain that lived at the same address
+	records.entries.erase(std::remove_if(records.entries.begin(), records.entries.end(),
+	                                     [this](const thread_records::entry& e) { return e.domain == this; }),
+	                      records.entries.end());
+
+	record* rec = acquire();
+	records.entries.push_back(thread_records::entry{ this, m_serial, rec });
+
+	return rec;
+}
+
+epoch_domain::record* epoch_domain::acquire() {
+	for (record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+		bool expected = false;
+
+		if (!rec->in_use.load(std::memory_order_relaxed) &&
+		    rec->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+			return rec;
+		}
+	}
+
+	record* rec = new record();
+	rec->next = m_records.load(std::memory_order_relaxed);
+
+	while (!m_records.compare_exchange_weak(rec->next, rec, std::memory_order_release, std::memory_order_relaxed)) {
+	}
+
+	return rec;
+}
+
+void epoch_domain::release(record* rec) {
+	{
+		std::lock_guard<std::mutex> lock(m_orphans_mutex);
+
+		for (retire_list& list : rec->lists) {
+			if (!list.items.empty()) {
+				m_orphans.push_back(std::move(list));
+				list.items.clear();
+			}
+		}
+
+		m_has_orphans.store(!m_orphans.empty(), std::memory_order_release);
+	}
+
+	rec->nesting = 0;
+	rec->pending = 0;
+	rec->since_collect = 0;
+	rec->state.store(0, std::memory_order_relaxed);
+	rec->in_use.store(false, std::memory_order_release);
+}
+
+bool epoch_domain::try_advance() {
+	// Unlinking must be visible before checking for readers
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+
+	for (record* rec = m_records.load(std::memory_order_acquire); rec != nullptr; rec = rec->next) {
+		uint64_t state = rec->state.load(std::memory_order_seq_cst);
+
+		if ((state & pinned) != 0 && (state >> 1) != epoch) {
+			return false;
+		}
+	}
+
+	return m_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+}
+
+void epoch_domain::collect(record* rec) {
+	uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+
+	for (retire_list& list : rec->lists) {
+		if (!list.items.empty() && list.epoch + 2 <= epoch) {
+			rec->pending -= list.items.size();
+			free(list);
+		}
+	}
+
+	rec->since_collect = 0;
+}
+
+void epoch_domain::collect_orphans() {
+	if (!m_has_orphans.load(std::memory_order_acquire)) {
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_orphans_mutex, std::try_to_lock);
+
+	if (!lock.owns_lock()) {
+		return;
+	}
+
+	uint64_t epoch = m_epoch.load(std::memory_order_seq_cst);
+
+	auto safe = [epoch](retire_list& list) {
+		if (list.epoch + 2 > epoch) {
+			return false;
+		}
+
+		free(list);
+		return true;
+	};
+
+	m_orphans.erase(std::remove_if(m_orphans.begin(), m_orphans.end(), safe), m_orphans.end());
+	m_has_orphans.store(!m_orphans.empty(), std::memory_order_release);
+}
+
+void epoch_domain::free(retire_list& list) {
+	for (const retired& item : list.items) {
+		item.deleter(item.ptr);
+	}
+
+	list.items.clear();
+}
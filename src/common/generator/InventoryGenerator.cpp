@@ -0,0 +1,520 @@
+#include "generator/InventoryGenerator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace generator {
+
+namespace {
+
+const char* const columns[] = {
+	"Uniq Id", "Product Name", "Brand Name", "Asin", "Category", "Upc Ean Code",
+	"List Price", "Selling Price", "Rating", "Quantity", "Model Number", "About Product",
+	"Product Specification", "Technical Details", "Shipping Weight", "Product Dimensions",
+	"Image", "Variants", "Sku", "Product Url", "Stock", "Product Details", "Dimensions",
+	"Color", "Ingredients", "Direction To Use", "Is Amazon Seller", "Size Quantity Variant",
+	"Product Description",
+};
+
+const char* const departments[] = {
+	"Toys & Games", "Home & Kitchen", "Sports & Outdoors", "Clothing, Shoes & Jewelry",
+	"Arts, Crafts & Sewing", "Office Products", "Electronics", "Baby Products",
+	"Health & Household", "Beauty & Personal Care", "Pet Supplies", "Automotive",
+};
+
+const char* const subcategories[] = {
+	"Learning & Education", "Puzzles", "Action Figures & Statues", "Kitchen & Dining",
+	"Storage & Organization", "Outdoor Recreation", "Fan Shop", "Costumes & Accessories",
+	"Painting, Drawing & Art Supplies", "Office & School Supplies", "Novelty & Gag Toys",
+	"Nursery", "Games", "Party Supplies", "Stuffed Animals & Plush Toys", "Dolls & Accessories",
+	"Building Toys", "Hobbies", "Vehicles", "Tricycles, Scooters & Wagons",
+};
+
+const char* const adjectives[] = {
+	"Magnetic", "Wooden", "Electronic", "Remote Control", "Educational", "Musical",
+	"Inflatable", "Collectible", "Plush", "Scale Model", "Glow in the Dark", "Travel",
+	"Classic", "Mini", "Outdoor", "Kids", "Deluxe", "Magic",
+};
+
+const char* const nouns[] = {
+	"Puzzles", "Blocks", "Kits", "Figures", "Cards", "Balls", "Trains", "Cars",
+	"Sets", "Games", "Dolls", "Boards", "Instruments", "Bottles", "Stickers", "Books",
+};
+
+const char* const words[] = {
+	"the", "with", "and", "for", "kids", "toy", "set", "fun", "easy", "use", "great",
+	"gift", "quality", "durable", "safe", "non-toxic", "material", "perfect", "size",
+	"play", "learning", "colorful", "design", "includes", "pieces", "batteries", "ages",
+	"years", "up", "made", "from", "premium", "wood", "plastic", "portable", "storage",
+	"indoor", "outdoor", "family", "party", "birthday", "holiday", "boys", "girls",
+	"adults", "creative", "skills", "develop", "hand-eye", "coordination", "bright",
+	"lightweight", "sturdy", "assembly", "required", "official", "licensed", "classic",
+	"edition", "collection", "pack", "bonus", "original", "genuine",
+};
+
+const char* const brands[] = {
+	"Melissa & Doug", "LEGO", "Hasbro", "Mattel", "Funko", "Learning Resources", "Ravensburger",
+	"Crayola", "Fisher-Price", "Nerf", "Hot Wheels", "Playmobil", "VTech", "KidKraft",
+};
+
+const char hexDigits[] = "0123456789abcdef";
+const char alnumDigits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+// Domain tags keep the per-row random streams independent
+const uint64_t rowTag = 0x726f77;
+const uint64_t idTag = 0x6964;
+const uint64_t missTag = 0x6d697373;
+const uint64_t traceTag = 0x7472616365;
+
+template <typename T, size_t N>
+size_t countOf(const T (&)[N]) { return N; }
+
+/**
+ * @brief splitmix64, small and fast with good statistical quality
+ */
+class Random {
+public:
+	explicit Random(uint64_t state) : state_(state) {}
+
+	Random(uint64_t seed, uint64_t stream, uint64_t tag) :
+		state_(mix(seed ^ mix(stream + tag * 0x9e3779b97f4a7c15ull))) {}
+
+	uint64_t next() {
+		state_ += 0x9e3779b97f4a7c15ull;
+		return mix(state_);
+	}
+
+	size_t below(size_t bound) { return next() % bound; }
+
+	double uniform() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+	bool chance(double probability) { return uniform() < probability; }
+
+	template <typename T, size_t N>
+	const T& pick(const T (&array)[N]) { return array[below(N)]; }
+
+private:
+	static uint64_t mix(uint64_t z) {
+		z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+		z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+		return z ^ (z >> 31);
+	}
+
+	uint64_t state_;
+};
+
+void appendHex(std::string& out, uint64_t value, int digits) {
+	for (int i = digits - 1; i >= 0; --i) {
+		out += hexDigits[(value >> (i * 4)) & 0xf];
+	}
+}
+
+void appendAlnum(std::string& out, Random& random, int digits) {
+	for (int i = 0; i < digits; ++i) {
+		out += alnumDigits[random.below(sizeof(alnumDigits) - 1)];
+	}
+}
+
+void appendPrice(std::string& out, uint64_t cents) {
+	out += '$';
+	out += std::to_string(cents / 100);
+	out += '.';
+	out += static_cast<char>('0' + cents / 10 % 10);
+	out += static_cast<char>('0' + cents % 10);
+}
+
+/**
+ * @brief Appends a field, quoting it if it contains a separator or quote
+ *
+ * Quotes inside the field are escaped with a backslash, the escape CSV::Parsing
+ * understands.
+ */
+void appendField(std::string& out, const std::string& field) {
+	bool quote = field.find_first_of(",\"") != std::string::npos;
+
+	if (!quote) {
+		out += field;
+		return;
+	}
+
+	out += '"';
+
+	for (char c : field) {
+		if (c == '"') {
+			out += '\\';
+		}
+		out += c;
+	}
+
+	out += '"';
+}
+
+/**
+ * @brief Generates roughly @p length characters of product text
+ *
+ * Sentences are separated by " | " like the dataset's about column, and
+ * contain commas so the field must be quoted.
+ */
+std::string makeText(Random& random, size_t length) {
+	std::string text;
+
+	while (text.size() < length) {
+		if (!text.empty()) {
+			text += " | ";
+		}
+
+		size_t sentenceWords = 6 + random.below(10);
+
+		for (size_t w = 0; w < sentenceWords; ++w) {
+			if (w > 0) {
+				text += (random.chance(0.1) ? ", " : " ");
+			}
+			text += random.pick(words);
+		}
+
+		text += '.';
+	}
+
+	return text;
+}
+
+} // namespace
+
+InventoryGenerator::InventoryGenerator(const GeneratorOptions& options) :
+	options_(options) {
+
+	if (options_.categories == 0) {
+		throw std::invalid_argument("Generator needs at least one category");
+	}
+
+	size_t departmentCount = countOf(departments);
+	size_t subcategoryCount = countOf(subcategories);
+
+	// Department and subcategory names are listed once, only if a path uses them
+	for (size_t d = 0; d < std::min(departmentCount, options_.categories); ++d) {
+		categoryNames_.push_back(departments[d]);
+	}
+	for (size_t s = 0; s < subcategoryCount && s * departmentCount < options_.categories; ++s) {
+		categoryNames_.push_back(subcategories[s]);
+	}
+
+	// Leaf names are unique per path: adjective + noun, numbered once those run out
+	size_t leafCombinations = countOf(adjectives) * countOf(nouns);
+
+	for (size_t c = 0; c < options_.categories; ++c) {
+		size_t combination = c % leafCombinations;
+
+		std::string leaf = std::string(adjectives[combination % countOf(adjectives)]) + " "
+		                   + nouns[combination / countOf(adjectives)];
+
+		if (c >= leafCombinations) {
+			leaf += " " + std::to_string(c / leafCombinations + 1);
+		}
+
+		categoryPaths_.push_back(std::string(departments[c % departmentCount]) + " | "
+		                         + subcategories[(c / departmentCount) % subcategoryCount] + " | "
+		                         + leaf);
+		categoryNames_.push_back(leaf);
+	}
+
+	// Zipf: path c has weight 1 / (c + 1)^s
+	double total = 0.0;
+
+	for (size_t c = 0; c < options_.categories; ++c) {
+		total += 1.0 / std::pow(static_cast<double>(c + 1), options_.zipfExponent);
+		categoryCdf_.push_back(total);
+	}
+
+	for (double& cumulative : categoryCdf_) {
+		cumulative /= total;
+	}
+}
+
+void InventoryGenerator::write(std::ostream& out) const {
+	writeHeader(out);
+	writeRows(out, 0, options_.rows);
+}
+
+void InventoryGenerator::writeHeader(std::ostream& out) const {
+	std::string header;
+
+	for (size_t i = 0; i < countOf(columns); ++i) {
+		header += (i ? "," : "");
+		header += columns[i];
+	}
+
+	out << header << '\n';
+}
+
+void InventoryGenerator::writeRows(std::ostream& out, size_t begin, size_t end) const {
+	// Buffered so large outputs are written in big chunks
+	const size_t flushSize = 1 << 20;
+	std::string buffer;
+	buffer.reserve(flushSize + 8 * options_.textLength + 4096);
+
+	for (size_t row = begin; row < end; ++row) {
+		appendRow(buffer, row);
+
+		if (buffer.size() >= flushSize) {
+			out.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	}
+
+	out.write(buffer.data(), buffer.size());
+}
+
+std::string InventoryGenerator::id(size_t row) const {
+	Random random(options_.seed, row, idTag);
+	std::string id;
+
+	// Row ids always start with 0-7, missing ids with 8-f
+	appendHex(id, random.next() & ~(1ull << 63), 16);
+	appendHex(id, random.next(), 16);
+
+	return id;
+}
+
+std::string InventoryGenerator::missingId(size_t n) const {
+	Random random(options_.seed, n, missTag);
+	std::string id;
+
+	appendHex(id, random.next() | (1ull << 63), 16);
+	appendHex(id, random.next(), 16);
+
+	return id;
+}
+
+size_t InventoryGenerator::categoryOf(size_t row) const {
+	Random random(options_.seed, row, rowTag);
+	return sampleCategory(random.uniform());
+}
+
+size_t InventoryGenerator::sampleCategory(double uniform) const {
+	auto it = std::upper_bound(categoryCdf_.begin(), categoryCdf_.end(), uniform);
+	return std::min<size_t>(it - categoryCdf_.begin(), categoryCdf_.size() - 1);
+}
+
+void InventoryGenerator::appendRow(std::string& out, size_t row) const {
+	Random random(options_.seed, row, rowTag);
+
+	// Must be drawn first, categoryOf recomputes it from the same stream
+	size_t category = sampleCategory(random.uniform());
+
+	std::string asin = "B0";
+	appendAlnum(asin, random, 8);
+
+	// Uniq Id
+	out += id(row);
+	out += ',';
+
+	// Product Name, sometimes with commas and quotes
+	std::string name = random.pick(brands);
+
+	size_t nameWords = 2 + random.below(6);
+	for (size_t w = 0; w < nameWords; ++w) {
+		name += ' ';
+		name += random.pick(words);
+	}
+	if (random.chance(0.1)) {
+		name += ' ';
+		name += std::to_string(2 + random.below(30));
+		name += "\" Inch";
+	}
+	if (random.chance(0.3)) {
+		name += ", ";
+		name += random.pick(adjectives);
+		name += ' ';
+		name += random.pick(nouns);
+	}
+	appendField(out, name);
+	out += ',';
+
+	// Brand Name
+	if (random.chance(0.4)) {
+		appendField(out, random.pick(brands));
+	}
+	out += ',';
+
+	// Asin
+	out += asin;
+	out += ',';
+
+	// Category
+	appendField(out, categoryPaths_[category]);
+	out += ',';
+
+	// Upc Ean Code
+	if (random.chance(0.2)) {
+		out += std::to_string(100000000000ull + random.below(900000000000ull));
+	}
+	out += ',';
+
+	// List Price, Selling Price (occasionally a range)
+	uint64_t cents = 99 + random.below(25000);
+
+	if (random.chance(0.1)) {
+		appendPrice(out, cents + cents / 5);
+	}
+	out += ',';
+
+	if (random.chance(0.03)) {
+		std::string range;
+		appendPrice(range, cents);
+		range += " - ";
+		appendPrice(range, cents + random.below(5000));
+		out += range;
+	} else if (random.chance(0.97)) {
+		appendPrice(out, cents);
+	}
+	out += ',';
+
+	// Rating
+	if (random.chance(0.85)) {
+		uint64_t rating = 10 + random.below(41);
+		out += std::to_string(rating / 10);
+		out += '.';
+		out += static_cast<char>('0' + rating % 10);
+	}
+	out += ',';
+
+	// Quantity
+	if (random.chance(0.05)) {
+		out += std::to_string(1 + random.below(24));
+	}
+	out += ',';
+
+	// Model Number
+	if (random.chance(0.6)) {
+		appendAlnum(out, random, 4 + random.below(6));
+	}
+	out += ',';
+
+	// About Product
+	appendField(out, "Make sure this fits by entering your model number. | "
+	                 + makeText(random, options_.textLength));
+	out += ',';
+
+	// Product Specification
+	std::string specification = "ProductDimensions:" + std::to_string(1 + random.below(20)) + "x"
+	                            + std::to_string(1 + random.below(20)) + "x"
+	                            + std::to_string(1 + random.below(20)) + "inches|ItemWeight:"
+	                            + std::to_string(1 + random.below(80)) + "ounces|ASIN:" + asin;
+	appendField(out, specification);
+	out += ',';
+
+	// Technical Details
+	if (random.chance(0.8)) {
+		appendField(out, makeText(random, options_.textLength / 2));
+	}
+	out += ',';
+
+	// Shipping Weight
+	out += std::to_string(1 + random.below(30));
+	out += '.';
+	out += std::to_string(random.below(10));
+	out += " pounds,";
+
+	// Product Dimensions
+	if (random.chance(0.4)) {
+		out += std::to_string(1 + random.below(20)) + " x " + std::to_string(1 + random.below(20))
+		       + " x " + std::to_string(1 + random.below(20)) + " inches";
+	}
+	out += ',';
+
+	// Image, several urls separated by '|'
+	size_t images = 1 + random.below(5);
+	for (size_t i = 0; i < images; ++i) {
+		out += (i ? "|" : "");
+		out += "https://images-na.ssl-images-amazon.com/images/I/";
+		appendAlnum(out, random, 11);
+		out += ".jpg";
+	}
+	out += ',';
+
+	// Variants
+	if (random.chance(0.25)) {
+		out += "https://www.amazon.com/dp/B0";
+		appendAlnum(out, random, 8);
+	}
+	out += ',';
+
+	// Sku
+	out += ',';
+
+	// Product Url
+	out += "https://www.amazon.com/";
+	out += random.pick(words);
+	out += '-';
+	out += random.pick(words);
+	out += "/dp/";
+	out += asin;
+	out += ',';
+
+	// Stock
+	if (random.chance(0.3)) {
+		out += std::to_string(random.below(500));
+	}
+	out += ',';
+
+	// Product Details, Dimensions, Color, Ingredients, Direction To Use
+	out += ",,";
+	if (random.chance(0.05)) {
+		out += random.pick(adjectives);
+	}
+	out += ",,,";
+
+	// Is Amazon Seller
+	out += random.chance(0.9) ? "Y" : "N";
+	out += ',';
+
+	// Size Quantity Variant
+	out += ',';
+
+	// Product Description
+	if (random.chance(0.05)) {
+		appendField(out, makeText(random, options_.textLength));
+	}
+
+	out += '\n';
+}
+
+void writeQueryTrace(const InventoryGenerator& generator, const TraceOptions& options, std::ostream& out) {
+	Random random(generator.options().seed, options.seed, traceTag);
+	size_t rows = generator.options().rows;
+
+	std::string buffer;
+
+	for (size_t q = 0; q < options.queries; ++q) {
+		bool list = random.chance(options.listRatio);
+		bool hit = random.chance(options.hitRatio) && (list || rows > 0);
+
+		if (list) {
+			buffer += "listInventory ";
+
+			if (hit) {
+				// Leaf names of popular paths are listed more often
+				size_t category = generator.sampleCategory(random.uniform());
+				const std::string& path = generator.categoryPath(category);
+				buffer += path.substr(path.rfind("| ") + 2);
+			} else {
+				buffer += "Missing Category " + std::to_string(random.below(1000000));
+			}
+		} else {
+			buffer += "find ";
+			buffer += hit ? generator.id(random.below(rows)) : generator.missingId(q);
+		}
+
+		buffer += '\n';
+
+		if (buffer.size() >= (1 << 20)) {
+			out.write(buffer.data(), buffer.size());
+			buffer.clear();
+		}
+	}
+
+	out.write(buffer.data(), buffer.size());
+}
+
+} // namespace generator
@@ -0,0 +1,175 @@
+#include "inventory/Aggregate.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "dsa/hash.hpp"
+#include "dsa/unordered_map.hpp"
+#include "inventory/Inventory.hpp"
+#include "thread_pool.hpp"
+
+namespace inventory {
+
+namespace {
+
+// Fewer rows than this per thread cost more to start than they save
+const size_t minRowsPerThread = 65536;
+
+using BrandStats = dsa::unordered_map<std::string, ColumnStats, dsa::wyhash>;
+
+/**
+ * @brief Partial aggregate of one range of products
+ */
+struct Partial {
+	std::vector<ColumnStats> groups; // By category id, or a single group
+	BrandStats brands;
+};
+
+void aggregateRange(const Inventory& inventory, const double* values, GroupBy by,
+                    size_t begin, size_t end, Partial& partial) {
+	switch (by) {
+	case GroupBy::all:
+		partial.groups.resize(1);
+
+		for (size_t pos = begin; pos < end; ++pos) {
+			partial.groups[0].add(values[pos]);
+		}
+
+		break;
+
+	case GroupBy::category:
+		partial.groups.resize(inventory.categoryCount());
+
+		// Member lists are sorted, walking the part of each in the range
+		// reads the column in order without touching the products
+		for (size_t category = 0; category < inventory.categoryCount(); ++category) {
+			const std::vector<size_t>& members = inventory.categoryMembers(category);
+			auto first = std::lower_bound(members.begin(), members.end(), begin);
+			auto last = std::lower_bound(first, members.end(), end);
+			ColumnStats& stats = partial.groups[category];
+
+			for (auto it = first; it != last; ++it) {
+				stats.add(values[*it]);
+			}
+		}
+
+		break;
+
+	case GroupBy::brand:
+		for (size_t pos = begin; pos < end; ++pos) {
+			const std::string& brand = inventory.product(pos).brand;
+			auto it = partial.brands.find(brand);
+
+			if (it == partial.brands.end()) {
+				it = partial.brands.insert({ brand, ColumnStats() }).first;
+			}
+
+			it->second.add(values[pos]);
+		}
+
+		break;
+	}
+}
+
+} // namespace
+
+ColumnStats::ColumnStats() :
+	min(std::numeric_limits<double>::quiet_NaN()),
+	max(std::numeric_limits<double>::quiet_NaN()) {}
+
+void ColumnStats::add(double value) {
+	++products;
+
+	if (std::isnan(value)) {
+		return;
+	}
+
+	// Written so the first value replaces the NaN bounds
+	min = (value >= min) ? min : value;
+	max = (value <= max) ? max : value;
+	sum += value;
+	++count;
+}
+
+void ColumnStats::merge(const ColumnStats& other) {
+	products += other.products;
+
+	if (other.count == 0) {
+		return;
+	}
+
+	min = (other.min >= min) ? min : other.min;
+	max = (other.max <= max) ? max : other.max;
+	sum += other.sum;
+	count += other.count;
+}
+
+double ColumnStats::mean() const {
+	return (count == 0) ? std::numeric_limits<double>::quiet_NaN() : sum / count;
+}
+
+std::vector<GroupStats> aggregate(const Inventory& inventory, NumericColumns::Column column, GroupBy by, size_t threads) {
+	size_t rows = inventory.size();
+	const double* values = inventory.columns().column(column).data();
+
+	thread_pool& pool = thread_pool::shared();
+
+	if (threads == 0) {
+		threads = std::max<size_t>(1, std::min(pool.concurrency(), rows / minRowsPerThread));
+	}
+
+	std::vector<Partial> partials(std::max<size_t>(1, pool.chunk_count(0, rows, threads)));
+
+	pool.parallel_for(0, rows, partials.size(), [&](size_t chunk, size_t begin, size_t end) {
+		aggregateRange(inventory, values, by, begin, end, partials[chunk]);
+	});
+
+	// An empty inventory still has its groups
+	if (rows == 0) {
+		aggregateRange(inventory, values, by, 0, 0, partials[0]);
+	}
+
+	// Merge into the first partial
+	Partial& total = partials.front();
+
+	for (size_t t = 1; t < partials.size(); ++t) {
+		for (size_t g = 0; g < partials[t].groups.size(); ++g) {
+			total.groups[g].merge(partials[t].groups[g]);
+		}
+
+		for (const auto& pair : partials[t].brands) {
+			auto it = total.brands.find(pair.first);
+
+			if (it == total.brands.end()) {
+				total.brands.insert({ pair.first, pair.second });
+			} else {
+				it->second.merge(pair.second);
+			}
+		}
+	}
+
+	std::vector<GroupStats> results;
+
+	if (by == GroupBy::all) {
+		results.emplace_back("All products", total.groups[0]);
+	} else if (by == GroupBy::category) {
+		for (size_t category = 0; category < total.groups.size(); ++category) {
+			if (total.groups[category].products > 0) {
+				results.emplace_back(inventory.categoryName(category), total.groups[category]);
+			}
+		}
+	} else {
+		for (const auto& pair : total.brands) {
+			results.emplace_back(pair.first.empty() ? "(no brand)" : pair.first, pair.second);
+		}
+	}
+
+	std::sort(results.begin(), results.end(), [](const GroupStats& a, const GroupStats& b) {
+		return a.first < b.first;
+	});
+
+	return results;
+}
+
+} // namespace inventory
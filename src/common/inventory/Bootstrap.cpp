@@ -0,0 +1,115 @@
+#include "inventory/Bootstrap.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+#include "CSV/CSVRow.hpp"
+#include "inventory/Inventory.hpp"
+#include "read_ahead.hpp"
+#include "thread_pool.hpp"
+
+namespace inventory {
+
+namespace {
+
+// Less text than this per thread costs more to start than it saves
+const size_t minChunkBytes = 1 << 20;
+
+/**
+ * @brief Products and description text parsed from one chunk of lines
+ */
+struct Chunk {
+	size_t begin;
+	size_t end;
+	std::vector<Product> products;
+	std::vector<std::string> texts;
+};
+
+void parseChunk(const std::string& csv, const ProductColumns& columns, Chunk& chunk) {
+	size_t begin = chunk.begin;
+
+	while (begin < chunk.end) {
+		size_t end = std::min(csv.find('\n', begin), chunk.end);
+
+		CSV::CSVRow row(csv.substr(begin, end - begin));
+		begin = end + 1;
+
+		Product product;
+		product.price = std::numeric_limits<double>::quiet_NaN();
+
+		std::string text;
+		size_t col = 0;
+
+		for (const std::string& cell : row) {
+			columns.set(product, text, col++, cell);
+		}
+
+		if (!product.id.empty()) {
+			chunk.products.push_back(std::move(product));
+			chunk.texts.push_back(std::move(text));
+		}
+	}
+}
+
+} // namespace
+
+std::string readFile(const std::string& filename) {
+	read_ahead file(filename);
+	std::string data;
+	data.reserve(static_cast<size_t>(file.file_size()));
+
+	const char* block = nullptr;
+	size_t size = 0;
+
+	while (file.next(block, size)) {
+		data.append(block, size);
+	}
+
+	return data;
+}
+
+void parseProducts(const std::string& csv, std::vector<Product>& products, std::vector<std::string>& texts,
+                   size_t threads) {
+	size_t headerEnd = std::min(csv.find('\n'), csv.size());
+	ProductColumns columns{ CSV::CSVRow(csv.substr(0, headerEnd)) };
+
+	size_t begin = std::min(headerEnd + 1, csv.size());
+
+	thread_pool& pool = thread_pool::shared();
+
+	if (threads == 0) {
+		threads = pool.concurrency();
+	}
+
+	size_t chunkCount = std::max<size_t>(1, std::min(threads, (csv.size() - begin) / minChunkBytes));
+	std::vector<Chunk> chunks(chunkCount);
+
+	// Each chunk ends after the first line break past its share of the text
+	for (size_t c = 0; c < chunkCount; ++c) {
+		chunks[c].begin = (c == 0) ? begin : chunks[c - 1].end;
+		chunks[c].end = csv.size();
+
+		if (c + 1 < chunkCount) {
+			size_t share = begin + (csv.size() - begin) * (c + 1) / chunkCount;
+			chunks[c].end = std::min(csv.find('\n', std::max(share, chunks[c].begin)), csv.size() - 1) + 1;
+		}
+	}
+
+	pool.parallel_for(0, chunkCount, chunkCount, [&](size_t chunk, size_t, size_t) {
+		parseChunk(csv, columns, chunks[chunk]);
+	});
+
+	products.clear();
+	texts.clear();
+
+	for (Chunk& chunk : chunks) {
+		products.insert(products.end(), std::make_move_iterator(chunk.products.begin()),
+		                std::make_move_iterator(chunk.products.end()));
+		texts.insert(texts.end(), std::make_move_iterator(chunk.texts.begin()),
+		             std::make_move_iterator(chunk.texts.end()));
+	}
+}
+
+} // namespace inventory
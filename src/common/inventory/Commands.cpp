@@ -0,0 +1,242 @@
+#include "inventory/Commands.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <stdexcept>
+
+#include "CSV/Parsing.hpp"
+#include "inventory/Aggregate.hpp"
+#include "inventory/SortedListing.hpp"
+#include "stats.hpp"
+
+namespace inventory {
+
+namespace {
+
+/**
+ * @brief Splits an optional trailing "limit N" off a command's argument
+ *
+ * @returns N, or defaultLimit if there is none
+ */
+size_t splitLimit(const std::string& argument, std::string& text, size_t defaultLimit = 10) {
+	text = argument;
+
+	std::string::size_type split = argument.rfind(" limit ");
+
+	if (split != std::string::npos) {
+		std::string count = argument.substr(split + 7);
+		char* end = nullptr;
+		unsigned long value = std::strtoul(count.c_str(), &end, 10);
+
+		if (!count.empty() && *end == '\0') {
+			text = argument.substr(0, split);
+			return value;
+		}
+	}
+
+	return defaultLimit;
+}
+
+void printMatches(const Inventory& inventory, const std::vector<size_t>& matches, std::ostream& out) {
+	if (matches.empty()) {
+		out << "No matching products\n";
+		return;
+	}
+
+	for (size_t pos : matches) {
+		const Product& product = inventory.product(pos);
+		out << product.id << ": " << product.name << '\n';
+	}
+}
+
+} // namespace
+
+void findCommand(const Inventory& inventory, const std::string& id, std::ostream& out) {
+	PA3_STATS_TIMER(timer, command_find_ns);
+
+	const Product* product = inventory.find(id);
+
+	if (product == nullptr) {
+		out << "Inventory not found\n";
+		return;
+	}
+
+	out << "Id: " << product->id << '\n'
+	    << "Name: " << product->name << '\n'
+	    << "Brand: " << product->brand << '\n'
+	    << "Asin: " << product->asin << '\n'
+	    << "Category: " << product->category << '\n'
+	    << "Price: ";
+
+	if (std::isnan(product->price)) {
+		out << "N/A";
+	} else {
+		out << '$' << product->price;
+	}
+
+	out << '\n';
+}
+
+void listInventoryCommand(const Inventory& inventory, const std::string& argument, std::ostream& out) {
+	PA3_STATS_TIMER(timer, command_list_inventory_ns);
+
+	std::string name;
+	size_t limit = splitLimit(argument, name, SortedListing::unlimited);
+
+	// An optional "order by <column> [asc|desc]" before the limit
+	NumericColumns::Column column = NumericColumns::columnCount;
+	bool descending = false;
+	std::string::size_type split = name.rfind(" order by ");
+
+	if (split != std::string::npos) {
+		std::istringstream words(name.substr(split + 10));
+		std::string columnName;
+		std::string direction;
+		std::string extra;
+
+		words >> columnName >> direction >> extra;
+		column = NumericColumns::find(columnName);
+
+		if (column == NumericColumns::columnCount || !extra.empty()
+		    || (!direction.empty() && direction != "asc" && direction != "desc")) {
+			out << "Invalid order, expected \"order by <column> [asc|desc]\"\n";
+			return;
+		}
+
+		descending = (direction == "desc");
+		name.erase(split);
+	}
+
+	size_t category = inventory.findCategory(name);
+
+	if (category == Inventory::noCategory) {
+		out << "Invalid Category\n";
+		return;
+	}
+
+	if (column == NumericColumns::columnCount) {
+		const std::vector<size_t>& members = inventory.categoryMembers(category);
+
+		for (size_t i = 0; i < members.size() && i < limit; ++i) {
+			const Product& product = inventory.product(members[i]);
+			out << product.id << ": " << product.name << '\n';
+		}
+
+		return;
+	}
+
+	SortedListing listing(inventory, category, column, descending, limit);
+	size_t pos = 0;
+
+	while (listing.next(pos)) {
+		const Product& product = inventory.product(pos);
+		out << product.id << ": " << product.name << '\n';
+	}
+}
+
+void searchCommand(const Inventory& inventory, const std::string& argument, std::ostream& out) {
+	PA3_STATS_TIMER(timer, command_search_ns);
+
+	std::string text;
+	size_t limit = splitLimit(argument, text);
+
+	printMatches(inventory, inventory.search(text, limit), out);
+}
+
+void searchTextCommand(const Inventory& inventory, const std::string& argument, std::ostream& out) {
+	PA3_STATS_TIMER(timer, command_search_text_ns);
+
+	std::string query;
+	size_t limit = splitLimit(argument, query);
+
+	printMatches(inventory, inventory.searchText(query, limit), out);
+}
+
+void whereCommand(const Inventory& inventory, const std::string& argument, std::ostream& out) {
+	PA3_STATS_TIMER(timer, command_where_ns);
+
+	std::string text;
+	size_t limit = splitLimit(argument, text);
+	std::vector<uint64_t> selection;
+
+	try {
+		selection = inventory.select(Filter(text));
+	} catch (const std::invalid_argument& e) {
+		out << "Invalid filter: " << e.what() << '\n';
+		return;
+	}
+
+	size_t listed = 0;
+
+	forEachSelected(selection.data(), selection.size(), [&](size_t pos) {
+		if (listed == limit) {
+			return false;
+		}
+
+		const Product& product = inventory.product(pos);
+		out << product.id << ": " << product.name << '\n';
+		++listed;
+		return true;
+	});
+
+	out << selectionCount(selection.data(), selection.size()) << " matching products\n";
+}
+
+void statsCommand(const Inventory& inventory, const std::string& argument, std::ostream& out) {
+	PA3_STATS_TIMER(timer, command_stats_ns);
+
+	std::istringstream words(argument);
+	std::string name;
+	std::string by;
+	std::string group;
+	std::string extra;
+
+	words >> name >> by >> group >> extra;
+
+	NumericColumns::Column column = NumericColumns::find(name);
+
+	if (column == NumericColumns::columnCount) {
+		out << "Invalid column \"" << name << "\"\n";
+		return;
+	}
+
+	GroupBy groupBy = GroupBy::all;
+
+	if (by.empty()) {
+		groupBy = GroupBy::all;
+	} else if (by == "by" && group == "category" && extra.empty()) {
+		groupBy = GroupBy::category;
+	} else if (by == "by" && group == "brand" && extra.empty()) {
+		groupBy = GroupBy::brand;
+	} else {
+		out << "Invalid grouping, expected \"by category\" or \"by brand\"\n";
+		return;
+	}
+
+	for (const GroupStats& stats : aggregate(inventory, column, groupBy)) {
+		const ColumnStats& s = stats.second;
+		out << stats.first << ": count " << s.count;
+
+		if (s.count > 0) {
+			out << ", sum " << s.sum << ", min " << s.min << ", max " << s.max << ", avg " << s.mean();
+		}
+
+		out << '\n';
+	}
+}
+
+std::string commandArgument(const std::string& line, const std::string& command) {
+	if (line.size() <= command.size()) {
+		return "";
+	}
+
+	std::string argument = line.substr(command.size());
+
+	argument.erase(0, argument.find_first_not_of(CSV::Parsing::whitespace));
+	argument.erase(argument.find_last_not_of(CSV::Parsing::whitespace) + 1);
+
+	return argument;
+}
+
+} // namespace inventory
@@ -0,0 +1,171 @@
+#include "inventory/Filter.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace inventory {
+
+namespace {
+
+/**
+ * @brief Splits a filter into words, numbers and comparison operators
+ */
+std::vector<std::string> filterTokens(const std::string& text) {
+	std::vector<std::string> tokens;
+	size_t i = 0;
+
+	while (i < text.size()) {
+		unsigned char c = static_cast<unsigned char>(text[i]);
+		size_t begin = i;
+
+		if (std::isspace(c)) {
+			++i;
+			continue;
+		}
+
+		if (std::isalpha(c) || c == '_') {
+			while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) {
+				++i;
+			}
+		} else if (std::isdigit(c) || c == '.' || c == '-' || c == '+') {
+			while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '.'
+			                           || ((text[i] == '-' || text[i] == '+') && (i == begin || text[i - 1] == 'e' || text[i - 1] == 'E')))) {
+				++i;
+			}
+		} else if (c == '<' || c == '>' || c == '=' || c == '!') {
+			++i;
+
+			if (i < text.size() && text[i] == '=') {
+				++i;
+			}
+		} else {
+			throw std::invalid_argument("Unexpected character '" + text.substr(i, 1) + "'");
+		}
+
+		tokens.push_back(text.substr(begin, i - begin));
+	}
+
+	return tokens;
+}
+
+bool isKeyword(const std::string& token, const char* keyword) {
+	std::string lower;
+
+	for (char c : token) {
+		lower += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+
+	return lower == keyword;
+}
+
+CompareOp parseOp(const std::string& token) {
+	if (token == "<") {
+		return CompareOp::less;
+	} else if (token == "<=") {
+		return CompareOp::lessEqual;
+	} else if (token == ">") {
+		return CompareOp::greater;
+	} else if (token == ">=") {
+		return CompareOp::greaterEqual;
+	} else if (token == "=" || token == "==") {
+		return CompareOp::equal;
+	} else if (token == "!=") {
+		return CompareOp::notEqual;
+	}
+
+	throw std::invalid_argument("Expected a comparison instead of \"" + token + "\"");
+}
+
+} // namespace
+
+const size_t Filter::blockRows;
+
+Filter::Filter(const std::string& text) {
+	std::vector<std::string> tokens = filterTokens(text);
+
+	if (tokens.empty()) {
+		throw std::invalid_argument("Empty filter");
+	}
+
+	alternatives_.emplace_back();
+
+	// Conditions of three tokens, separated by "and" or "or"
+	for (size_t i = 0; i < tokens.size(); i += 4) {
+		if (i + 3 > tokens.size()) {
+			throw std::invalid_argument("Incomplete condition at \"" + tokens[i] + "\"");
+		}
+
+		Condition condition;
+		condition.column = NumericColumns::find(tokens[i]);
+
+		if (condition.column == NumericColumns::columnCount) {
+			throw std::invalid_argument("Unknown column \"" + tokens[i] + "\"");
+		}
+
+		condition.op = parseOp(tokens[i + 1]);
+
+		const std::string& number = tokens[i + 2];
+		char* end = nullptr;
+		condition.operand = std::strtod(number.c_str(), &end);
+
+		if (number.empty() || *end != '\0') {
+			throw std::invalid_argument("Expected a number instead of \"" + number + "\"");
+		}
+
+		alternatives_.back().push_back(condition);
+
+		if (i + 3 == tokens.size()) {
+			break;
+		}
+
+		if (isKeyword(tokens[i + 3], "or")) {
+			alternatives_.emplace_back();
+		} else if (!isKeyword(tokens[i + 3], "and")) {
+			throw std::invalid_argument("Expected \"and\" or \"or\" instead of \"" + tokens[i + 3] + "\"");
+		}
+
+		if (i + 4 == tokens.size()) {
+			throw std::invalid_argument("Filter ends with \"" + tokens[i + 3] + "\"");
+		}
+	}
+}
+
+std::vector<uint64_t> Filter::select(const NumericColumns& columns) const {
+	return select(columns, bestScanIsa());
+}
+
+std::vector<uint64_t> Filter::select(const NumericColumns& columns, ScanIsa isa) const {
+	size_t rows = columns.rows();
+	std::vector<uint64_t> selection(selectionWords(rows), 0);
+
+	std::vector<uint64_t> matched(selectionWords(blockRows));
+	std::vector<uint64_t> condition(selectionWords(blockRows));
+
+	for (size_t begin = 0; begin < rows; begin += blockRows) {
+		size_t count = std::min(blockRows, rows - begin);
+		size_t words = selectionWords(count);
+		uint64_t* out = selection.data() + begin / 64;
+
+		for (const std::vector<Condition>& conditions : alternatives_) {
+			for (size_t i = 0; i < conditions.size(); ++i) {
+				const Condition& c = conditions[i];
+				const double* values = columns.column(c.column).data() + begin;
+
+				if (i == 0) {
+					compareScan(isa, values, count, c.op, c.operand, matched.data());
+				} else {
+					compareScan(isa, values, count, c.op, c.operand, condition.data());
+					selectionAnd(matched.data(), condition.data(), words);
+				}
+			}
+
+			selectionOr(out, matched.data(), words);
+		}
+	}
+
+	return selection;
+}
+
+} // namespace inventory
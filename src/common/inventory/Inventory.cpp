@@ -0,0 +1,582 @@
+#include "inventory/Inventory.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+
+#include "CSV/Parsing.hpp"
+#include "stats.hpp"
+#include "thread_pool.hpp"
+
+namespace inventory {
+
+namespace {
+
+const size_t noColumn = std::numeric_limits<size_t>::max();
+
+std::string toLower(std::string str) {
+	std::transform(str.begin(), str.end(), str.begin(),
+	               [](unsigned char c) { return std::tolower(c); });
+	return str;
+}
+
+std::string trim(const std::string& str) {
+	std::string::size_type begin = str.find_first_not_of(CSV::Parsing::whitespace);
+
+	if (begin == std::string::npos) {
+		return "";
+	}
+
+	std::string::size_type end = str.find_last_not_of(CSV::Parsing::whitespace);
+	return str.substr(begin, end - begin + 1);
+}
+
+// Fewer products than this per thread cost more to start than they save
+const size_t minProductsPerChunk = 4096;
+
+double millisecondsSince(std::chrono::steady_clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Runs a stage of building and times it
+ */
+template <typename FN_T>
+void timeStage(LoadStage& stage, FN_T fn) {
+	auto start = std::chrono::steady_clock::now();
+	fn();
+	stage.milliseconds = millisecondsSince(start);
+}
+
+/**
+ * @brief Finds the position of a column by its case-insensitive header name
+ */
+size_t findColumn(const CSV::CSVRow& header, const std::string& name) {
+	std::string lname = toLower(name);
+	size_t idx = 0;
+
+	for (const std::string& column : header) {
+		if (toLower(trim(column)) == lname) {
+			return idx;
+		}
+
+		++idx;
+	}
+
+	return noColumn;
+}
+
+} // namespace
+
+ProductColumns::ProductColumns(const CSV::CSVRow& header) :
+	id_(findColumn(header, "Uniq Id")),
+	name_(findColumn(header, "Product Name")),
+	brand_(findColumn(header, "Brand Name")),
+	asin_(findColumn(header, "Asin")),
+	category_(findColumn(header, "Category")),
+	price_(findColumn(header, "Selling Price")),
+	listPrice_(findColumn(header, "List Price")),
+	rating_(findColumn(header, "Rating")),
+	quantity_(findColumn(header, "Quantity")),
+	stock_(findColumn(header, "Stock")),
+	about_(findColumn(header, "About Product")),
+	description_(findColumn(header, "Product Description")) {
+
+	if (id_ == noColumn) {
+		throw std::invalid_argument("Inventory CSV has no \"Uniq Id\" column");
+	}
+}
+
+void ProductColumns::set(Product& product, std::string& text, size_t col, const CSV::CSVValue& cell) const {
+	double* number = this->number(product, col);
+
+	// Readers given column types parse numbers already
+	if (number != nullptr && cell.type() == CSV::CSVValueType::CSVDouble) {
+		*number = cell.get<double>();
+	} else if (number != nullptr && cell.type() == CSV::CSVValueType::CSVInt) {
+		*number = cell.get<int>();
+	} else if (cell.type() == CSV::CSVValueType::CSVString) {
+		set(product, text, col, cell.get<std::string>());
+	}
+}
+
+void ProductColumns::set(Product& product, std::string& text, size_t col, const std::string& cell) const {
+	double* number = this->number(product, col);
+
+	if (number != nullptr) {
+		// Reads plain numbers as well as prices
+		*number = parsePrice(cell);
+	} else if (col == id_) {
+		product.id = cell;
+	} else if (col == name_) {
+		product.name = cell;
+	} else if (col == brand_) {
+		product.brand = cell;
+	} else if (col == asin_) {
+		product.asin = cell;
+	} else if (col == category_) {
+		product.category = cell;
+	} else if (col == about_ || col == description_) {
+		text += cell;
+		text += ' ';
+	}
+}
+
+double* ProductColumns::number(Product& product, size_t col) const {
+	return (col == price_) ? &product.price
+	       : (col == listPrice_) ? &product.listPrice
+	       : (col == rating_) ? &product.rating
+	       : (col == quantity_) ? &product.quantity
+	       : (col == stock_) ? &product.stock
+	       : nullptr;
+}
+
+void Inventory::load(const CSV::CSVData& csv) {
+	ProductColumns columns(csv.header());
+
+	std::vector<Product> products;
+	std::vector<std::string> texts;
+	products.reserve(csv.rows().size());
+	texts.reserve(csv.rows().size());
+
+	for (const CSV::CSVTuple& row : csv.rows()) {
+		Product product;
+		product.price = std::numeric_limits<double>::quiet_NaN();
+
+		std::string text;
+		size_t col = 0;
+
+		// Walking the row once, indexing the List is O(n) per access
+		for (const CSV::CSVValue& value : row) {
+			columns.set(product, text, col++, value);
+		}
+
+		products.push_back(std::move(product));
+		texts.push_back(std::move(text));
+	}
+
+	build(std::move(products), std::move(texts), 0);
+}
+
+std::vector<LoadStage> Inventory::loadFile(const std::string& filename, size_t threads) {
+	auto start = std::chrono::steady_clock::now();
+	std::string csv = readFile(filename);
+
+	std::vector<LoadStage> stages;
+	stages.push_back({ "read", millisecondsSince(start), false });
+
+	std::vector<Product> products;
+	std::vector<std::string> texts;
+
+	{
+		PA3_STATS_TIMER(timer, load_parse_ns);
+
+		start = std::chrono::steady_clock::now();
+		parseProducts(csv, products, texts, threads);
+		stages.push_back({ "parse", millisecondsSince(start), false });
+	}
+
+	std::string().swap(csv);
+
+	std::vector<LoadStage> built = build(std::move(products), std::move(texts), threads);
+	stages.insert(stages.end(), built.begin(), built.end());
+
+	return stages;
+}
+
+std::vector<LoadStage> Inventory::build(std::vector<Product> products, std::vector<std::string> texts, size_t threads) {
+	PA3_STATS_TIMER(timer, load_index_ns);
+
+	clear();
+
+	thread_pool& pool = thread_pool::shared();
+
+	if (threads == 0) {
+		threads = pool.concurrency();
+	}
+
+	std::vector<LoadStage> stages;
+
+	// Dropping duplicates first fixes every product's position, the indexes
+	// can then be built independently. The id index keeps the first of each
+	// id, mapped to its file position until the products are compacted.
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<uint8_t> firsts = idIndex_.insert_bulk(pool, products.size(), [&products](size_t i) -> const std::string& {
+		return products[i].id;
+	}, [](size_t i) {
+		return i;
+	});
+
+	idIndex_.erase(std::string());
+
+	std::vector<size_t> positions(products.size());
+	size_t kept = 0;
+
+	for (size_t i = 0; i < products.size(); ++i) {
+		if (!firsts[i] || products[i].id.empty()) {
+			continue;
+		}
+
+		positions[i] = kept;
+
+		if (kept != i) {
+			products[kept] = std::move(products[i]);
+			texts[kept] = std::move(texts[i]);
+		}
+
+		++kept;
+	}
+
+	if (kept != products.size()) {
+		pool.parallel_for(0, idIndex_.shard_count(), idIndex_.shard_count(), [&](size_t shard, size_t, size_t) {
+			for (auto& pair : idIndex_.shard(shard)) {
+				pair.second = positions[pair.second];
+			}
+		});
+	}
+
+	products.resize(kept);
+	texts.resize(kept);
+	products_ = std::move(products);
+
+	stages.push_back({ "dedupe", millisecondsSince(start), false });
+
+	// Each builder writes its own index. The categories builder also sets
+	// each product's categories, which no other builder reads.
+	std::vector<LoadStage> builders = {
+		{ "ids", 0.0, true },
+		{ "categories", 0.0, true },
+		{ "columns", 0.0, true },
+		{ "names", 0.0, true },
+		{ "text", 0.0, true },
+	};
+
+	task_group group(pool);
+
+	// Usually the slowest, queued first. wait runs queued builders on this
+	// thread too, and a failure in any of them clears the inventory.
+	group.run([&] {
+		timeStage(builders[4], [&] {
+			textIndex_.build(texts, threads);
+		});
+	});
+
+	group.run([&] {
+		timeStage(builders[0], [this] {
+			freeze();
+			setIdFilterRate(idFilterRate_);
+		});
+	});
+
+	group.run([&] {
+		timeStage(builders[1], [this, threads] {
+			buildCategories(threads);
+		});
+	});
+
+	group.run([&] {
+		timeStage(builders[2], [this] {
+			columns_.reserve(products_.size());
+
+			for (const Product& product : products_) {
+				columns_.append(product);
+			}
+
+			columns_.buildSortOrders();
+		});
+	});
+
+	group.run([&] {
+		timeStage(builders[3], [this, threads] {
+			nameIndex_.build(products_, threads);
+		});
+	});
+
+	try {
+		group.wait();
+	} catch (...) {
+		clear();
+		throw;
+	}
+
+	stages.insert(stages.end(), builders.begin(), builders.end());
+	return stages;
+}
+
+void Inventory::buildCategories(size_t threads) {
+	// Categories numbered within a chunk, in order of appearance
+	struct Chunk {
+		size_t begin;
+		size_t end;
+		dsa::unordered_map<std::string, size_t, dsa::wyhash> ids;
+		std::vector<std::string> names;
+		std::vector<std::vector<size_t>> members;
+	};
+
+	thread_pool& pool = thread_pool::shared();
+	size_t chunkCount = std::max<size_t>(1, std::min(threads, products_.size() / minProductsPerChunk));
+	std::vector<Chunk> chunks(pool.chunk_count(0, products_.size(), chunkCount));
+
+	pool.parallel_for(0, products_.size(), chunks.size(), [&](size_t c, size_t begin, size_t end) {
+		Chunk& chunk = chunks[c];
+		chunk.begin = begin;
+		chunk.end = end;
+
+		for (size_t pos = chunk.begin; pos < chunk.end; ++pos) {
+			Product& product = products_[pos];
+			product.categories.clear();
+
+			for (const std::string& name : splitCategories(product.category)) {
+				auto it = chunk.ids.find(name);
+				size_t category = (it == chunk.ids.end()) ? chunk.names.size() : it->second;
+
+				if (category == chunk.names.size()) {
+					chunk.ids.insert({ name, category });
+					chunk.names.push_back(name);
+					chunk.members.emplace_back();
+				}
+
+				// Categories may repeat within a single product's string
+				if (std::find(product.categories.begin(), product.categories.end(), category) == product.categories.end()) {
+					product.categories.push_back(category);
+					chunk.members[category].push_back(pos);
+				}
+			}
+		}
+	});
+
+	// Merged in chunk order, so ids and member lists come out as if the
+	// products were added one by one
+	for (const Chunk& chunk : chunks) {
+		std::vector<size_t> ids;
+		ids.reserve(chunk.names.size());
+
+		for (size_t local = 0; local < chunk.names.size(); ++local) {
+			size_t category = categoryId(chunk.names[local]);
+			std::vector<size_t>& members = categoryMembers_[category];
+
+			members.insert(members.end(), chunk.members[local].begin(), chunk.members[local].end());
+			ids.push_back(category);
+		}
+
+		for (size_t pos = chunk.begin; pos < chunk.end; ++pos) {
+			for (size_t& category : products_[pos].categories) {
+				category = ids[category];
+			}
+		}
+	}
+}
+
+bool Inventory::add(Product product) {
+	if (frozen()) {
+		thaw();
+	}
+
+	if (idIndex_.contains(product.id)) {
+		return false;
+	}
+
+	size_t pos = products_.size();
+
+	product.categories.clear();
+
+	for (const std::string& name : splitCategories(product.category)) {
+		size_t category = categoryId(name);
+
+		// Categories may repeat within a single product's string
+		if (std::find(product.categories.begin(), product.categories.end(), category) == product.categories.end()) {
+			product.categories.push_back(category);
+			categoryMembers_[category].push_back(pos);
+		}
+	}
+
+	idIndex_.insert({ product.id, pos });
+	columns_.append(product);
+
+	if (idFilterRate_ > 0.0) {
+		idFilter_.insert(product.id);
+	}
+
+	products_.push_back(std::move(product));
+
+	return true;
+}
+
+const Product* Inventory::find(const std::string& id) const {
+	bool filtered = idFilterRate_ > 0.0;
+
+	if (filtered && !idFilter_.contains(id)) {
+		return nullptr;
+	}
+
+	const size_t* pos = nullptr;
+
+	if (frozen()) {
+		auto it = frozenIds_.find(id);
+		pos = (it == frozenIds_.end()) ? nullptr : &it->second;
+	} else {
+		auto it = idIndex_.find(id);
+		pos = (it == idIndex_.end()) ? nullptr : &it->second;
+	}
+
+	if (pos == nullptr) {
+		if (filtered) {
+			PA3_STATS_INCREMENT(filter_false_positive);
+		}
+
+		return nullptr;
+	}
+
+	return &products_[*pos];
+}
+
+void Inventory::freeze() {
+	// Ids are unique, so this only fails when two of them share a full key
+	// hash, which no perfect hash can tell apart. Lookups stay on the
+	// mutable index then.
+	try {
+		frozenIds_.build(idIndex_.begin(), idIndex_.end());
+	} catch (const std::invalid_argument&) {
+		frozenIds_.clear();
+		return;
+	} catch (const std::runtime_error&) {
+		frozenIds_.clear();
+		return;
+	}
+
+	// Release the table rather than keep it allocated but empty
+	dsa::sharded_map<std::string, size_t, dsa::wyhash>().swap(idIndex_);
+}
+
+void Inventory::setIdFilterRate(double rate) {
+	idFilterRate_ = rate;
+	resetIdFilter(products_.size());
+
+	if (idFilterRate_ > 0.0) {
+		for (const Product& product : products_) {
+			idFilter_.insert(product.id);
+		}
+	}
+}
+
+void Inventory::resetIdFilter(size_t capacity) {
+	// A disabled filter is never consulted, keep it as small as possible
+	if (idFilterRate_ > 0.0) {
+		idFilter_.reset(capacity, idFilterRate_);
+	} else {
+		idFilter_.reset(0, 0.5);
+	}
+}
+
+void Inventory::thaw() {
+	idIndex_.reserve(frozenIds_.size());
+
+	for (const auto& pair : frozenIds_) {
+		idIndex_.insert({ pair.first, pair.second });
+	}
+
+	frozenIds_.clear();
+}
+
+const std::vector<size_t>* Inventory::category(const std::string& name) const {
+	auto it = categoryIndex_.find(name);
+
+	if (it == categoryIndex_.end()) {
+		return nullptr;
+	}
+
+	return &categoryMembers_[it->second];
+}
+
+size_t Inventory::findCategory(const std::string& name) const {
+	auto it = categoryIndex_.find(name);
+	return (it == categoryIndex_.end()) ? noCategory : it->second;
+}
+
+void Inventory::clear() {
+	products_.clear();
+	columns_.clear();
+	idIndex_.clear();
+	frozenIds_.clear();
+	idFilter_.clear();
+	categoryIndex_.clear();
+	categoryNames_.clear();
+	categoryMembers_.clear();
+	nameIndex_.clear();
+	textIndex_.clear();
+}
+
+size_t Inventory::categoryId(const std::string& name) {
+	auto it = categoryIndex_.find(name);
+
+	if (it != categoryIndex_.end()) {
+		return it->second;
+	}
+
+	size_t id = categoryNames_.size();
+
+	categoryIndex_.insert({ name, id });
+	categoryNames_.push_back(name);
+	categoryMembers_.emplace_back();
+
+	return id;
+}
+
+std::vector<std::string> splitCategories(const std::string& category) {
+	std::vector<std::string> categories;
+	std::string::size_type begin = 0;
+
+	while (begin <= category.size()) {
+		std::string::size_type end = category.find('|', begin);
+
+		if (end == std::string::npos) {
+			end = category.size();
+		}
+
+		std::string name = trim(category.substr(begin, end - begin));
+
+		if (!name.empty()) {
+			categories.push_back(name);
+		}
+
+		begin = end + 1;
+	}
+
+	return categories;
+}
+
+double parsePrice(const std::string& price) {
+	std::string::size_type begin = price.find_first_of("0123456789.");
+
+	if (begin == std::string::npos) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	// Prices may contain thousands separators, e.g. "$1,299.99"
+	std::string digits;
+
+	for (std::string::size_type i = begin; i < price.size(); ++i) {
+		char c = price[i];
+
+		if (std::isdigit(static_cast<unsigned char>(c)) || c == '.') {
+			digits += c;
+		} else if (c != ',') {
+			break;
+		}
+	}
+
+	char* end = nullptr;
+	double value = std::strtod(digits.c_str(), &end);
+
+	if (end == digits.c_str()) {
+		return std::numeric_limits<double>::quiet_NaN();
+	}
+
+	return value;
+}
+
+} // namespace inventory
@@ -0,0 +1,526 @@
+#include "inventory/NameIndex.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+#include "dsa/hash.hpp"
+#include "dsa/unordered_map.hpp"
+#include "inventory/Inventory.hpp"
+#include "inventory/Tokenizer.hpp"
+#include "thread_pool.hpp"
+
+namespace inventory {
+
+namespace {
+
+bool startsWith(const std::string& str, const std::string& prefix) {
+	return str.compare(0, prefix.size(), prefix) == 0;
+}
+
+/**
+ * @brief Checks that every query word starts some word of the name
+ */
+bool matchesAll(const std::vector<std::string>& nameWords, const std::vector<std::string>& query) {
+	for (const std::string& word : query) {
+		bool found = false;
+
+		for (const std::string& candidate : nameWords) {
+			if (startsWith(candidate, word)) {
+				found = true;
+				break;
+			}
+		}
+
+		if (!found) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * @brief Gets the fewest edits turning a query word into one of the name's
+ * words, exact prefixes costing nothing
+ *
+ * Like corrections, a misspelled word is compared with whole words, so
+ * it must be complete to match with edits.
+ *
+ * @returns The edits, or maxEdits + 1 if no word is close enough
+ */
+size_t wordDistance(const std::vector<std::string>& nameWords, const std::string& word, size_t maxEdits) {
+	size_t best = maxEdits + 1;
+
+	for (const std::string& candidate : nameWords) {
+		if (startsWith(candidate, word)) {
+			return 0;
+		}
+
+		if (maxEdits > 0) {
+			best = std::min(best, editDistance(word, candidate, std::min(best, maxEdits + 1) - 1));
+		}
+	}
+
+	return best;
+}
+
+/**
+ * @brief Gets the distinct words of a name, sorted
+ */
+std::vector<std::string> distinctWords(const std::string& name) {
+	std::vector<std::string> words = nameWords(name);
+
+	std::sort(words.begin(), words.end());
+	words.erase(std::unique(words.begin(), words.end()), words.end());
+
+	return words;
+}
+
+/**
+ * @brief Counts a key, to size its posting list
+ */
+template <typename KEY_T, typename HASH_F>
+void countKey(dsa::unordered_map<KEY_T, uint32_t, HASH_F>& counts, const KEY_T& key, uint32_t count = 1) {
+	auto it = counts.find(key);
+
+	if (it == counts.end()) {
+		counts.insert({ key, count });
+	} else {
+		it->second += count;
+	}
+}
+
+/**
+ * @brief Turns per-key counts into offsets of sorted keys
+ *
+ * Afterwards each count holds the offset its postings start at, to be
+ * advanced as they are filled in.
+ */
+template <typename KEY_T, typename HASH_F>
+void layoutPostings(dsa::unordered_map<KEY_T, uint32_t, HASH_F>& counts, std::vector<KEY_T>& keys,
+                    std::vector<uint32_t>& offsets, std::vector<uint32_t>& postings) {
+	keys.clear();
+	keys.reserve(counts.size());
+
+	for (const auto& pair : counts) {
+		keys.push_back(pair.first);
+	}
+
+	std::sort(keys.begin(), keys.end());
+
+	offsets.assign(1, 0);
+	offsets.reserve(keys.size() + 1);
+
+	for (const KEY_T& key : keys) {
+		uint32_t& count = counts[key];
+		uint32_t begin = offsets.back();
+
+		offsets.push_back(begin + count);
+		count = begin;
+	}
+
+	postings.resize(offsets.back());
+}
+
+// Fewer products than this per thread cost more to start than they save
+const size_t minProductsPerChunk = 4096;
+
+/**
+ * @brief Positions of the products using each word, within one chunk
+ */
+using ChunkPostings = dsa::unordered_map<std::string, std::vector<uint32_t>, dsa::wyhash>;
+
+void indexChunk(const std::vector<Product>& products, size_t begin, size_t end, ChunkPostings& postings) {
+	for (size_t pos = begin; pos < end; ++pos) {
+		for (const std::string& word : distinctWords(products[pos].name)) {
+			auto it = postings.find(word);
+
+			if (it == postings.end()) {
+				postings.insert({ word, std::vector<uint32_t>(1, pos) });
+			} else {
+				it->second.push_back(pos);
+			}
+		}
+	}
+}
+
+} // namespace
+
+std::vector<std::string> nameWords(const std::string& name) {
+	std::vector<std::string> words;
+	forEachWord(name, [&](const std::string& word) { words.push_back(word); });
+	return words;
+}
+
+std::vector<uint32_t> wordTrigrams(const std::string& word) {
+	std::string text = " " + word + " ";
+	std::vector<uint32_t> trigrams;
+
+	for (size_t i = 0; i + 3 <= text.size(); ++i) {
+		trigrams.push_back((static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16) |
+		                   (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8) |
+		                   static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2])));
+	}
+
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+	return trigrams;
+}
+
+size_t allowedEdits(size_t length) {
+	if (length < 3) {
+		return 0;
+	}
+
+	return (length < 8) ? 1 : 2;
+}
+
+size_t editDistance(const std::string& a, const std::string& b, size_t bound) {
+	size_t longer = std::max(a.size(), b.size());
+	size_t shorter = std::min(a.size(), b.size());
+
+	if (longer - shorter > bound) {
+		return bound + 1;
+	}
+
+	// Rows i - 2, i - 1 and i of the distance table
+	std::vector<size_t> before(b.size() + 1);
+	std::vector<size_t> previous(b.size() + 1);
+	std::vector<size_t> current(b.size() + 1);
+
+	for (size_t j = 0; j <= b.size(); ++j) {
+		previous[j] = j;
+	}
+
+	for (size_t i = 1; i <= a.size(); ++i) {
+		current[0] = i;
+		size_t rowMin = current[0];
+
+		for (size_t j = 1; j <= b.size(); ++j) {
+			size_t cost = (a[i - 1] == b[j - 1]) ? 0 : 1;
+			current[j] = std::min(std::min(previous[j] + 1, current[j - 1] + 1), previous[j - 1] + cost);
+
+			if (i > 1 && j > 1 && a[i - 1] == b[j - 2] && a[i - 2] == b[j - 1]) {
+				current[j] = std::min(current[j], before[j - 2] + 1);
+			}
+
+			rowMin = std::min(rowMin, current[j]);
+		}
+
+		// Distances never decrease from one row to the next
+		if (rowMin > bound) {
+			return bound + 1;
+		}
+
+		std::swap(before, previous);
+		std::swap(previous, current);
+	}
+
+	return std::min(previous[b.size()], bound + 1);
+}
+
+void NameIndex::build(const std::vector<Product>& products, size_t threads) {
+	clear();
+
+	if (products.size() > UINT32_MAX) {
+		throw std::length_error("Too many products for the name index");
+	}
+
+	thread_pool& pool = thread_pool::shared();
+
+	if (threads == 0) {
+		threads = pool.concurrency();
+	}
+
+	size_t chunkCount = std::max<size_t>(1, std::min(threads, products.size() / minProductsPerChunk));
+	std::vector<ChunkPostings> chunks(pool.chunk_count(0, products.size(), chunkCount));
+
+	pool.parallel_for(0, products.size(), chunks.size(), [&](size_t c, size_t begin, size_t end) {
+		indexChunk(products, begin, end, chunks[c]);
+	});
+
+	// Count first, so every posting list is allocated exactly once
+	dsa::unordered_map<std::string, uint32_t, dsa::wyhash> wordCounts;
+
+	for (const ChunkPostings& chunk : chunks) {
+		for (const auto& pair : chunk) {
+			countKey(wordCounts, pair.first, static_cast<uint32_t>(pair.second.size()));
+		}
+	}
+
+	layoutPostings(wordCounts, words_, wordOffsets_, wordPostings_);
+
+	// Chunks are contiguous, so concatenating their lists in chunk order
+	// keeps every list sorted
+	for (const ChunkPostings& chunk : chunks) {
+		for (const auto& pair : chunk) {
+			uint32_t& offset = wordCounts[pair.first];
+
+			std::copy(pair.second.begin(), pair.second.end(), wordPostings_.begin() + offset);
+			offset += pair.second.size();
+		}
+	}
+
+	dsa::unordered_map<uint32_t, uint32_t> trigramCounts;
+
+	for (const std::string& word : words_) {
+		for (uint32_t trigram : wordTrigrams(word)) {
+			countKey(trigramCounts, trigram);
+		}
+	}
+
+	layoutPostings(trigramCounts, trigrams_, trigramOffsets_, trigramWords_);
+
+	for (size_t w = 0; w < words_.size(); ++w) {
+		for (uint32_t trigram : wordTrigrams(words_[w])) {
+			trigramWords_[trigramCounts[trigram]++] = w;
+		}
+	}
+
+	indexed_ = products.size();
+}
+
+std::vector<size_t> NameIndex::search(const std::vector<Product>& products, const std::string& text, size_t limit) const {
+	std::vector<size_t> results;
+	std::vector<std::string> query = nameWords(text);
+
+	if (query.empty() || limit == 0) {
+		return results;
+	}
+
+	prefixMatches(products, query, limit, results);
+
+	if (results.size() < limit) {
+		fuzzyMatches(products, query, limit, results);
+	}
+
+	return results;
+}
+
+NameIndex::WordRange NameIndex::prefixRange(const std::string& prefix) const {
+	auto lower = std::lower_bound(words_.begin(), words_.end(), prefix);
+	auto upper = std::partition_point(lower, words_.end(), [&](const std::string& word) {
+		return startsWith(word, prefix);
+	});
+
+	return WordRange(lower - words_.begin(), upper - words_.begin());
+}
+
+void NameIndex::prefixMatches(const std::vector<Product>& products, const std::vector<std::string>& query,
+                              size_t limit, std::vector<size_t>& results) const {
+	// Walk the words starting with the rarest query word, checking the
+	// others against each candidate's name
+	WordRange rarest(0, 0);
+	size_t fewest = SIZE_MAX;
+
+	for (const std::string& word : query) {
+		WordRange range = prefixRange(word);
+		size_t postings = (range.first == range.second) ? 0 : wordOffsets_[range.second] - wordOffsets_[range.first];
+
+		if (postings < fewest) {
+			fewest = postings;
+			rarest = range;
+		}
+	}
+
+	// An exact word sorts before the longer words it starts
+	for (size_t w = rarest.first; w < rarest.second && results.size() < limit; ++w) {
+		for (uint32_t i = wordOffsets_[w]; i < wordOffsets_[w + 1] && results.size() < limit; ++i) {
+			size_t pos = wordPostings_[i];
+
+			if (std::find(results.begin(), results.end(), pos) != results.end()) {
+				continue;
+			}
+
+			if (query.size() == 1 || matchesAll(nameWords(products[pos].name), query)) {
+				results.push_back(pos);
+			}
+		}
+	}
+
+	for (size_t pos = indexed_; pos < products.size() && results.size() < limit; ++pos) {
+		if (matchesAll(nameWords(products[pos].name), query)) {
+			results.push_back(pos);
+		}
+	}
+}
+
+std::vector<NameIndex::Correction> NameIndex::corrections(const std::string& word, size_t maxEdits) const {
+	std::vector<uint32_t> query = wordTrigrams(word);
+	std::vector<uint32_t> candidates;
+
+	// An edit changes at most four trigrams of the padded word, so a word
+	// within maxEdits shares all but 4 * maxEdits of them. Such a word is
+	// in at least one of the shortest size - required + 1 trigram lists.
+	size_t required = (query.size() > 4 * maxEdits) ? query.size() - 4 * maxEdits : 0;
+
+	std::vector<std::pair<const uint32_t*, const uint32_t*>> lists;
+
+	for (uint32_t trigram : query) {
+		auto it = std::lower_bound(trigrams_.begin(), trigrams_.end(), trigram);
+
+		if (it != trigrams_.end() && *it == trigram) {
+			size_t idx = it - trigrams_.begin();
+			lists.emplace_back(trigramWords_.data() + trigramOffsets_[idx], trigramWords_.data() + trigramOffsets_[idx + 1]);
+		}
+	}
+
+	if (required == 0) {
+		// Too short for the trigrams to rule anything out, also try every
+		// word with the same first letter
+		for (const auto& list : lists) {
+			candidates.insert(candidates.end(), list.first, list.second);
+		}
+
+		WordRange range = prefixRange(word.substr(0, 1));
+
+		for (size_t w = range.first; w < range.second; ++w) {
+			candidates.push_back(w);
+		}
+	} else if (lists.size() >= required) {
+		std::sort(lists.begin(), lists.end(), [](const std::pair<const uint32_t*, const uint32_t*>& a,
+		                                         const std::pair<const uint32_t*, const uint32_t*>& b) {
+			return a.second - a.first < b.second - b.first;
+		});
+
+		for (size_t l = 0; l + required <= query.size() && l < lists.size(); ++l) {
+			candidates.insert(candidates.end(), lists[l].first, lists[l].second);
+		}
+	}
+
+	std::sort(candidates.begin(), candidates.end());
+	candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+	std::vector<Correction> found;
+
+	for (uint32_t w : candidates) {
+		size_t distance = editDistance(word, words_[w], maxEdits);
+
+		if (distance <= maxEdits) {
+			found.emplace_back(w, distance);
+		}
+	}
+
+	return found;
+}
+
+void NameIndex::fuzzyMatches(const std::vector<Product>& products, const std::vector<std::string>& query,
+                             size_t limit, std::vector<size_t>& results) const {
+	// Corrections of the query word with the fewest products to check
+	std::vector<Correction> rarest;
+	size_t rarestWord = 0;
+	size_t fewest = SIZE_MAX;
+
+	for (size_t q = 0; q < query.size(); ++q) {
+		std::vector<Correction> words;
+		WordRange range = prefixRange(query[q]);
+
+		for (size_t w = range.first; w < range.second; ++w) {
+			words.emplace_back(w, 0);
+		}
+
+		size_t maxEdits = allowedEdits(query[q].size());
+
+		if (maxEdits > 0) {
+			std::vector<Correction> corrected = corrections(query[q], maxEdits);
+			words.insert(words.end(), corrected.begin(), corrected.end());
+		}
+
+		size_t postings = 0;
+
+		for (const Correction& correction : words) {
+			postings += postingCount(correction.first);
+		}
+
+		if (postings < fewest) {
+			fewest = postings;
+			rarest.swap(words);
+			rarestWord = q;
+		}
+	}
+
+	// A single word needs no checking, take its corrections fewest edits
+	// first and stop once there are enough
+	if (query.size() == 1) {
+		std::stable_sort(rarest.begin(), rarest.end(), [](const Correction& a, const Correction& b) {
+			return a.second < b.second;
+		});
+
+		for (size_t c = 0; c < rarest.size() && results.size() < limit; ++c) {
+			for (uint32_t i = wordOffsets_[rarest[c].first]; i < wordOffsets_[rarest[c].first + 1] && results.size() < limit; ++i) {
+				if (std::find(results.begin(), results.end(), wordPostings_[i]) == results.end()) {
+					results.push_back(wordPostings_[i]);
+				}
+			}
+		}
+
+		if (results.size() == limit || indexed_ == products.size()) {
+			return;
+		}
+	}
+
+	// Candidate positions with the edits made to the rarest word
+	std::vector<std::pair<size_t, size_t>> candidates;
+
+	for (const Correction& correction : rarest) {
+		for (uint32_t i = wordOffsets_[correction.first]; i < wordOffsets_[correction.first + 1]; ++i) {
+			candidates.emplace_back(wordPostings_[i], correction.second);
+		}
+	}
+
+	for (size_t pos = indexed_; pos < products.size(); ++pos) {
+		candidates.emplace_back(pos, SIZE_MAX);
+	}
+
+	// By position, then fewest edits, keeping each position's first entry
+	std::sort(candidates.begin(), candidates.end());
+
+	// Total edits and position
+	std::vector<std::pair<size_t, size_t>> scored;
+
+	for (size_t i = 0; i < candidates.size(); ++i) {
+		size_t pos = candidates[i].first;
+
+		if ((i > 0 && candidates[i - 1].first == pos) || std::find(results.begin(), results.end(), pos) != results.end()) {
+			continue;
+		}
+
+		std::vector<std::string> words = nameWords(products[pos].name);
+		size_t edits = 0;
+		bool matched = true;
+
+		for (size_t q = 0; q < query.size() && matched; ++q) {
+			size_t maxEdits = allowedEdits(query[q].size());
+			size_t distance = (q == rarestWord && candidates[i].second != SIZE_MAX) ? candidates[i].second : wordDistance(words, query[q], maxEdits);
+
+			matched = distance <= maxEdits;
+			edits += distance;
+		}
+
+		if (matched) {
+			scored.emplace_back(edits, pos);
+		}
+	}
+
+	std::sort(scored.begin(), scored.end());
+
+	for (size_t i = 0; i < scored.size() && results.size() < limit; ++i) {
+		results.push_back(scored[i].second);
+	}
+}
+
+void NameIndex::clear() {
+	indexed_ = 0;
+
+	words_.clear();
+	wordOffsets_.clear();
+	wordPostings_.clear();
+
+	trigrams_.clear();
+	trigramOffsets_.clear();
+	trigramWords_.clear();
+}
+
+} // namespace inventory
@@ -0,0 +1,104 @@
+#include "inventory/NumericColumns.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+#include "inventory/Inventory.hpp"
+#include "thread_pool.hpp"
+
+namespace inventory {
+
+void NumericColumns::append(const Product& product) {
+	if (sorted_) {
+		for (std::vector<uint32_t>& order : sortOrders_) {
+			std::vector<uint32_t>().swap(order);
+		}
+
+		sorted_ = false;
+	}
+
+	columns_[price].push_back(product.price);
+	columns_[listPrice].push_back(product.listPrice);
+	columns_[rating].push_back(product.rating);
+	columns_[quantity].push_back(product.quantity);
+	columns_[stock].push_back(product.stock);
+}
+
+void NumericColumns::buildSortOrders() {
+	if (rows() > UINT32_MAX) {
+		return;
+	}
+
+	thread_pool::shared().parallel_for(0, columnCount, columnCount, [this](size_t column, size_t, size_t) {
+		sortColumn(static_cast<Column>(column));
+	});
+
+	sorted_ = true;
+}
+
+void NumericColumns::sortColumn(Column column) {
+	const std::vector<double>& values = columns_[column];
+	std::vector<uint32_t>& order = sortOrders_[column];
+
+	order.resize(values.size());
+
+	for (size_t row = 0; row < values.size(); ++row) {
+		order[row] = row;
+	}
+
+	auto missing = std::stable_partition(order.begin(), order.end(), [&](uint32_t row) {
+		return !std::isnan(values[row]);
+	});
+
+	std::sort(order.begin(), missing, [&](uint32_t a, uint32_t b) {
+		return values[a] < values[b] || (values[a] == values[b] && a < b);
+	});
+
+	presentCounts_[column] = missing - order.begin();
+}
+
+void NumericColumns::reserve(size_t rows) {
+	for (std::vector<double>& column : columns_) {
+		column.reserve(rows);
+	}
+}
+
+void NumericColumns::clear() {
+	for (int column = 0; column < columnCount; ++column) {
+		columns_[column].clear();
+		sortOrders_[column].clear();
+		presentCounts_[column] = 0;
+	}
+
+	sorted_ = false;
+}
+
+const char* NumericColumns::name(Column column) {
+	switch (column) {
+	case price: return "price";
+	case listPrice: return "list_price";
+	case rating: return "rating";
+	case quantity: return "quantity";
+	case stock: return "stock";
+	default: return "invalid";
+	}
+}
+
+NumericColumns::Column NumericColumns::find(const std::string& name) {
+	std::string lname;
+
+	for (char c : name) {
+		lname += static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+	}
+
+	for (int column = 0; column < columnCount; ++column) {
+		if (lname == NumericColumns::name(static_cast<Column>(column))) {
+			return static_cast<Column>(column);
+		}
+	}
+
+	return columnCount;
+}
+
+} // namespace inventory
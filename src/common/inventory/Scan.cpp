@@ -0,0 +1,204 @@
+#include "inventory/Scan.hpp"
+
+#if defined(__x86_64__)
+#define INVENTORY_SCAN_X86 1
+#include <immintrin.h>
+#else
+#define INVENTORY_SCAN_X86 0
+#endif
+
+namespace inventory {
+
+namespace {
+
+template <CompareOp OP>
+bool compare(double value, double operand) {
+	switch (OP) {
+	case CompareOp::less: return value < operand;
+	case CompareOp::lessEqual: return value <= operand;
+	case CompareOp::greater: return value > operand;
+	case CompareOp::greaterEqual: return value >= operand;
+	case CompareOp::equal: return value == operand;
+	default: return value != operand;
+	}
+}
+
+/**
+ * @brief Builds one selection word from up to 64 values
+ */
+template <CompareOp OP>
+uint64_t scalarWord(const double* values, size_t count, double operand) {
+	uint64_t word = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		word |= static_cast<uint64_t>(compare<OP>(values[i], operand)) << i;
+	}
+
+	return word;
+}
+
+template <CompareOp OP>
+void scalarScan(const double* values, size_t count, double operand, uint64_t* selection) {
+	for (size_t w = 0; w * 64 < count; ++w) {
+		size_t rows = (count - w * 64 < 64) ? count - w * 64 : 64;
+		selection[w] = scalarWord<OP>(values + w * 64, rows, operand);
+	}
+}
+
+#if INVENTORY_SCAN_X86
+
+// SSE2 is part of x86-64, so these need no runtime check there. The
+// comparisons map one to one onto C++'s, including for NaN.
+template <CompareOp OP>
+__m128d sse2Compare(__m128d values, __m128d operand) {
+	switch (OP) {
+	case CompareOp::less: return _mm_cmplt_pd(values, operand);
+	case CompareOp::lessEqual: return _mm_cmple_pd(values, operand);
+	case CompareOp::greater: return _mm_cmpgt_pd(values, operand);
+	case CompareOp::greaterEqual: return _mm_cmpge_pd(values, operand);
+	case CompareOp::equal: return _mm_cmpeq_pd(values, operand);
+	default: return _mm_cmpneq_pd(values, operand);
+	}
+}
+
+template <CompareOp OP>
+void sse2Scan(const double* values, size_t count, double operand, uint64_t* selection) {
+	__m128d broadcast = _mm_set1_pd(operand);
+	size_t full = count / 64;
+
+	for (size_t w = 0; w < full; ++w) {
+		const double* block = values + w * 64;
+		uint64_t word = 0;
+
+		for (size_t i = 0; i < 64; i += 2) {
+			__m128d mask = sse2Compare<OP>(_mm_loadu_pd(block + i), broadcast);
+			word |= static_cast<uint64_t>(_mm_movemask_pd(mask)) << i;
+		}
+
+		selection[w] = word;
+	}
+
+	if (count % 64 != 0) {
+		selection[full] = scalarWord<OP>(values + full * 64, count % 64, operand);
+	}
+}
+
+// The predicate is an immediate of vcmppd. Ordered predicates are false for
+// NaN like C++'s comparisons, and NEQ_UQ is true like operator!=.
+template <CompareOp OP, int PREDICATE>
+__attribute__((target("avx2")))
+void avx2Scan(const double* values, size_t count, double operand, uint64_t* selection) {
+	__m256d broadcast = _mm256_set1_pd(operand);
+	size_t full = count / 64;
+
+	for (size_t w = 0; w < full; ++w) {
+		const double* block = values + w * 64;
+		uint64_t word = 0;
+
+		for (size_t i = 0; i < 64; i += 8) {
+			__m256d low = _mm256_cmp_pd(_mm256_loadu_pd(block + i), broadcast, PREDICATE);
+			__m256d high = _mm256_cmp_pd(_mm256_loadu_pd(block + i + 4), broadcast, PREDICATE);
+			uint64_t bits = _mm256_movemask_pd(low) | (_mm256_movemask_pd(high) << 4);
+			word |= bits << i;
+		}
+
+		selection[w] = word;
+	}
+
+	if (count % 64 != 0) {
+		selection[full] = scalarWord<OP>(values + full * 64, count % 64, operand);
+	}
+}
+
+#endif
+
+template <CompareOp OP>
+void dispatch(ScanIsa isa, const double* values, size_t count, double operand, uint64_t* selection) {
+#if INVENTORY_SCAN_X86
+	if (isa == ScanIsa::sse2) {
+		sse2Scan<OP>(values, count, operand, selection);
+		return;
+	}
+#endif
+
+	scalarScan<OP>(values, count, operand, selection);
+}
+
+#if INVENTORY_SCAN_X86
+void avx2Dispatch(CompareOp op, const double* values, size_t count, double operand, uint64_t* selection) {
+	switch (op) {
+	case CompareOp::less: avx2Scan<CompareOp::less, _CMP_LT_OQ>(values, count, operand, selection); break;
+	case CompareOp::lessEqual: avx2Scan<CompareOp::lessEqual, _CMP_LE_OQ>(values, count, operand, selection); break;
+	case CompareOp::greater: avx2Scan<CompareOp::greater, _CMP_GT_OQ>(values, count, operand, selection); break;
+	case CompareOp::greaterEqual: avx2Scan<CompareOp::greaterEqual, _CMP_GE_OQ>(values, count, operand, selection); break;
+	case CompareOp::equal: avx2Scan<CompareOp::equal, _CMP_EQ_OQ>(values, count, operand, selection); break;
+	case CompareOp::notEqual: avx2Scan<CompareOp::notEqual, _CMP_NEQ_UQ>(values, count, operand, selection); break;
+	}
+}
+#endif
+
+} // namespace
+
+ScanIsa bestScanIsa() {
+#if INVENTORY_SCAN_X86
+	static const ScanIsa best = __builtin_cpu_supports("avx2") ? ScanIsa::avx2 : ScanIsa::sse2;
+	return best;
+#else
+	return ScanIsa::scalar;
+#endif
+}
+
+const char* scanIsaName(ScanIsa isa) {
+	switch (isa) {
+	case ScanIsa::scalar: return "scalar";
+	case ScanIsa::sse2: return "sse2";
+	case ScanIsa::avx2: return "avx2";
+	default: return "invalid";
+	}
+}
+
+void compareScan(const double* values, size_t count, CompareOp op, double operand, uint64_t* selection) {
+	compareScan(bestScanIsa(), values, count, op, operand, selection);
+}
+
+void compareScan(ScanIsa isa, const double* values, size_t count, CompareOp op, double operand, uint64_t* selection) {
+#if INVENTORY_SCAN_X86
+	if (isa == ScanIsa::avx2) {
+		avx2Dispatch(op, values, count, operand, selection);
+		return;
+	}
+#endif
+
+	switch (op) {
+	case CompareOp::less: dispatch<CompareOp::less>(isa, values, count, operand, selection); break;
+	case CompareOp::lessEqual: dispatch<CompareOp::lessEqual>(isa, values, count, operand, selection); break;
+	case CompareOp::greater: dispatch<CompareOp::greater>(isa, values, count, operand, selection); break;
+	case CompareOp::greaterEqual: dispatch<CompareOp::greaterEqual>(isa, values, count, operand, selection); break;
+	case CompareOp::equal: dispatch<CompareOp::equal>(isa, values, count, operand, selection); break;
+	case CompareOp::notEqual: dispatch<CompareOp::notEqual>(isa, values, count, operand, selection); break;
+	}
+}
+
+void selectionAnd(uint64_t* dst, const uint64_t* src, size_t words) {
+	for (size_t w = 0; w < words; ++w) {
+		dst[w] &= src[w];
+	}
+}
+
+void selectionOr(uint64_t* dst, const uint64_t* src, size_t words) {
+	for (size_t w = 0; w < words; ++w) {
+		dst[w] |= src[w];
+	}
+}
+
+size_t selectionCount(const uint64_t* selection, size_t words) {
+	size_t count = 0;
+
+	for (size_t w = 0; w < words; ++w) {
+		count += __builtin_popcountll(selection[w]);
+	}
+
+	return count;
+}
+
+} // namespace inventory
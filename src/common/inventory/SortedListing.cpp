@@ -0,0 +1,133 @@
+#include "inventory/SortedListing.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "inventory/Inventory.hpp"
+
+namespace inventory {
+
+namespace {
+
+// Walking is chosen when the expected steps are fewer than this fraction of
+// the comparisons sorting the category takes. Steps touch a product each,
+// selecting only reads columns.
+const double walkFraction = 1.0 / 8;
+
+} // namespace
+
+SortedListing::SortedListing(const Inventory& inventory, size_t category, NumericColumns::Column column,
+                             bool descending, size_t limit) :
+	inventory_(inventory),
+	category_(category),
+	values_(inventory.columns().column(column)),
+	descending_(descending),
+	remaining_(limit),
+	order_(inventory.columns().sortOrder(column)),
+	present_(inventory.columns().presentCount(column)) {
+
+	const std::vector<size_t>& members = inventory.categoryMembers(category);
+	unlisted_ = members.size();
+
+	// The expected steps to find limit members spread evenly over the rows,
+	// at most every row
+	double count = static_cast<double>(members.size());
+	double steps = std::min(static_cast<double>(std::min(limit, members.size())) * inventory.size() / std::max(count, 1.0),
+	                        static_cast<double>(inventory.size()));
+	walk_ = inventory.columns().sorted() && steps < count * std::log2(std::max(count, 2.0)) * walkFraction;
+
+	if (walk_) {
+		// Long walks check a bitmap of the members instead of each product
+		if (steps > count) {
+			isMember_.resize(inventory.size());
+
+			for (size_t pos : members) {
+				isMember_[pos] = true;
+			}
+		}
+
+		return;
+	}
+
+	rows_.assign(members.begin(), members.end());
+
+	auto missing = std::stable_partition(rows_.begin(), rows_.end(), [&](size_t row) {
+		return !std::isnan(values_[row]);
+	});
+
+	presentRows_ = missing - rows_.begin();
+}
+
+bool SortedListing::next(size_t& pos) {
+	if (remaining_ == 0) {
+		return false;
+	}
+
+	if (walk_ ? !nextInOrder(pos) : !nextSelected(pos)) {
+		return false;
+	}
+
+	--remaining_;
+	return true;
+}
+
+bool SortedListing::nextInOrder(size_t& pos) {
+	while (unlisted_ > 0 && step_ < order_.size()) {
+		size_t step = step_++;
+		uint32_t row = (descending_ && step < present_) ? order_[present_ - 1 - step] : order_[step];
+		if (isMember(row)) {
+			--unlisted_;
+			pos = row;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool SortedListing::nextSelected(size_t& pos) {
+	if (listed_ == selected_) {
+		if (selected_ < presentRows_) {
+			// Select and sort only the first page, then the rest up to the
+			// limit. Products past the limit are never ordered.
+			size_t page = std::min(std::min(page_, remaining_), presentRows_ - selected_);
+			auto first = rows_.begin() + selected_;
+			auto cmp = [this](size_t a, size_t b) { return ordered(a, b); };
+
+			std::nth_element(first, first + page, rows_.begin() + presentRows_, cmp);
+			std::sort(first, first + page, cmp);
+
+			selected_ += page;
+			page_ = unlimited;
+		} else {
+			// Missing values are already in position order
+			selected_ = rows_.size();
+		}
+	}
+
+	if (listed_ == rows_.size()) {
+		return false;
+	}
+
+	pos = rows_[listed_++];
+	return true;
+}
+
+bool SortedListing::isMember(size_t row) const {
+	if (!isMember_.empty()) {
+		return isMember_[row];
+	}
+
+	const std::vector<size_t>& categories = inventory_.product(row).categories;
+	return std::find(categories.begin(), categories.end(), category_) != categories.end();
+}
+
+bool SortedListing::ordered(size_t a, size_t b) const {
+	if (descending_) {
+		return values_[a] > values_[b] || (values_[a] == values_[b] && a > b);
+	}
+
+	return values_[a] < values_[b] || (values_[a] == values_[b] && a < b);
+}
+
+} // namespace inventory
@@ -0,0 +1,416 @@
+#include "inventory/TextIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+#include "dsa/hash.hpp"
+#include "dsa/unordered_map.hpp"
+#include "inventory/Tokenizer.hpp"
+#include "thread_pool.hpp"
+
+namespace inventory {
+
+namespace {
+
+// Document id and the term's count in it
+using Posting = std::pair<uint32_t, uint32_t>;
+
+/**
+ * @brief Postings of a contiguous chunk of the documents
+ */
+struct ChunkIndex {
+	dsa::unordered_map<std::string, std::vector<Posting>, dsa::wyhash> postings;
+	size_t textBytes = 0;
+};
+
+void writeVarint(std::vector<uint8_t>& out, uint32_t value) {
+	while (value >= 0x80) {
+		out.push_back(static_cast<uint8_t>(value) | 0x80);
+		value >>= 7;
+	}
+
+	out.push_back(static_cast<uint8_t>(value));
+}
+
+uint32_t readVarint(const uint8_t*& in) {
+	uint32_t value = 0;
+	int shift = 0;
+
+	while (*in & 0x80) {
+		value |= static_cast<uint32_t>(*in++ & 0x7f) << shift;
+		shift += 7;
+	}
+
+	return value | (static_cast<uint32_t>(*in++) << shift);
+}
+
+void indexChunk(const std::vector<std::string>& documents, size_t begin, size_t end, ChunkIndex& chunk) {
+	std::vector<std::string> words;
+
+	for (size_t doc = begin; doc < end; ++doc) {
+		words.clear();
+		forEachWord(documents[doc], [&](const std::string& word) { words.push_back(word); });
+
+		std::sort(words.begin(), words.end());
+		chunk.textBytes += documents[doc].size();
+
+		for (size_t i = 0; i < words.size();) {
+			size_t run = i + 1;
+
+			while (run < words.size() && words[run] == words[i]) {
+				++run;
+			}
+
+			auto it = chunk.postings.find(words[i]);
+
+			if (it == chunk.postings.end()) {
+				it = chunk.postings.insert({ words[i], std::vector<Posting>() }).first;
+			}
+
+			it->second.emplace_back(doc, run - i);
+			i = run;
+		}
+	}
+}
+
+} // namespace
+
+class TextIndex::Cursor {
+public:
+	Cursor(const TextIndex& index, size_t term) :
+		info_(index.termInfo_[term]),
+		blocks_(index.blocks_.data() + info_.firstBlock),
+		data_(index.postings_.data() + info_.offset),
+		block_(0),
+		done_(false) {
+
+		enterBlock(0);
+		decode();
+	}
+
+	bool done() const { return done_; }
+	uint32_t document() const { return document_; }
+	uint32_t frequency() const { return frequency_; }
+	uint32_t documents() const { return info_.documents; }
+
+	void finish() { done_ = true; }
+
+	void next() {
+		if (pos_ == end_) {
+			if (++block_ == info_.blocks) {
+				done_ = true;
+				return;
+			}
+
+			enterBlock(block_);
+		}
+
+		decode();
+	}
+
+	/**
+	 * @brief Advances to the first document at or after target
+	 */
+	void seek(uint32_t target) {
+		if (done_ || document_ >= target) {
+			return;
+		}
+
+		if (blocks_[block_].lastDocument < target) {
+			// Gallop to a block ending at or after target, then binary
+			// search back to the first such block
+			size_t low = block_;
+			size_t step = 1;
+
+			while (low + step < info_.blocks && blocks_[low + step].lastDocument < target) {
+				low += step;
+				step *= 2;
+			}
+
+			size_t high = std::min<size_t>(low + step, info_.blocks);
+			const Block* found = std::partition_point(blocks_ + low, blocks_ + high, [&](const Block& block) {
+				return block.lastDocument < target;
+			});
+
+			if (found == blocks_ + info_.blocks) {
+				done_ = true;
+				return;
+			}
+
+			block_ = found - blocks_;
+			enterBlock(block_);
+			decode();
+		}
+
+		// The current block ends at or after target
+		while (document_ < target) {
+			decode();
+		}
+	}
+
+private:
+	void enterBlock(size_t block) {
+		pos_ = data_ + (block == 0 ? 0 : blocks_[block - 1].end);
+		end_ = data_ + blocks_[block].end;
+		document_ = (block == 0) ? 0 : blocks_[block - 1].lastDocument;
+	}
+
+	void decode() {
+		document_ += readVarint(pos_);
+		frequency_ = readVarint(pos_);
+	}
+
+	Term info_;
+	const Block* blocks_;
+	const uint8_t* data_;
+
+	size_t block_;
+	const uint8_t* pos_;
+	const uint8_t* end_;
+
+	uint32_t document_;
+	uint32_t frequency_;
+	bool done_;
+};
+
+void TextIndex::build(const std::vector<std::string>& documents, size_t threads) {
+	clear();
+
+	if (documents.size() > UINT32_MAX) {
+		throw std::length_error("Too many documents for the text index");
+	}
+
+	thread_pool& pool = thread_pool::shared();
+
+	if (threads == 0) {
+		threads = pool.concurrency();
+	}
+
+	// Chunks are contiguous, so concatenating their lists in chunk order
+	// keeps every list sorted
+	size_t chunkCount = std::max<size_t>(1, std::min(threads, documents.size()));
+	std::vector<ChunkIndex> chunks(pool.chunk_count(0, documents.size(), chunkCount));
+
+	pool.parallel_for(0, documents.size(), chunks.size(), [&](size_t c, size_t begin, size_t end) {
+		indexChunk(documents, begin, end, chunks[c]);
+	});
+
+	for (const ChunkIndex& chunk : chunks) {
+		textBytes_ += chunk.textBytes;
+
+		for (const auto& pair : chunk.postings) {
+			terms_.push_back(pair.first);
+		}
+	}
+
+	std::sort(terms_.begin(), terms_.end());
+	terms_.erase(std::unique(terms_.begin(), terms_.end()), terms_.end());
+	termInfo_.reserve(terms_.size());
+
+	for (const std::string& term : terms_) {
+		Term info;
+		info.documents = 0;
+		info.firstBlock = blocks_.size();
+		info.blocks = 0;
+		info.offset = postings_.size();
+
+		uint32_t previous = 0;
+
+		for (const ChunkIndex& chunk : chunks) {
+			auto it = chunk.postings.find(term);
+
+			if (it == chunk.postings.end()) {
+				continue;
+			}
+
+			for (const Posting& posting : it->second) {
+				// Each block's first difference is from the last block's end
+				writeVarint(postings_, posting.first - previous);
+				writeVarint(postings_, posting.second);
+				previous = posting.first;
+
+				if (++info.documents % blockSize == 0) {
+					blocks_.push_back(Block{ previous, static_cast<uint32_t>(postings_.size() - info.offset) });
+				}
+			}
+		}
+
+		if (info.documents % blockSize != 0) {
+			blocks_.push_back(Block{ previous, static_cast<uint32_t>(postings_.size() - info.offset) });
+		}
+
+		info.blocks = blocks_.size() - info.firstBlock;
+		termInfo_.push_back(info);
+	}
+
+	postings_.shrink_to_fit();
+	blocks_.shrink_to_fit();
+	documents_ = documents.size();
+}
+
+size_t TextIndex::findTerm(const std::string& term) const {
+	auto it = std::lower_bound(terms_.begin(), terms_.end(), term);
+
+	if (it == terms_.end() || *it != term) {
+		return terms_.size();
+	}
+
+	return it - terms_.begin();
+}
+
+std::vector<size_t> TextIndex::search(const std::string& query, size_t limit) const {
+	// Split into clauses of required words at each "OR"
+	std::vector<std::vector<std::string>> clauses(1);
+	std::string token;
+
+	auto endToken = [&] {
+		if (token == "OR") {
+			clauses.emplace_back();
+		} else {
+			forEachWord(token, [&](const std::string& word) { clauses.back().push_back(word); });
+		}
+
+		token.clear();
+	};
+
+	for (char c : query) {
+		if (c == ' ' || c == '\t') {
+			endToken();
+		} else {
+			token += c;
+		}
+	}
+
+	endToken();
+
+	// Document and score, from every clause
+	using Match = std::pair<uint32_t, double>;
+	std::vector<Match> matches;
+
+	for (std::vector<std::string>& words : clauses) {
+		size_t runBegin = matches.size();
+
+		std::sort(words.begin(), words.end());
+		words.erase(std::unique(words.begin(), words.end()), words.end());
+
+		std::vector<Cursor> cursors;
+
+		for (const std::string& word : words) {
+			size_t term = findTerm(word);
+
+			if (term == terms_.size()) {
+				cursors.clear();
+				break;
+			}
+
+			cursors.emplace_back(*this, term);
+		}
+
+		if (cursors.empty()) {
+			continue;
+		}
+
+		// Led by the rarest word, every other list seeks to its documents
+		std::sort(cursors.begin(), cursors.end(), [](const Cursor& a, const Cursor& b) {
+			return a.documents() < b.documents();
+		});
+
+		std::vector<double> weights;
+
+		for (const Cursor& cursor : cursors) {
+			weights.push_back(std::log(1.0 + static_cast<double>(documents_) / cursor.documents()));
+		}
+
+		Cursor& lead = cursors.front();
+
+		while (!lead.done()) {
+			uint32_t target = lead.document();
+			bool matched = true;
+
+			for (size_t i = 1; i < cursors.size() && matched; ++i) {
+				cursors[i].seek(target);
+
+				if (cursors[i].done()) {
+					// No later document can contain every word
+					lead.finish();
+					matched = false;
+				} else if (cursors[i].document() != target) {
+					matched = false;
+					target = cursors[i].document();
+				}
+			}
+
+			if (!matched) {
+				lead.seek(target);
+				continue;
+			}
+
+			double score = 0.0;
+
+			for (size_t i = 0; i < cursors.size(); ++i) {
+				uint32_t frequency = cursors[i].frequency();
+				score += (frequency == 1 ? 1.0 : 1.0 + std::log(static_cast<double>(frequency))) * weights[i];
+			}
+
+			matches.emplace_back(target, score);
+			lead.next();
+		}
+
+		// Each clause appends a run sorted by document, merge it with the
+		// runs before
+		std::inplace_merge(matches.begin(), matches.begin() + runBegin, matches.end(), [](const Match& a, const Match& b) {
+			return a.first < b.first;
+		});
+	}
+
+	// A document matching several clauses keeps its best score
+	size_t kept = 0;
+
+	for (size_t i = 0; i < matches.size(); ++i) {
+		if (kept > 0 && matches[kept - 1].first == matches[i].first) {
+			matches[kept - 1].second = std::max(matches[kept - 1].second, matches[i].second);
+		} else {
+			matches[kept++] = matches[i];
+		}
+	}
+
+	matches.resize(kept);
+
+	size_t count = std::min(limit, matches.size());
+
+	std::partial_sort(matches.begin(), matches.begin() + count, matches.end(), [](const Match& a, const Match& b) {
+		return a.second != b.second ? a.second > b.second : a.first < b.first;
+	});
+
+	std::vector<size_t> results;
+
+	for (size_t i = 0; i < count; ++i) {
+		results.push_back(matches[i].first);
+	}
+
+	return results;
+}
+
+size_t TextIndex::indexBytes() const {
+	size_t bytes = postings_.size() + blocks_.size() * sizeof(Block) + termInfo_.size() * sizeof(Term);
+
+	for (const std::string& term : terms_) {
+		bytes += term.size();
+	}
+
+	return bytes;
+}
+
+void TextIndex::clear() {
+	terms_.clear();
+	termInfo_.clear();
+	blocks_.clear();
+	postings_.clear();
+
+	documents_ = 0;
+	textBytes_ = 0;
+}
+
+} // namespace inventory
@@ -0,0 +1,89 @@
+#include "output_buffer.hpp"
+
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+
+output_buffer::output_buffer(int fd, size_t capacity) :
+	m_fd(fd),
+	m_buffer(capacity > 0 ? capacity : 1) {
+
+	setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+}
+
+output_buffer::~output_buffer() {
+	flush();
+}
+
+bool output_buffer::flush() {
+	size_t size = pptr() - pbase();
+	setp(m_buffer.data(), m_buffer.data() + m_buffer.size());
+
+	return size == 0 || write_all(m_buffer.data(), size);
+}
+
+output_buffer::int_type output_buffer::overflow(int_type ch) {
+	if (!flush()) {
+		return traits_type::eof();
+	}
+
+	if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+		*pptr() = traits_type::to_char_type(ch);
+		pbump(1);
+	}
+
+	return traits_type::not_eof(ch);
+}
+
+std::streamsize output_buffer::xsputn(const char* data, std::streamsize count) {
+	size_t size = static_cast<size_t>(count);
+
+	if (size > static_cast<size_t>(epptr() - pptr())) {
+		if (!flush()) {
+			return 0;
+		}
+
+		// Longer than the whole buffer, write it directly instead of copying
+		// it through in pieces
+		if (size > m_buffer.size()) {
+			return write_all(data, size) ? count : 0;
+		}
+	}
+
+	traits_type::copy(pptr(), data, size);
+	pbump(static_cast<int>(size));
+	return count;
+}
+
+int output_buffer::sync() {
+	return flush() ? 0 : -1;
+}
+
+bool output_buffer::write_all(const char* data, size_t size) {
+	while (size > 0) {
+		ssize_t written = ::write(m_fd, data, size);
+		++m_writes;
+
+		if (written < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+
+			return false;
+		}
+
+		data += written;
+		size -= written;
+	}
+
+	return true;
+}
+
+bool input_pending(std::istream& in, int fd) {
+	if (in.rdbuf()->in_avail() > 0) {
+		return true;
+	}
+
+	pollfd input = { fd, POLLIN, 0 };
+	return ::poll(&input, 1, 0) > 0;
+}
@@ -0,0 +1,166 @@
+#include "perf_counters.hpp"
+
+#ifdef __linux__
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// perf_counters
+
+bool perf_counters::any_available() const {
+	for (int i = 0; i < counter_count; ++i) {
+		if (available[i]) { return true; }
+	}
+
+	return false;
+}
+
+double perf_counters::instructions_per_cycle() const {
+	if (!available[cycles] || !available[instructions] || values[cycles] == 0) {
+		return 0.0;
+	}
+
+	return static_cast<double>(values[instructions]) / values[cycles];
+}
+
+perf_counters& perf_counters::operator+=(const perf_counters& rhs) {
+	for (int i = 0; i < counter_count; ++i) {
+		values[i] += rhs.values[i];
+		available[i] = available[i] || rhs.available[i];
+	}
+
+	return *this;
+}
+
+const char* perf_counters::name(counter c) {
+	switch (c) {
+	case cycles: return "cycles";
+	case instructions: return "instructions";
+	case cache_misses: return "cache_misses";
+	case branch_misses: return "branch_misses";
+	default: return "invalid";
+	}
+}
+
+// end perf_counters
+
+// perf_counter_group
+
+#ifdef __linux__
+
+namespace {
+
+const uint64_t hardware_events[perf_counters::counter_count] = {
+	PERF_COUNT_HW_CPU_CYCLES,
+	PERF_COUNT_HW_INSTRUCTIONS,
+	PERF_COUNT_HW_CACHE_MISSES,
+	PERF_COUNT_HW_BRANCH_MISSES,
+};
+
+int open_counter(uint64_t event, int group_fd) {
+	perf_event_attr attr;
+	std::memset(&attr, 0, sizeof(attr));
+
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = event;
+	attr.disabled = (group_fd == -1); // Only the leader starts disabled
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID;
+
+	// Calling thread, any CPU
+	return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+} // namespace
+
+perf_counter_group::perf_counter_group() {
+	for (int i = 0; i < perf_counters::counter_count; ++i) {
+		m_fds[i] = -1;
+		m_ids[i] = static_cast<uint64_t>(-1);
+	}
+
+	m_fds[0] = open_counter(hardware_events[0], -1);
+
+	if (m_fds[0] < 0) {
+		return;
+	}
+
+	// Members that fail to open are left out of the group
+	for (int i = 1; i < perf_counters::counter_count; ++i) {
+		m_fds[i] = open_counter(hardware_events[i], m_fds[0]);
+	}
+
+	for (int i = 0; i < perf_counters::counter_count; ++i) {
+		if (m_fds[i] >= 0) {
+			ioctl(m_fds[i], PERF_EVENT_IOC_ID, &m_ids[i]);
+		}
+	}
+}
+
+perf_counter_group::~perf_counter_group() {
+	for (int i = perf_counters::counter_count; i-- > 0; ) {
+		if (m_fds[i] >= 0) {
+			close(m_fds[i]);
+		}
+	}
+}
+
+void perf_counter_group::start() {
+	if (!available()) { return; }
+
+	ioctl(m_fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	ioctl(m_fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+perf_counters perf_counter_group::stop() {
+	perf_counters counters;
+
+	if (!available()) { return counters; }
+
+	ioctl(m_fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+	// PERF_FORMAT_GROUP | PERF_FORMAT_ID layout: nr, then { value, id } pairs
+	struct {
+		uint64_t nr;
+		struct { uint64_t value; uint64_t id; } values[perf_counters::counter_count];
+	} data;
+
+	if (read(m_fds[0], &data, sizeof(data)) <= 0) {
+		return counters;
+	}
+
+	// Match values back to counters by id, failed members shift the order
+	for (uint64_t n = 0; n < data.nr && n < perf_counters::counter_count; ++n) {
+		for (int i = 0; i < perf_counters::counter_count; ++i) {
+			if (m_fds[i] >= 0 && m_ids[i] == data.values[n].id) {
+				counters.values[i] = data.values[n].value;
+				counters.available[i] = true;
+			}
+		}
+	}
+
+	return counters;
+}
+
+#else
+
+perf_counter_group::perf_counter_group() {
+	for (int i = 0; i < perf_counters::counter_count; ++i) {
+		m_fds[i] = -1;
+	}
+}
+
+perf_counter_group::~perf_counter_group() {}
+
+void perf_counter_group::start() {}
+
+perf_counters perf_counter_group::stop() { return perf_counters(); }
+
+#endif
+
+// end perf_counter_group
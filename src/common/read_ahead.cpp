@@ -0,0 +1,430 @@
+#include "read_ahead.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <new>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#endif
+
+#if defined(__linux__) && defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define PA3_IO_URING 1
+#else
+#define PA3_IO_URING 0
+#endif
+
+namespace {
+
+const size_t page_size = 4096;
+
+} // namespace
+
+#if PA3_IO_URING
+
+/**
+ * An io_uring set up through the raw system calls, with its submission and
+ * completion rings mapped
+ */
+struct read_ahead::ring {
+	~ring() {
+		if (sqes != MAP_FAILED) {
+			munmap(sqes, sqes_size);
+		}
+		if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr) {
+			munmap(cq_ptr, cq_size);
+		}
+		if (sq_ptr != MAP_FAILED) {
+			munmap(sq_ptr, sq_size);
+		}
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
+
+	/**
+	 * @brief Sets up a ring for entries reads in flight
+	 *
+	 * @returns The ring, or null if io_uring is unavailable
+	 */
+	static std::unique_ptr<ring> open(unsigned entries) {
+		std::unique_ptr<ring> r(new ring());
+		io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+
+		r->fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+
+		if (r->fd < 0) {
+			return nullptr;
+		}
+
+		r->sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		r->cq_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+		// Newer kernels map both rings at once
+		bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+
+		if (single) {
+			r->sq_size = r->cq_size = std::max(r->sq_size, r->cq_size);
+		}
+
+		r->sq_ptr = mmap(nullptr, r->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd,
+		                 IORING_OFF_SQ_RING);
+
+		if (r->sq_ptr == MAP_FAILED) {
+			return nullptr;
+		}
+
+		r->cq_ptr = single ? r->sq_ptr
+		                   : mmap(nullptr, r->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, r->fd,
+		                          IORING_OFF_CQ_RING);
+
+		if (r->cq_ptr == MAP_FAILED) {
+			return nullptr;
+		}
+
+		r->sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+		r->sqes = static_cast<io_uring_sqe*>(mmap(nullptr, r->sqes_size, PROT_READ | PROT_WRITE,
+		                                          MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES));
+
+		if (r->sqes == MAP_FAILED) {
+			return nullptr;
+		}
+
+		char* sq = static_cast<char*>(r->sq_ptr);
+		char* cq = static_cast<char*>(r->cq_ptr);
+
+		r->sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+		r->sq_mask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+		r->sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+		r->cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+		r->cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+		r->cq_mask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+		r->cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+		return r;
+	}
+
+	/**
+	 * @brief Submits a read of a single iovec
+	 *
+	 * @returns false if the kernel refused it
+	 */
+	bool read(int file, const iovec* iov, uint64_t offset, uint64_t user_data) {
+		unsigned tail = *sq_tail;
+		unsigned slot = tail & sq_mask;
+
+		io_uring_sqe& sqe = sqes[slot];
+		std::memset(&sqe, 0, sizeof(sqe));
+
+		// READV rather than READ, which needs 5.6
+		sqe.opcode = IORING_OP_READV;
+		sqe.fd = file;
+		sqe.addr = reinterpret_cast<uint64_t>(iov);
+		sqe.len = 1;
+		sqe.off = offset;
+		sqe.user_data = user_data;
+
+		sq_array[slot] = slot;
+		__atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+		return enter(1, 0, 0);
+	}
+
+	bool enter(unsigned submit, unsigned complete, unsigned flags) {
+		while (syscall(__NR_io_uring_enter, fd, submit, complete, flags, nullptr, 0) < 0) {
+			if (errno != EINTR) {
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	int fd = -1;
+
+	void* sq_ptr = MAP_FAILED;
+	size_t sq_size = 0;
+	void* cq_ptr = MAP_FAILED;
+	size_t cq_size = 0;
+	io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+	size_t sqes_size = 0;
+
+	unsigned* sq_tail = nullptr;
+	unsigned sq_mask = 0;
+	unsigned* sq_array = nullptr;
+	unsigned* cq_head = nullptr;
+	unsigned* cq_tail = nullptr;
+	unsigned cq_mask = 0;
+	io_uring_cqe* cqes = nullptr;
+
+	// One per buffer, read by the kernel when the read is submitted
+	std::vector<iovec> iovecs;
+};
+
+#else
+
+struct read_ahead::ring {
+	static std::unique_ptr<ring> open(unsigned) { return nullptr; }
+};
+
+#endif
+
+read_ahead::read_ahead(const std::string& filename, size_t block_size, size_t depth, bool use_uring) :
+	m_filename(filename),
+	m_block_size((std::max<size_t>(block_size, 1) + page_size - 1) / page_size * page_size) {
+
+	m_fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+
+	if (m_fd < 0) {
+		throw std::runtime_error("Failed to open file " + filename);
+	}
+
+	try {
+		struct stat info;
+
+		if (fstat(m_fd, &info) != 0) {
+			throw std::runtime_error("Failed to open file " + filename);
+		}
+
+		m_file_size = static_cast<uint64_t>(info.st_size);
+		m_blocks = (m_file_size + m_block_size - 1) / m_block_size;
+
+		// No more buffers than blocks, small files don't need a ring
+		m_buffers.resize(static_cast<size_t>(std::min<uint64_t>(std::max<size_t>(depth, 1), m_blocks)));
+
+		for (buffer& buf : m_buffers) {
+			void* data = nullptr;
+
+			if (posix_memalign(&data, page_size, m_block_size) != 0) {
+				throw std::bad_alloc();
+			}
+
+			buf.data = static_cast<char*>(data);
+		}
+
+		if (use_uring && !m_buffers.empty()) {
+			m_ring = ring::open(static_cast<unsigned>(m_buffers.size()));
+		}
+
+#if PA3_IO_URING
+		if (m_ring) {
+			m_ring->iovecs.resize(m_buffers.size());
+		}
+#endif
+
+		if (!m_ring) {
+			posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		}
+
+		for (uint64_t block = 0; block < m_buffers.size(); ++block) {
+			queue(block);
+		}
+	} catch (...) {
+		release();
+		throw;
+	}
+}
+
+read_ahead::~read_ahead() {
+	release();
+}
+
+bool read_ahead::next(const char*& data, size_t& size) {
+	if (m_next >= m_blocks) {
+		return false;
+	}
+
+	// The block handed out last is done with, reuse its buffer
+	if (m_next > 0) {
+		queue(m_next - 1 + m_buffers.size());
+	}
+
+	buffer& buf = m_buffers[m_next % m_buffers.size()];
+
+	if (m_ring) {
+		while (buf.pending) {
+			reap(true);
+		}
+	} else {
+		while (buf.filled < buf.size) {
+			ssize_t got = pread(m_fd, buf.data + buf.filled, buf.size - buf.filled, buf.offset + buf.filled);
+
+			if (got < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+
+				buf.error = errno;
+				break;
+			}
+
+			// The file shrank since it was opened
+			if (got == 0) {
+				buf.size = buf.filled;
+				break;
+			}
+
+			buf.filled += got;
+		}
+
+		buf.pending = false;
+	}
+
+	if (buf.error != 0) {
+		throw std::runtime_error("Failed to read file " + m_filename + ": " + std::strerror(buf.error));
+	}
+
+	if (buf.size == 0) {
+		m_blocks = m_next;
+		return false;
+	}
+
+	data = buf.data;
+	size = buf.size;
+	++m_next;
+
+	// A block cut short by the file shrinking is the last
+	if (buf.size < block_bytes(m_next - 1)) {
+		m_blocks = m_next;
+	}
+
+	return true;
+}
+
+size_t read_ahead::block_bytes(uint64_t block) const {
+	return static_cast<size_t>(std::min<uint64_t>(m_block_size, m_file_size - block_offset(block)));
+}
+
+void read_ahead::queue(uint64_t block) {
+	if (block >= m_blocks) {
+		return;
+	}
+
+	buffer& buf = m_buffers[block % m_buffers.size()];
+	buf.offset = block_offset(block);
+	buf.size = block_bytes(block);
+	buf.filled = 0;
+	buf.error = 0;
+	buf.pending = true;
+
+	if (m_ring) {
+		submit(buf);
+	} else {
+		posix_fadvise(m_fd, buf.offset, buf.size, POSIX_FADV_WILLNEED);
+	}
+}
+
+#if PA3_IO_URING
+
+void read_ahead::submit(buffer& buf) {
+	size_t index = &buf - m_buffers.data();
+
+	iovec& iov = m_ring->iovecs[index];
+	iov.iov_base = buf.data + buf.filled;
+	iov.iov_len = buf.size - buf.filled;
+
+	if (!m_ring->read(m_fd, &iov, buf.offset + buf.filled, index)) {
+		buf.error = errno;
+		buf.pending = false;
+		return;
+	}
+
+	++m_in_flight;
+}
+
+void read_ahead::reap(bool wait) {
+	ring& r = *m_ring;
+
+	while (true) {
+		unsigned head = *r.cq_head;
+		unsigned tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+
+		if (head != tail) {
+			// Copy the completions out first, resubmitting may complete more
+			std::vector<io_uring_cqe> done;
+
+			for (; head != tail; ++head) {
+				done.push_back(r.cqes[head & r.cq_mask]);
+			}
+
+			__atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+
+			for (const io_uring_cqe& cqe : done) {
+				buffer& buf = m_buffers[cqe.user_data];
+				--m_in_flight;
+
+				if (cqe.res == -EINTR || cqe.res == -EAGAIN) {
+					submit(buf);
+				} else if (cqe.res < 0) {
+					buf.error = -cqe.res;
+					buf.pending = false;
+				} else if (cqe.res == 0) {
+					// The file shrank since it was opened
+					buf.size = buf.filled;
+					buf.pending = false;
+				} else {
+					buf.filled += cqe.res;
+
+					// Short reads are continued where they stopped
+					if (buf.filled < buf.size) {
+						submit(buf);
+					} else {
+						buf.pending = false;
+					}
+				}
+			}
+
+			return;
+		}
+
+		if (!wait) {
+			return;
+		}
+
+		if (!r.enter(0, 1, IORING_ENTER_GETEVENTS)) {
+			throw std::runtime_error("Failed to read file " + m_filename + ": " + std::strerror(errno));
+		}
+	}
+}
+
+#else
+
+void read_ahead::submit(buffer&) {}
+void read_ahead::reap(bool) {}
+
+#endif
+
+void read_ahead::release() {
+	while (m_in_flight > 0) {
+		try {
+			reap(true);
+		} catch (...) {
+			break;
+		}
+	}
+
+	// Buffers the kernel may still write to are leaked rather than freed
+	if (m_in_flight == 0) {
+		for (buffer& buf : m_buffers) {
+			std::free(buf.data);
+			buf.data = nullptr;
+		}
+	}
+
+	m_ring.reset();
+
+	if (m_fd >= 0) {
+		close(m_fd);
+		m_fd = -1;
+	}
+}
@@ -0,0 +1,214 @@
+#include "stats.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+namespace stats {
+
+namespace {
+
+// Only locked when threads start or exit, and when collecting
+std::mutex& registry_mutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+
+std::vector<thread_block*>& live_blocks() {
+	static std::vector<thread_block*> blocks;
+	return blocks;
+}
+
+// Totals from threads that have exited
+snapshot& retired() {
+	static snapshot totals;
+	return totals;
+}
+
+void accumulate(snapshot& snap, const thread_block& block) {
+	for (int h = 0; h < histogram_count; ++h) {
+		const thread_block::histogram& src = block.histograms[h];
+		histogram_snapshot& dst = snap.histograms[h];
+
+		dst.count += src.count.load(std::memory_order_relaxed);
+		dst.sum += src.sum.load(std::memory_order_relaxed);
+		dst.max = std::max(dst.max, src.max.load(std::memory_order_relaxed));
+
+		for (int b = 0; b < bucket_count; ++b) {
+			dst.buckets[b] += src.buckets[b].load(std::memory_order_relaxed);
+		}
+	}
+
+	for (int c = 0; c < counter_count; ++c) {
+		snap.counters[c] += block.counters[c].load(std::memory_order_relaxed);
+	}
+}
+
+bool is_time(histogram_id id) {
+	return id != hash_probe_length && id != avl_lookup_depth;
+}
+
+} // namespace
+
+thread_block::thread_block() {
+	for (histogram& hist : histograms) {
+		hist.count.store(0, std::memory_order_relaxed);
+		hist.sum.store(0, std::memory_order_relaxed);
+		hist.max.store(0, std::memory_order_relaxed);
+
+		for (std::atomic<uint64_t>& bucket : hist.buckets) {
+			bucket.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	for (std::atomic<uint64_t>& counter : counters) {
+		counter.store(0, std::memory_order_relaxed);
+	}
+
+	std::lock_guard<std::mutex> lock(registry_mutex());
+	live_blocks().push_back(this);
+}
+
+thread_block::~thread_block() {
+	std::lock_guard<std::mutex> lock(registry_mutex());
+
+	accumulate(retired(), *this);
+
+	std::vector<thread_block*>& blocks = live_blocks();
+	blocks.erase(std::remove(blocks.begin(), blocks.end(), this), blocks.end());
+}
+
+uint64_t histogram_snapshot::percentile(double pct) const {
+	if (count == 0) {
+		return 0;
+	}
+
+	uint64_t rank = static_cast<uint64_t>(pct / 100.0 * count + 0.5);
+	uint64_t seen = 0;
+
+	for (int b = 0; b < bucket_count; ++b) {
+		seen += buckets[b];
+
+		if (seen >= rank && buckets[b] != 0) {
+			uint64_t upper = (b == 0) ? 0 : (b == 64 ? UINT64_MAX : (1ull << b) - 1);
+			return std::min(upper, max);
+		}
+	}
+
+	return max;
+}
+
+snapshot collect() {
+	std::lock_guard<std::mutex> lock(registry_mutex());
+
+	snapshot snap = retired();
+
+	for (const thread_block* block : live_blocks()) {
+		accumulate(snap, *block);
+	}
+
+	return snap;
+}
+
+const char* name(histogram_id id) {
+	switch (id) {
+	case command_find_ns: return "command_find_ns";
+	case command_list_inventory_ns: return "command_list_inventory_ns";
+	case command_search_ns: return "command_search_ns";
+	case command_search_text_ns: return "command_search_text_ns";
+	case command_where_ns: return "command_where_ns";
+	case command_stats_ns: return "command_stats_ns";
+	case hash_probe_length: return "hash_probe_length";
+	case avl_lookup_depth: return "avl_lookup_depth";
+	case rehash_ns: return "rehash_ns";
+	case load_parse_ns: return "load_parse_ns";
+	case load_index_ns: return "load_index_ns";
+	default: return "invalid";
+	}
+}
+
+const char* name(counter_id id) {
+	switch (id) {
+	case rehash_count: return "rehash_count";
+	case filter_reject: return "filter_reject";
+	case filter_pass: return "filter_pass";
+	case filter_false_positive: return "filter_false_positive";
+	default: return "invalid";
+	}
+}
+
+void write_text(std::ostream& out, const snapshot& snap) {
+	std::ios::fmtflags flags = out.flags();
+	std::streamsize precision = out.precision();
+
+	out << std::left << std::setw(28) << "histogram" << std::right
+	    << std::setw(12) << "count"
+	    << std::setw(14) << "mean"
+	    << std::setw(12) << "p50"
+	    << std::setw(12) << "p99"
+	    << std::setw(14) << "max" << '\n';
+
+	for (int h = 0; h < histogram_count; ++h) {
+		const histogram_snapshot& hist = snap.histograms[h];
+		histogram_id id = static_cast<histogram_id>(h);
+
+		// Times are shown in microseconds, lengths and depths as is
+		double scale = is_time(id) ? 1000.0 : 1.0;
+
+		out << std::left << std::setw(28) << name(id) << std::right
+		    << std::setw(12) << hist.count
+		    << std::fixed << std::setprecision(2)
+		    << std::setw(14) << hist.mean() / scale
+		    << std::setw(12) << hist.percentile(50.0) / scale
+		    << std::setw(12) << hist.percentile(99.0) / scale
+		    << std::setw(14) << hist.max / scale
+		    << (is_time(id) ? " us" : "") << '\n';
+	}
+
+	for (int c = 0; c < counter_count; ++c) {
+		out << std::left << std::setw(28) << name(static_cast<counter_id>(c)) << std::right
+		    << std::setw(12) << snap.counters[c] << '\n';
+	}
+
+	out.flags(flags);
+	out.precision(precision);
+}
+
+void write_json(std::ostream& out, const snapshot& snap) {
+	out << "{\"histograms\": {";
+
+	for (int h = 0; h < histogram_count; ++h) {
+		const histogram_snapshot& hist = snap.histograms[h];
+
+		out << (h ? ", " : "") << "\"" << name(static_cast<histogram_id>(h)) << "\": {"
+		    << "\"count\": " << hist.count
+		    << ", \"sum\": " << hist.sum
+		    << ", \"max\": " << hist.max
+		    << ", \"p50\": " << hist.percentile(50.0)
+		    << ", \"p99\": " << hist.percentile(99.0)
+		    << ", \"buckets\": [";
+
+		// Trailing empty buckets are omitted
+		int last = bucket_count;
+		while (last > 0 && hist.buckets[last - 1] == 0) {
+			--last;
+		}
+
+		for (int b = 0; b < last; ++b) {
+			out << (b ? ", " : "") << hist.buckets[b];
+		}
+
+		out << "]}";
+	}
+
+	out << "}, \"counters\": {";
+
+	for (int c = 0; c < counter_count; ++c) {
+		out << (c ? ", " : "") << "\"" << name(static_cast<counter_id>(c)) << "\": " << snap.counters[c];
+	}
+
+	out << "}}\n";
+}
+
+} // namespace stats
@@ -0,0 +1,337 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+#ifdef __linux__
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#endif
+
+namespace {
+
+// The pool and queue index of the calling worker thread, if any
+thread_local const thread_pool* current_pool = nullptr;
+thread_local size_t current_index = 0;
+
+#ifdef __linux__
+
+/**
+ * @brief Reads a CPU list such as "0-3,8-11" into a set
+ */
+void parse_cpu_list(const char* list, cpu_set_t& cpus) {
+	CPU_ZERO(&cpus);
+
+	while (*list != '\0') {
+		char* end = nullptr;
+		long first = std::strtol(list, &end, 10);
+
+		if (end == list) {
+			break;
+		}
+
+		long last = first;
+
+		if (*end == '-') {
+			list = end + 1;
+			last = std::strtol(list, &end, 10);
+		}
+
+		for (long cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu) {
+			CPU_SET(cpu, &cpus);
+		}
+
+		list = (*end == ',') ? end + 1 : end;
+
+		if (*list == '\n') {
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Gets the CPUs of each NUMA node this process may run on
+ */
+std::vector<cpu_set_t> numa_node_cpus() {
+	std::vector<cpu_set_t> nodes;
+	cpu_set_t allowed;
+
+	if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+		return nodes;
+	}
+
+	DIR* dir = opendir("/sys/devices/system/node");
+
+	if (dir == nullptr) {
+		return nodes;
+	}
+
+	while (dirent* entry = readdir(dir)) {
+		int node = 0;
+
+		if (std::sscanf(entry->d_name, "node%d", &node) != 1) {
+			continue;
+		}
+
+		std::string path = std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist";
+		FILE* file = std::fopen(path.c_str(), "r");
+
+		if (file == nullptr) {
+			continue;
+		}
+
+		char list[4096] = {};
+		bool read = std::fgets(list, sizeof(list), file) != nullptr;
+		std::fclose(file);
+
+		cpu_set_t cpus;
+
+		if (read) {
+			parse_cpu_list(list, cpus);
+			CPU_AND(&cpus, &cpus, &allowed);
+
+			// Nodes without memory-local CPUs left to us don't count
+			if (CPU_COUNT(&cpus) > 0) {
+				nodes.push_back(cpus);
+			}
+		}
+	}
+
+	closedir(dir);
+	return nodes;
+}
+
+#endif
+
+} // namespace
+
+// task_group
+
+task_group::task_group(thread_pool& pool) :
+	m_pool(pool),
+	m_pending(0),
+	m_cancelled(false) {}
+
+task_group::~task_group() {
+	m_pool.wait_for(*this);
+}
+
+void task_group::run(std::function<void()> fn) {
+	++m_pending;
+	m_pool.push({ std::move(fn), this });
+}
+
+void task_group::wait() {
+	m_pool.wait_for(*this);
+
+	std::lock_guard<std::mutex> lock(m_error_mutex);
+
+	if (m_error) {
+		std::exception_ptr error = m_error;
+		m_error = nullptr;
+		std::rethrow_exception(error);
+	}
+}
+
+void task_group::finish(std::exception_ptr error) {
+	if (error) {
+		std::lock_guard<std::mutex> lock(m_error_mutex);
+
+		if (!m_error) {
+			m_error = error;
+		}
+
+		m_cancelled = true;
+	}
+
+	// The group may be gone as soon as the count reaches zero
+	thread_pool& pool = m_pool;
+
+	if (--m_pending == 0) {
+		std::lock_guard<std::mutex> lock(pool.m_sleep_mutex);
+		pool.m_wake.notify_all();
+	}
+}
+
+// end task_group
+
+// thread_pool
+
+thread_pool::thread_pool(size_t workers, bool numa_pinning) :
+	m_queued(0) {
+
+	for (size_t i = 0; i <= workers; ++i) {
+		m_queues.emplace_back(new task_queue());
+	}
+
+	for (size_t i = 0; i < workers; ++i) {
+		m_threads.emplace_back(&thread_pool::work, this, i);
+	}
+
+	if (numa_pinning) {
+		pin_workers();
+	}
+}
+
+thread_pool::~thread_pool() {
+	{
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+		m_stopping = true;
+	}
+
+	m_wake.notify_all();
+
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+}
+
+thread_pool& thread_pool::shared() {
+	static thread_pool pool(std::max(1u, std::thread::hardware_concurrency()) - 1, true);
+	return pool;
+}
+
+size_t thread_pool::chunk_count(size_t begin, size_t end, size_t chunks) const {
+	if (chunks == 0) {
+		chunks = concurrency();
+	}
+
+	return std::max<size_t>(1, std::min(chunks, end - begin));
+}
+
+void thread_pool::push(task t) {
+	bool own = (current_pool == this);
+	task_queue& queue = *m_queues[own ? current_index : m_queues.size() - 1];
+
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(t));
+		++m_queued;
+	}
+
+	// Locking first, so a thread about to sleep sees the task or the wake up
+	{
+		std::lock_guard<std::mutex> lock(m_sleep_mutex);
+	}
+
+	m_wake.notify_one();
+}
+
+bool thread_pool::pop(task& t) {
+	if (m_queued == 0) {
+		return false;
+	}
+
+	bool own = (current_pool == this);
+	size_t self = own ? current_index : m_queues.size() - 1;
+
+	if (own && take(*m_queues[self], true, t)) {
+		return true;
+	}
+
+	// The shared queue, then the other workers' queues, starting after our own
+	for (size_t i = 0; i < m_queues.size(); ++i) {
+		size_t victim = (i == 0) ? m_queues.size() - 1 : (self + i) % m_queues.size();
+
+		if (victim != self || !own) {
+			if (take(*m_queues[victim], false, t)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+bool thread_pool::take(task_queue& queue, bool newest, task& t) {
+	std::lock_guard<std::mutex> lock(queue.mutex);
+
+	if (queue.tasks.empty()) {
+		return false;
+	}
+
+	if (newest) {
+		t = std::move(queue.tasks.back());
+		queue.tasks.pop_back();
+	} else {
+		t = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+	}
+
+	--m_queued;
+	return true;
+}
+
+void thread_pool::execute(task& t) {
+	std::exception_ptr error;
+
+	if (!t.group->cancelled()) {
+		try {
+			t.fn();
+		} catch (...) {
+			error = std::current_exception();
+		}
+	}
+
+	task_group* group = t.group;
+	t.fn = nullptr;
+	group->finish(error);
+}
+
+void thread_pool::work(size_t index) {
+	current_pool = this;
+	current_index = index;
+
+	task t;
+
+	for (;;) {
+		if (pop(t)) {
+			execute(t);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		m_wake.wait(lock, [this] { return m_queued > 0 || m_stopping; });
+
+		if (m_stopping) {
+			return;
+		}
+	}
+}
+
+void thread_pool::wait_for(task_group& group) {
+	task t;
+
+	while (group.m_pending > 0) {
+		if (pop(t)) {
+			execute(t);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleep_mutex);
+		m_wake.wait(lock, [&] { return group.m_pending == 0 || m_queued > 0; });
+	}
+}
+
+void thread_pool::pin_workers() {
+#ifdef __linux__
+	std::vector<cpu_set_t> nodes = numa_node_cpus();
+
+	if (nodes.size() < 2 || m_threads.empty()) {
+		return;
+	}
+
+	// Consecutive workers share a node
+	for (size_t i = 0; i < m_threads.size(); ++i) {
+		const cpu_set_t& cpus = nodes[i * nodes.size() / m_threads.size()];
+		pthread_setaffinity_np(m_threads[i].native_handle(), sizeof(cpus), &cpus);
+	}
+
+	m_numa_nodes = nodes.size();
+#endif
+}
+
+// end thread_pool
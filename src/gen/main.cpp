@@ -0,0 +1,99 @@
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "generator/InventoryGenerator.hpp"
+
+namespace {
+
+void usage(const char* program) {
+	std::cerr << "Usage: " << program << " [options]\n"
+	          << "Writes an Amazon-style inventory CSV, and optionally a query trace for it.\n"
+	          << "  --rows N          Number of products (default 10000)\n"
+	          << "  --seed N          Seed, the same seed always produces the same data (default 42)\n"
+	          << "  --categories N    Distinct category paths (default 200)\n"
+	          << "  --zipf S          Zipf exponent of products per category, 0 is uniform (default 1.0)\n"
+	          << "  --text-length N   Approximate length of long text columns (default 300)\n"
+	          << "  --out FILE        Write the CSV to FILE instead of stdout\n"
+	          << "  --trace FILE      Write a query trace of REPL commands to FILE\n"
+	          << "  --queries N       Number of queries in the trace (default 10000)\n"
+	          << "  --trace-seed N    Seed for the trace (default 7)\n"
+	          << "  --hit-ratio R     Fraction of queries for existing ids/categories (default 0.8)\n"
+	          << "  --list-ratio R    Fraction of queries that are listInventory (default 0.1)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, const char** argv) {
+	generator::GeneratorOptions options;
+	generator::TraceOptions traceOptions;
+	std::string outFile;
+	std::string traceFile;
+
+	for (int i = 1; i < argc; ++i) {
+		std::string arg = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (arg == "--rows" && hasValue) {
+			options.rows = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--seed" && hasValue) {
+			options.seed = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--categories" && hasValue) {
+			options.categories = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--zipf" && hasValue) {
+			options.zipfExponent = std::strtod(argv[++i], nullptr);
+		} else if (arg == "--text-length" && hasValue) {
+			options.textLength = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--out" && hasValue) {
+			outFile = argv[++i];
+		} else if (arg == "--trace" && hasValue) {
+			traceFile = argv[++i];
+		} else if (arg == "--queries" && hasValue) {
+			traceOptions.queries = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--trace-seed" && hasValue) {
+			traceOptions.seed = std::strtoull(argv[++i], nullptr, 10);
+		} else if (arg == "--hit-ratio" && hasValue) {
+			traceOptions.hitRatio = std::strtod(argv[++i], nullptr);
+		} else if (arg == "--list-ratio" && hasValue) {
+			traceOptions.listRatio = std::strtod(argv[++i], nullptr);
+		} else {
+			usage(argv[0]);
+			return -1;
+		}
+	}
+
+	try {
+		generator::InventoryGenerator gen(options);
+
+		if (outFile.empty()) {
+			std::ios::sync_with_stdio(false);
+			gen.write(std::cout);
+		} else {
+			std::ofstream out(outFile, std::ios::binary);
+
+			if (!out.is_open()) {
+				std::cerr << "Failed to open " << outFile << std::endl;
+				return -2;
+			}
+
+			gen.write(out);
+		}
+
+		if (!traceFile.empty()) {
+			std::ofstream trace(traceFile, std::ios::binary);
+
+			if (!trace.is_open()) {
+				std::cerr << "Failed to open " << traceFile << std::endl;
+				return -2;
+			}
+
+			generator::writeQueryTrace(gen, traceOptions, trace);
+		}
+	} catch (const std::exception& e) {
+		std::cerr << e.what() << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "epoch_domain.hpp"
+#include "inventory/Commands.hpp"
+#include "inventory/Inventory.hpp"
+#include "output_buffer.hpp"
+#include "stats.hpp"
+
+using namespace std;
+
+static const char* defaultDataFile = "marketing_sample_for_amazon_com-ecommerce__20200101_20200131__10k_data.csv";
+
+inventory::Inventory inventoryData;
+
+// Responses are buffered and written once the next command has to be waited
+// for, instead of flushing every line
+output_buffer outputBuffer(STDOUT_FILENO);
+ostream out(&outputBuffer);
+
+void printHelp()
+{
+    out << "Supported list of commands: \n";
+    out << " 1. find <inventoryid> - Finds if the inventory exists. If exists, prints details. If not, prints 'Inventory not found'.\n";
+    out << " 2. listInventory <category_string> [order by <column> [asc|desc]] [limit N] - Lists just the id and name of all inventory belonging to the specified category. If the category doesn't exists, prints 'Invalid Category'. Can be ordered by price, list_price, rating, quantity or stock, and limited to the first N products.\n\n";
+    out << " 3. search <text> [limit N] - Lists the id and name of the products whose name best matches the text, allowing partial words and typos. Lists 10 products unless a limit is given.\n";
+    out << " 4. searchText <words> [limit N] - Lists the id and name of the products whose description contains all the words, best match first. Separate words with OR to match any of them. Lists 10 products unless a limit is given.\n";
+    out << " 5. where <filter> [limit N] - Lists the id and name of the products matching a filter on price, list_price, rating, quantity or stock, e.g. 'where price < 20 and rating >= 4', then the number of matches. Conditions use < <= > >= = !=, joined by and/or. Lists 10 products unless a limit is given.\n";
+    out << " 6. stats <column> [by category|brand] - Prints the count, sum, min, max and average of a numeric column, per category or brand if requested.\n";
+    out << " 7. :stats [json] - Prints command latencies and data structure statistics, as JSON if requested.\n";
+    out << " Use :quit to quit the REPL\n";
+}
+
+void printStats(bool json)
+{
+    if (!stats::enabled())
+    {
+        out << "Statistics were disabled at build time (PA3_STATS=OFF)\n";
+        return;
+    }
+
+    stats::snapshot snapshot = stats::collect();
+
+    if (json)
+    {
+        stats::write_json(out, snapshot);
+    }
+    else
+    {
+        stats::write_text(out, snapshot);
+    }
+}
+
+bool validCommand(string line)
+{
+    return (line == ":help") ||
+           (line.rfind(":stats", 0) == 0) ||
+           (line.rfind("find", 0) == 0) ||
+           (line.rfind("search", 0) == 0) ||
+           (line.rfind("where", 0) == 0) ||
+           (line.rfind("stats", 0) == 0) ||
+           (line.rfind("listInventory") == 0);
+}
+
+void evalCommand(string line)
+{
+    if (line == ":help")
+    {
+        printHelp();
+    }
+    else if (line.rfind(":stats", 0) == 0)
+    {
+        printStats(inventory::commandArgument(line, ":stats") == "json");
+    }
+    // if line starts with find
+    else if (line.rfind("find", 0) == 0)
+    {
+        inventory::findCommand(inventoryData, inventory::commandArgument(line, "find"), out);
+    }
+    // if line starts with searchText, before the search prefix matches it
+    else if (line.rfind("searchText", 0) == 0)
+    {
+        inventory::searchTextCommand(inventoryData, inventory::commandArgument(line, "searchText"), out);
+    }
+    // if line starts with search
+    else if (line.rfind("search", 0) == 0)
+    {
+        inventory::searchCommand(inventoryData, inventory::commandArgument(line, "search"), out);
+    }
+    // if line starts with where
+    else if (line.rfind("where", 0) == 0)
+    {
+        inventory::whereCommand(inventoryData, inventory::commandArgument(line, "where"), out);
+    }
+    // if line starts with stats
+    else if (line.rfind("stats", 0) == 0)
+    {
+        inventory::statsCommand(inventoryData, inventory::commandArgument(line, "stats"), out);
+    }
+    // if line starts with listInventory
+    else if (line.rfind("listInventory") == 0)
+    {
+        inventory::listInventoryCommand(inventoryData, inventory::commandArgument(line, "listInventory"), out);
+    }
+}
+
+// Prints how long each stage of loading took, the concurrent index builders
+// together taking as long as the slowest of them
+void printLoadStages(const vector<inventory::LoadStage>& stages)
+{
+    double total = 0.0;
+    double indexes = 0.0;
+    string concurrent;
+
+    out << fixed << setprecision(1) << " Startup:";
+
+    for (const inventory::LoadStage& stage : stages)
+    {
+        if (stage.concurrent)
+        {
+            indexes = max(indexes, stage.milliseconds);
+            concurrent += (concurrent.empty() ? "" : ", ") + stage.name + " " + to_string(lround(stage.milliseconds));
+            continue;
+        }
+
+        total += stage.milliseconds;
+        out << " " << stage.name << " " << stage.milliseconds << " ms,";
+    }
+
+    out << " indexes " << indexes << " ms (" << concurrent << " ms), total " << total + indexes << " ms\n";
+    out.unsetf(ios::floatfield);
+}
+
+bool loadInventory(const string& filename)
+{
+    vector<inventory::LoadStage> stages;
+
+    try
+    {
+        stages = inventoryData.loadFile(filename);
+    }
+    catch (const exception& e)
+    {
+        outputBuffer.flush();
+        cerr << " Failed to load inventory: " << e.what() << endl;
+        return false;
+    }
+
+    out << " Loaded " << inventoryData.size() << " products in "
+         << inventoryData.categoryCount() << " categories\n";
+    printLoadStages(stages);
+    return true;
+}
+
+void bootStrap(const string& filename)
+{
+    out << "\n Welcome to Amazon Inventory Query System\n";
+    out << " enter :quit to exit. or :help to list supported commands.\n";
+    loadInventory(filename);
+    out << "\n> ";
+}
+
+// Reads the next command, flushing the output first unless the command is
+// already there, so piped commands are answered in as few writes as possible
+bool readCommand(string& line)
+{
+    if (!input_pending(cin, STDIN_FILENO))
+    {
+        outputBuffer.flush();
+    }
+
+    return static_cast<bool>(getline(cin, line));
+}
+
+int main(int argc, char const *argv[])
+{
+    // Reading from a pipe or file, cin needn't stay in step with stdio or
+    // flush cout before every read
+    if (!isatty(STDIN_FILENO))
+    {
+        ios::sync_with_stdio(false);
+        cin.tie(nullptr);
+    }
+
+    string line;
+    bootStrap(argc > 1 ? argv[1] : defaultDataFile);
+    while (readCommand(line) && line != ":quit")
+    {
+        if (validCommand(line))
+        {
+            evalCommand(line);
+        }
+        else
+        {
+            out << "Command not supported. Enter :help for list of supported commands\n";
+        }
+        // Nothing from the last command is still being read
+        epoch_domain::shared().quiescent();
+        out << "> ";
+    }
+    outputBuffer.flush();
+    return 0;
+}
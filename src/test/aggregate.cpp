@@ -0,0 +1,155 @@
+#include "test_common.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CSV/CSVStringReader.hpp"
+#include "inventory/Aggregate.hpp"
+#include "inventory/Commands.hpp"
+#include "inventory/Inventory.hpp"
+
+using namespace inventory;
+
+namespace {
+
+bool sameStats(const ColumnStats& a, const ColumnStats& b) {
+	auto same = [](double x, double y) { return (std::isnan(x) && std::isnan(y)) || std::fabs(x - y) < 1e-6; };
+	return a.products == b.products && a.count == b.count && same(a.sum, b.sum) && same(a.min, b.min) && same(a.max, b.max);
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_aggregate_groups(int argc, char** argv) {
+	const char* brands[] = { "Acme", "Globex", "" };
+	const char* categories[] = { "Toys | Puzzles", "Toys", "Home | Kitchen", "Home | Toys" };
+
+	Inventory inventory;
+	std::mt19937 random(9);
+
+	for (size_t i = 0; i < 5000; ++i) {
+		Product product;
+		product.id = std::to_string(i);
+		product.brand = brands[random() % 3];
+		product.category = categories[random() % 4];
+		product.price = (random() % 10 == 0) ? std::numeric_limits<double>::quiet_NaN() : (random() % 10000) / 100.0;
+		inventory.add(product);
+	}
+
+	// Expected statistics from a plain loop
+	std::map<std::string, ColumnStats> byCategory;
+	std::map<std::string, ColumnStats> byBrand;
+	ColumnStats all;
+
+	for (const Product& product : inventory.products()) {
+		all.add(product.price);
+		byBrand[product.brand.empty() ? "(no brand)" : product.brand].add(product.price);
+
+		for (size_t category : product.categories) {
+			byCategory[inventory.categoryName(category)].add(product.price);
+		}
+	}
+
+	for (size_t threads : { 1, 3 }) {
+		std::vector<GroupStats> total = aggregate(inventory, NumericColumns::price, GroupBy::all, threads);
+
+		if (total.size() != 1 || !sameStats(total[0].second, all) || all.count == all.products) {
+			std::cerr << "Incorrect statistics over all products" << std::endl;
+			return -1;
+		}
+
+		std::vector<GroupStats> categoryStats = aggregate(inventory, NumericColumns::price, GroupBy::category, threads);
+		std::vector<GroupStats> brandStats = aggregate(inventory, NumericColumns::price, GroupBy::brand, threads);
+
+		if (categoryStats.size() != byCategory.size() || brandStats.size() != byBrand.size()) {
+			std::cerr << "Incorrect number of groups with " << threads << " threads" << std::endl;
+			return -2;
+		}
+
+		// Both are sorted by name
+		auto expected = byCategory.begin();
+
+		for (const GroupStats& group : categoryStats) {
+			if (group.first != expected->first || !sameStats(group.second, expected->second)) {
+				std::cerr << "Incorrect statistics for category " << group.first << std::endl;
+				return -3;
+			}
+
+			++expected;
+		}
+
+		expected = byBrand.begin();
+
+		for (const GroupStats& group : brandStats) {
+			if (group.first != expected->first || !sameStats(group.second, expected->second)) {
+				std::cerr << "Incorrect statistics for brand " << group.first << std::endl;
+				return -4;
+			}
+
+			++expected;
+		}
+	}
+
+	// Empty inventories still have the single group
+	Inventory empty;
+	std::vector<GroupStats> none = aggregate(empty, NumericColumns::rating, GroupBy::all);
+
+	if (none.size() != 1 || none[0].second.count != 0 || !std::isnan(none[0].second.mean())) {
+		std::cerr << "Incorrect statistics for an empty inventory" << std::endl;
+		return -5;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_aggregate_command(int argc, char** argv) {
+	CSV::CSVStringReader reader("Uniq Id,Product Name,Brand Name,Category,Selling Price,Rating\n"
+	                            "a,Kite,Acme,Toys | Outdoor,$10.00,4\n"
+	                            "b,Ball,Acme,Toys,$20.00,\n"
+	                            "c,Pan,Globex,Kitchen,$30.00,5\n");
+
+	Inventory inventory;
+	inventory.load(reader.read());
+
+	std::ostringstream out;
+	statsCommand(inventory, "price by category", out);
+
+	if (out.str() != "Kitchen: count 1, sum 30, min 30, max 30, avg 30\n"
+	                 "Outdoor: count 1, sum 10, min 10, max 10, avg 10\n"
+	                 "Toys: count 2, sum 30, min 10, max 20, avg 15\n") {
+		std::cerr << "Unexpected stats output: " << out.str() << std::endl;
+		return -1;
+	}
+
+	out.str("");
+	statsCommand(inventory, "RATING by brand", out);
+
+	if (out.str() != "Acme: count 1, sum 4, min 4, max 4, avg 4\nGlobex: count 1, sum 5, min 5, max 5, avg 5\n") {
+		std::cerr << "Unexpected stats output by brand: " << out.str() << std::endl;
+		return -2;
+	}
+
+	out.str("");
+	statsCommand(inventory, "stock", out);
+
+	if (out.str() != "All products: count 0\n") {
+		std::cerr << "Unexpected stats output without values: " << out.str() << std::endl;
+		return -3;
+	}
+
+	out.str("");
+	statsCommand(inventory, "price by colour", out);
+	statsCommand(inventory, "weight", out);
+
+	if (out.str() != "Invalid grouping, expected \"by category\" or \"by brand\"\nInvalid column \"weight\"\n") {
+		std::cerr << "Unexpected output for invalid arguments: " << out.str() << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
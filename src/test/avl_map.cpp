@@ -181,3 +181,113 @@ TEST_ENTRYPOINT int test_avl_map_erase(int argc, char** argv) {
 }
 
 
+
+TEST_ENTRYPOINT int test_avl_map_find_many(int argc, char** argv) {
+	avl_map<std::string, int> map;
+
+	for (int i = 0; i < 1000; ++i) {
+		map.insert({ "key" + std::to_string(i * 3), i });
+	}
+
+	// Not a multiple of the group size, with hits and misses interleaved
+	std::vector<std::string> keys;
+	for (int i = 0; i < 2999; ++i) {
+		keys.push_back("key" + std::to_string(i));
+	}
+
+	const avl_map<std::string, int>& view = map;
+	std::vector<avl_map<std::string, int>::const_iterator> found = view.find_many(keys.data(), keys.size());
+	std::vector<uint8_t> contained = map.contains_many(keys.data(), keys.size());
+
+	if (found.size() != keys.size() || contained.size() != keys.size()) {
+		std::cerr << "Incorrect number of results" << std::endl;
+		return -1;
+	}
+
+	for (int i = 0; i < 2999; ++i) {
+		bool present = i % 3 == 0;
+
+		if ((found[i] != view.end()) != present || (contained[i] != 0) != present) {
+			std::cerr << "Key " << keys[i] << (present ? " missing" : " found") << std::endl;
+			return -2;
+		}
+
+		if (present && (found[i]->first != keys[i] || found[i]->second != i / 3)) {
+			std::cerr << "Incorrect pair for key " << keys[i] << std::endl;
+			return -3;
+		}
+	}
+
+	std::vector<avl_map<std::string, int>::iterator> mutable_found = map.find_many(keys.data(), 1);
+	mutable_found[0]->second = -1;
+
+	if (map["key0"] != -1 || !map.find_many(nullptr, 0).empty()) {
+		std::cerr << "Update through find_many not visible" << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_avl_map_copy_clear(int argc, char** argv) {
+	avl_map<int, std::string> map;
+
+	for (int i = 0; i < 100000; ++i) {
+		map.insert({ (i * 7919) % 100000, std::to_string(i) });
+	}
+
+	avl_map<int, std::string> copy(map);
+
+	// Same shape, node for node
+	auto original = map.begin();
+
+	for (auto it = copy.begin(); it != copy.end(); ++it, ++original) {
+		if (original == map.end() || it->first != original->first || it->second != original->second ||
+		    it.height() != original.height() || it.get_balance_factor() != original.get_balance_factor()) {
+			std::cerr << "Copy differs at key " << it->first << std::endl;
+			return -1;
+		}
+	}
+
+	if (original != map.end() || copy.height() != map.height()) {
+		std::cerr << "Copy has a different shape" << std::endl;
+		return -2;
+	}
+
+	// The copy is independent and still rebalances
+	copy[1] = "changed";
+
+	for (int i = 100000; i < 110000; ++i) {
+		copy.insert({ i, std::to_string(i) });
+	}
+
+	for (auto it = copy.begin(); it != copy.end(); ++it) {
+		if (it.unbalanced()) {
+			std::cerr << "Copy unbalanced at key " << it->first << std::endl;
+			return -3;
+		}
+	}
+
+	if (map[1] == "changed" || map.contains(100000)) {
+		std::cerr << "Changing the copy changed the original" << std::endl;
+		return -4;
+	}
+
+	// Cleared maps are empty and reusable
+	map.clear();
+	copy = avl_map<int, std::string>();
+
+	if (map.begin() != map.end() || copy.begin() != copy.end() || avl_map<int, std::string>(map).contains(1)) {
+		std::cerr << "Cleared map is not empty" << std::endl;
+		return -5;
+	}
+
+	map.insert({ 1, "one" });
+
+	if (map[1] != "one") {
+		std::cerr << "Cleared map can't be reused" << std::endl;
+		return -6;
+	}
+
+	return 0;
+}
@@ -0,0 +1,62 @@
+#include "test_common.h"
+
+#include <iostream>
+#include <string>
+
+#include "dsa/bloom_filter.hpp"
+#include "dsa/hash.hpp"
+
+using namespace dsa;
+
+TEST_ENTRYPOINT int test_bloom_filter(int argc, char** argv) {
+	const int count = 20000;
+	const int trials = 200000;
+
+	for (double rate : { 0.1, 0.01, 0.001 }) {
+		bloom_filter<std::string, wyhash> filter(count, rate);
+
+		for (int i = 0; i < count; ++i) {
+			filter.insert("id" + std::to_string(i));
+		}
+
+		// Never a false negative
+		for (int i = 0; i < count; ++i) {
+			if (!filter.contains("id" + std::to_string(i))) {
+				std::cerr << "Inserted key " << i << " was rejected" << std::endl;
+				return -1;
+			}
+		}
+
+		int passed = 0;
+
+		for (int i = 0; i < trials; ++i) {
+			passed += filter.contains("missing" + std::to_string(i)) ? 1 : 0;
+		}
+
+		double measured = static_cast<double>(passed) / trials;
+
+		if (measured > 1.5 * rate) {
+			std::cerr << "False positive rate " << measured << " for a target of " << rate << std::endl;
+			return -2;
+		}
+	}
+
+	// An empty filter rejects everything
+	bloom_filter<std::string, wyhash> empty;
+
+	if (empty.contains("anything")) {
+		std::cerr << "Empty filter accepted a key" << std::endl;
+		return -3;
+	}
+
+	bloom_filter<std::string, wyhash> filter(100, 0.01);
+	filter.insert("key");
+	filter.clear();
+
+	if (filter.contains("key") || filter.size() != 0) {
+		std::cerr << "Cleared filter still holds a key" << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
@@ -0,0 +1,207 @@
+#include "test_common.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include "CSV/CSVStringReader.hpp"
+#include "generator/InventoryGenerator.hpp"
+#include "inventory/Inventory.hpp"
+
+using namespace inventory;
+
+namespace {
+
+/**
+ * @brief Writes text to a new temporary file
+ *
+ * @returns The file's path, empty if it couldn't be written
+ */
+std::string writeTemporary(const std::string& text) {
+	char path[] = "/tmp/pa3_bootstrap_XXXXXX";
+	int fd = ::mkstemp(path);
+
+	if (fd < 0) {
+		return "";
+	}
+
+	::close(fd);
+
+	std::ofstream file(path, std::ios::binary);
+	file << text;
+
+	return file ? path : "";
+}
+
+bool sameNumber(double a, double b) {
+	return a == b || (std::isnan(a) && std::isnan(b));
+}
+
+/**
+ * @brief Compares two inventories product by product and index by index
+ *
+ * @returns A description of the first difference, empty if there is none
+ */
+std::string compare(const Inventory& a, const Inventory& b) {
+	if (a.size() != b.size()) {
+		return "sizes " + std::to_string(a.size()) + " and " + std::to_string(b.size());
+	}
+
+	for (size_t pos = 0; pos < a.size(); ++pos) {
+		const Product& x = a.product(pos);
+		const Product& y = b.product(pos);
+
+		if (x.id != y.id || x.name != y.name || x.brand != y.brand || x.asin != y.asin || x.category != y.category
+		    || !sameNumber(x.price, y.price) || !sameNumber(x.listPrice, y.listPrice) || !sameNumber(x.rating, y.rating)
+		    || !sameNumber(x.quantity, y.quantity) || !sameNumber(x.stock, y.stock) || x.categories != y.categories) {
+			return "product " + x.id;
+		}
+
+		if (b.find(x.id) != &y) {
+			return "id index for " + x.id;
+		}
+	}
+
+	if (a.categoryCount() != b.categoryCount()) {
+		return "category counts";
+	}
+
+	for (size_t category = 0; category < a.categoryCount(); ++category) {
+		if (a.categoryName(category) != b.categoryName(category) || a.categoryMembers(category) != b.categoryMembers(category)) {
+			return "category " + a.categoryName(category);
+		}
+	}
+
+	for (int column = 0; column < NumericColumns::columnCount; ++column) {
+		NumericColumns::Column c = static_cast<NumericColumns::Column>(column);
+
+		if (a.columns().sortOrder(c) != b.columns().sortOrder(c)) {
+			return std::string("sort order of ") + NumericColumns::name(c);
+		}
+	}
+
+	for (const char* query : { "kit", "wooden puzle", "toy set" }) {
+		if (a.search(query, 50) != b.search(query, 50)) {
+			return std::string("search for ") + query;
+		}
+	}
+
+	for (const char* query : { "quality", "easy OR durable", "gift perfect" }) {
+		if (a.searchText(query, 50) != b.searchText(query, 50)) {
+			return std::string("text search for ") + query;
+		}
+	}
+
+	return "";
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_bootstrap_load_file(int argc, char** argv) {
+	// Large enough for every stage to split into several chunks
+	generator::GeneratorOptions options;
+	options.rows = 9000;
+	options.textLength = 200;
+
+	std::ostringstream csv;
+	generator::InventoryGenerator(options).write(csv);
+
+	std::string path = writeTemporary(csv.str());
+
+	if (path.empty()) {
+		std::cerr << "Failed to write a temporary file" << std::endl;
+		return -1;
+	}
+
+	Inventory sequential;
+	Inventory parallel;
+
+	std::vector<LoadStage> stages = sequential.loadFile(path, 1);
+	parallel.loadFile(path, 4);
+	std::remove(path.c_str());
+
+	std::string difference = compare(sequential, parallel);
+
+	if (!difference.empty()) {
+		std::cerr << "Loading on 1 and 4 threads differs in " << difference << std::endl;
+		return -2;
+	}
+
+	if (sequential.size() != options.rows) {
+		std::cerr << "Loaded " << sequential.size() << " products, expected " << options.rows << std::endl;
+		return -3;
+	}
+
+	size_t concurrent = 0;
+
+	for (const LoadStage& stage : stages) {
+		concurrent += stage.concurrent ? 1 : 0;
+
+		if (stage.milliseconds < 0.0) {
+			std::cerr << "Stage " << stage.name << " has a negative time" << std::endl;
+			return -4;
+		}
+	}
+
+	if (stages.front().name != "read" || concurrent < 2) {
+		std::cerr << "Unexpected load stages" << std::endl;
+		return -5;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_bootstrap_matches_load(int argc, char** argv) {
+	// Duplicates, a row without an id, quoted cells and no final line break
+	std::string csv = "Uniq Id,Product Name,Category,Selling Price,About Product\n"
+	                  "a,Kite,Toys | Outdoor,$12.99,\"Flies high, even in light wind\"\n"
+	                  "b,Ball,Outdoor,,Bounces\n"
+	                  "a,Duplicate kite,Toys,$1.00,\n"
+	                  ",No id,Toys,$2.00,\n"
+	                  "\n"
+	                  "c,\"Drum, small\",Music | Toys,\"$1,025.00\",Loud\n"
+	                  "d,Yoyo,Toys,$2.50,Spins";
+
+	std::string path = writeTemporary(csv);
+
+	if (path.empty()) {
+		std::cerr << "Failed to write a temporary file" << std::endl;
+		return -1;
+	}
+
+	Inventory fromFile;
+	fromFile.loadFile(path);
+	std::remove(path.c_str());
+
+	// CSVReader drops a last line without a line break
+	CSV::CSVStringReader reader(csv + "\n");
+	Inventory fromCsv(reader.read());
+
+	std::string difference = compare(fromFile, fromCsv);
+
+	if (!difference.empty()) {
+		std::cerr << "loadFile and load differ in " << difference << std::endl;
+		return -2;
+	}
+
+	if (fromFile.size() != 4 || fromFile.find("a")->name != "Kite" || fromFile.find("c")->price != 1025.0
+	    || fromFile.searchText("wind", 10) != std::vector<size_t>{ 0 }) {
+		std::cerr << "Unexpected products loaded from file" << std::endl;
+		return -3;
+	}
+
+	try {
+		fromFile.loadFile("/nonexistent/inventory.csv");
+		std::cerr << "Loading a missing file should throw" << std::endl;
+		return -4;
+	} catch (const std::runtime_error&) {
+	}
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include "test_common.h"
+
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dsa/concurrent_map.hpp"
+
+using namespace dsa;
+
+TEST_ENTRYPOINT int test_concurrent_map_insert_find(int argc, char** argv) {
+	concurrent_map<std::string, int> map;
+
+	// Enough pairs for several resizes, erasing and updating mid-migration
+	for (int i = 0; i < 10000; ++i) {
+		map.insert("key" + std::to_string(i), i);
+
+		if (i % 3 == 0) {
+			map.erase("key" + std::to_string(i / 2));
+		}
+		if (i % 5 == 0) {
+			map.insert_or_assign("key" + std::to_string(i / 3), -i);
+		}
+	}
+
+	// Replay the same operations on a reference
+	std::vector<int> expected(10000, 0);
+	std::vector<bool> present(10000, false);
+
+	for (int i = 0; i < 10000; ++i) {
+		present[i] = true;
+		expected[i] = i;
+
+		if (i % 3 == 0) {
+			present[i / 2] = false;
+		}
+		if (i % 5 == 0) {
+			present[i / 3] = true;
+			expected[i / 3] = -i;
+		}
+	}
+
+	size_t count = 0;
+
+	for (int i = 0; i < 10000; ++i) {
+		optional<int> found = map.find("key" + std::to_string(i));
+
+		if (found.has_value() != present[i]) {
+			std::cerr << "Key " << i << (present[i] ? " missing" : " not erased") << std::endl;
+			return -1;
+		}
+
+		if (found.has_value() && found.value() != expected[i]) {
+			std::cerr << "Key " << i << " has value " << found.value() << ", expected " << expected[i] << std::endl;
+			return -2;
+		}
+
+		count += present[i];
+	}
+
+	if (map.size() != count) {
+		std::cerr << "Incorrect size " << map.size() << ", expected " << count << std::endl;
+		return -3;
+	}
+
+	if (map.insert("key1", 0)) {
+		std::cerr << "Duplicate key was inserted" << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_concurrent_map_readers(int argc, char** argv) {
+	concurrent_map<int, int> map;
+
+	// Stable keys must be found with the right value throughout
+	const int stable = 1000;
+	for (int i = 0; i < stable; ++i) {
+		map.insert(i, i * 2);
+	}
+
+	std::atomic<bool> done(false);
+	std::atomic<int> errors(0);
+	std::vector<std::thread> readers;
+
+	for (int t = 0; t < 4; ++t) {
+		readers.emplace_back([&, t] {
+			int i = t;
+
+			while (!done.load(std::memory_order_relaxed)) {
+				int key = i++ % stable;
+				optional<int> found = map.find(key);
+
+				if (!found.has_value() || found.value() != key * 2) {
+					errors.fetch_add(1);
+				}
+
+				// Churned keys may or may not exist, but never hold another key's value
+				int churned = stable + i % 50000;
+				found = map.find(churned);
+
+				if (found.has_value() && found.value() != churned && found.value() != -churned) {
+					errors.fetch_add(1);
+				}
+			}
+		});
+	}
+
+	// Grows through many resizes while readers are running
+	for (int i = stable + 100; i < stable + 50000; ++i) {
+		map.insert(i, i);
+		map.insert_or_assign(i - 1, -(i - 1));
+		map.insert_or_assign((i * 7) % stable, ((i * 7) % stable) * 2);
+
+		if (i % 2 == 0) {
+			map.erase(i - 100);
+		}
+	}
+
+	done.store(true);
+
+	for (std::thread& reader : readers) {
+		reader.join();
+	}
+
+	if (errors.load() != 0) {
+		std::cerr << errors.load() << " lookups returned incorrect results" << std::endl;
+		return -1;
+	}
+
+	if (!map.reclaim() && !map.reclaim()) {
+		std::cerr << "Retired memory not reclaimed without readers" << std::endl;
+		return -2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,202 @@
+#include "test_common.h"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "epoch_domain.hpp"
+
+namespace {
+
+std::atomic<int> freed(0);
+
+/**
+ * @brief Counts its destruction, and poisons itself so a reader can tell
+ */
+struct tracked {
+	explicit tracked(int value) : value(value), alive(true) {}
+	~tracked() {
+		alive.store(false);
+		freed.fetch_add(1);
+	}
+
+	int value;
+	std::atomic<bool> alive;
+};
+
+} // namespace
+
+TEST_ENTRYPOINT int test_epoch_domain_retire(int argc, char** argv) {
+	freed.store(0);
+
+	{
+		epoch_domain domain(1000);
+
+		// Nothing is freed while the retiring thread is pinned, nested or not
+		{
+			epoch_domain::guard outer(domain);
+			epoch_domain::guard inner(domain);
+
+			for (int i = 0; i < 10; ++i) {
+				domain.retire(new tracked(i));
+			}
+
+			for (int i = 0; i < 5; ++i) {
+				domain.reclaim();
+			}
+
+			if (freed.load() != 0 || domain.pending() != 10) {
+				std::cerr << "Freed " << freed.load() << " while pinned" << std::endl;
+				return -1;
+			}
+		}
+
+		// Two epochs later, everything is
+		bool done = false;
+
+		for (int i = 0; i < 3 && !done; ++i) {
+			done = domain.reclaim();
+		}
+
+		if (!done || freed.load() != 10 || domain.pending() != 0) {
+			std::cerr << "Freed " << freed.load() << " of 10 after unpinning" << std::endl;
+			return -2;
+		}
+
+		// Retired by a thread that exits before it could free them
+		std::thread([&domain] {
+			for (int i = 0; i < 5; ++i) {
+				domain.retire(new tracked(i));
+			}
+		}).join();
+
+		// Still waiting though the calling thread retired nothing
+		if (domain.reclaim()) {
+			std::cerr << "Reclaimed with an exited thread's pointers still waiting" << std::endl;
+			return -6;
+		}
+
+		for (int i = 0; i < 3; ++i) {
+			domain.quiescent();
+		}
+
+		if (freed.load() != 15) {
+			std::cerr << "Freed " << freed.load() - 10 << " of 5 left by an exited thread" << std::endl;
+			return -3;
+		}
+
+		// A pinned thread holds back the epoch for everyone
+		std::atomic<bool> pinned(false);
+		std::atomic<bool> release(false);
+
+		std::thread reader([&] {
+			epoch_domain::guard guard(domain);
+			pinned.store(true);
+
+			while (!release.load()) {
+				std::this_thread::yield();
+			}
+		});
+
+		while (!pinned.load()) {
+			std::this_thread::yield();
+		}
+
+		domain.retire(new tracked(0));
+
+		for (int i = 0; i < 5; ++i) {
+			domain.reclaim();
+		}
+
+		bool held = freed.load() == 15;
+
+		release.store(true);
+		reader.join();
+
+		if (!held) {
+			std::cerr << "Freed while another thread was pinned" << std::endl;
+			return -4;
+		}
+
+		// Whatever is still retired goes with the domain
+		domain.retire(new tracked(0));
+	}
+
+	if (freed.load() != 17) {
+		std::cerr << "Destroying the domain freed " << freed.load() - 15 << " of 2" << std::endl;
+		return -5;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_epoch_domain_stress(int argc, char** argv) {
+	freed.store(0);
+
+	const int replacements = 20000;
+	epoch_domain domain(16);
+	std::atomic<tracked*> current(new tracked(0));
+	std::atomic<bool> done(false);
+	std::atomic<int> errors(0);
+	std::vector<std::thread> readers;
+
+	for (int t = 0; t < 4; ++t) {
+		readers.emplace_back([&] {
+			int last = 0;
+
+			while (!done.load(std::memory_order_relaxed)) {
+				epoch_domain::guard guard(domain);
+				tracked* node = current.load(std::memory_order_acquire);
+
+				// Still alive however long it is held, values only grow
+				for (int i = 0; i < 10; ++i) {
+					if (!node->alive.load(std::memory_order_relaxed) || node->value < last) {
+						errors.fetch_add(1);
+					}
+				}
+
+				last = node->value;
+			}
+
+			// Readers also retire, each thread keeps its own lists
+			domain.retire(new tracked(-1));
+		});
+	}
+
+	for (int i = 1; i <= replacements; ++i) {
+		tracked* replaced = current.exchange(new tracked(i), std::memory_order_acq_rel);
+		domain.retire(replaced);
+
+		if (i % 1000 == 0) {
+			domain.quiescent();
+		}
+	}
+
+	done.store(true);
+
+	for (std::thread& reader : readers) {
+		reader.join();
+	}
+
+	if (errors.load() != 0) {
+		std::cerr << errors.load() << " reads of freed or stale nodes" << std::endl;
+		return -1;
+	}
+
+	bool done_freeing = false;
+
+	for (int i = 0; i < 3 && !done_freeing; ++i) {
+		done_freeing = domain.reclaim();
+	}
+
+	// The readers' own retired nodes were left to the domain as they exited
+	if (!done_freeing || freed.load() != replacements + 4) {
+		std::cerr << "Freed " << freed.load() << " of " << replacements + 4 << std::endl;
+		return -2;
+	}
+
+	delete current.load();
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+#include "test_common.h"
+
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "CSV/CSVStringReader.hpp"
+#include "inventory/Commands.hpp"
+#include "inventory/Filter.hpp"
+#include "inventory/Inventory.hpp"
+#include "inventory/Scan.hpp"
+
+using namespace inventory;
+
+namespace {
+
+bool expected(double value, CompareOp op, double operand) {
+	switch (op) {
+	case CompareOp::less: return value < operand;
+	case CompareOp::lessEqual: return value <= operand;
+	case CompareOp::greater: return value > operand;
+	case CompareOp::greaterEqual: return value >= operand;
+	case CompareOp::equal: return value == operand;
+	default: return value != operand;
+	}
+}
+
+Product priced(const std::string& id, double price, double rating, double stock) {
+	Product product;
+	product.id = id;
+	product.name = "Product " + id;
+	product.price = price;
+	product.rating = rating;
+	product.stock = stock;
+	return product;
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_scan_kernels(int argc, char** argv) {
+	std::mt19937 random(3);
+	std::vector<double> values(1000);
+
+	// Few distinct values so equality matches, with some NaN
+	for (double& value : values) {
+		value = (random() % 10 == 0) ? std::numeric_limits<double>::quiet_NaN() : static_cast<double>(random() % 8);
+	}
+
+	const CompareOp ops[] = { CompareOp::less, CompareOp::lessEqual, CompareOp::greater,
+	                          CompareOp::greaterEqual, CompareOp::equal, CompareOp::notEqual };
+	std::vector<ScanIsa> isas = { ScanIsa::scalar };
+
+	if (bestScanIsa() != ScanIsa::scalar) {
+		isas.push_back(ScanIsa::sse2);
+	}
+
+	if (bestScanIsa() == ScanIsa::avx2) {
+		isas.push_back(ScanIsa::avx2);
+	}
+
+	// Counts around whole words, to exercise the tails
+	for (size_t count : { 0, 1, 63, 64, 65, 130, 1000 }) {
+		for (CompareOp op : ops) {
+			for (ScanIsa isa : isas) {
+				std::vector<uint64_t> selection(selectionWords(count), ~0ull);
+				compareScan(isa, values.data(), count, op, 4.0, selection.data());
+
+				for (size_t i = 0; i < selection.size() * 64; ++i) {
+					bool bit = (selection[i / 64] >> (i % 64)) & 1;
+
+					if (bit != (i < count && expected(values[i], op, 4.0))) {
+						std::cerr << scanIsaName(isa) << " scan of " << count << " values wrong at " << i << std::endl;
+						return -1;
+					}
+				}
+			}
+		}
+	}
+
+	std::vector<uint64_t> a = { 0xff00, 0x1 };
+	std::vector<uint64_t> b = { 0x0ff0, 0x3 };
+
+	selectionAnd(a.data(), b.data(), 2);
+
+	if (a[0] != 0x0f00 || a[1] != 0x1 || selectionCount(a.data(), 2) != 5) {
+		std::cerr << "Incorrect selection AND or count" << std::endl;
+		return -2;
+	}
+
+	selectionOr(a.data(), b.data(), 2);
+
+	if (a[0] != 0x0ff0 || a[1] != 0x3) {
+		std::cerr << "Incorrect selection OR" << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_filter_select(int argc, char** argv) {
+	Inventory inventory;
+	std::mt19937 random(5);
+
+	// More than one block of rows
+	for (size_t i = 0; i < 40000; ++i) {
+		double price = (random() % 100) + 0.99;
+		double rating = (random() % 5 == 0) ? std::numeric_limits<double>::quiet_NaN() : 1.0 + random() % 5;
+		inventory.add(priced(std::to_string(i), price, rating, random() % 50));
+	}
+
+	const char* filter = "price < 20 and rating >= 4 OR stock = 0 and price>=90";
+	std::vector<uint64_t> selection = inventory.select(Filter(filter));
+
+	for (size_t pos = 0; pos < inventory.size(); ++pos) {
+		const Product& p = inventory.product(pos);
+		bool match = (p.price < 20 && p.rating >= 4) || (p.stock == 0 && p.price >= 90);
+		bool selected = (selection[pos / 64] >> (pos % 64)) & 1;
+
+		if (match != selected) {
+			std::cerr << "Filter \"" << filter << "\" wrong for product " << pos << std::endl;
+			return -1;
+		}
+	}
+
+	// Missing ratings match only !=
+	size_t unrated = 0;
+
+	for (const Product& p : inventory.products()) {
+		unrated += std::isnan(p.rating);
+	}
+
+	std::vector<uint64_t> rated = inventory.select(Filter("rating >= 0"));
+
+	if (selectionCount(rated.data(), rated.size()) != inventory.size() - unrated) {
+		std::cerr << "Missing values were selected" << std::endl;
+		return -2;
+	}
+
+	for (const char* invalid : { "", "price <", "price < 20 and", "weight > 1", "price ~ 2", "price < x", "price < 1 xor stock > 2" }) {
+		try {
+			Filter parsed(invalid);
+			std::cerr << "Filter \"" << invalid << "\" parsed" << std::endl;
+			return -3;
+		} catch (const std::invalid_argument&) {
+		}
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_filter_command(int argc, char** argv) {
+	CSV::CSVStringReader reader("Uniq Id,Product Name,Selling Price,Rating,Stock\n"
+	                            "a,Kite,$12.99,4.5,3\n"
+	                            "b,Ball,$25.00,4.8,\n"
+	                            "c,Cable,$5.49,3.9,10\n"
+	                            "d,Drum,$8.00,,0\n");
+
+	Inventory inventory;
+	inventory.load(reader.read());
+
+	std::ostringstream out;
+	whereCommand(inventory, "price < 20 and rating >= 4 or stock = 0", out);
+
+	if (out.str() != "a: Kite\nd: Drum\n2 matching products\n") {
+		std::cerr << "Unexpected where output: " << out.str() << std::endl;
+		return -1;
+	}
+
+	out.str("");
+	whereCommand(inventory, "price > 1 limit 1", out);
+
+	if (out.str() != "a: Kite\n4 matching products\n") {
+		std::cerr << "Unexpected where output with a limit: " << out.str() << std::endl;
+		return -2;
+	}
+
+	out.str("");
+	whereCommand(inventory, "colour = 3", out);
+
+	if (out.str().rfind("Invalid filter: ", 0) != 0) {
+		std::cerr << "Unexpected output for an invalid filter: " << out.str() << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
@@ -0,0 +1,253 @@
+#include "test_common.h"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dsa/avl_map.hpp"
+#include "dsa/frozen_map.hpp"
+#include "dsa/frozen_ordered_map.hpp"
+#include "dsa/hash.hpp"
+#include "dsa/perfect_hash.hpp"
+#include "dsa/unordered_map.hpp"
+
+using namespace dsa;
+
+TEST_ENTRYPOINT int test_perfect_hash(int argc, char** argv) {
+	for (size_t n : { 0, 1, 2, 3, 100, 5000, 200000 }) {
+		std::vector<uint64_t> hashes;
+
+		for (size_t i = 0; i < n; ++i) {
+			hashes.push_back(wyhash{}(std::to_string(i)));
+		}
+
+		perfect_hash<std::string, wyhash> phf;
+		phf.build(hashes);
+
+		// Every key gets a distinct slot below n
+		std::vector<bool> used(n, false);
+
+		for (size_t i = 0; i < n; ++i) {
+			size_t slot = phf(std::to_string(i));
+
+			if (slot >= n || used[slot]) {
+				std::cerr << "Key " << i << " of " << n << " got slot " << slot << std::endl;
+				return -1;
+			}
+
+			used[slot] = true;
+		}
+
+		if (n >= 5000 && phf.bits_per_key() > 8.0) {
+			std::cerr << "Index uses " << phf.bits_per_key() << " bits per key for " << n << " keys" << std::endl;
+			return -2;
+		}
+	}
+
+	perfect_hash<std::string, wyhash> phf;
+
+	try {
+		phf.build({ 1, 2, 3, 2 });
+		std::cerr << "Duplicate hashes were accepted" << std::endl;
+		return -3;
+	} catch (const std::invalid_argument&) {
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_frozen_map(int argc, char** argv) {
+	unordered_map<std::string, int, wyhash> source;
+
+	for (int i = 0; i < 10000; ++i) {
+		source.insert({ "id" + std::to_string(i), i });
+	}
+
+	frozen_map<std::string, int, wyhash> map(source.begin(), source.end());
+
+	if (map.size() != source.size()) {
+		std::cerr << "Frozen map has " << map.size() << " pairs" << std::endl;
+		return -1;
+	}
+
+	for (int i = 0; i < 10000; ++i) {
+		if (map["id" + std::to_string(i)] != i) {
+			std::cerr << "Wrong value for key " << i << std::endl;
+			return -2;
+		}
+
+		if (map.contains("missing" + std::to_string(i))) {
+			std::cerr << "Found key that was never inserted" << std::endl;
+			return -3;
+		}
+	}
+
+	try {
+		map["missing"];
+		std::cerr << "operator[] did not throw on missing key" << std::endl;
+		return -4;
+	} catch (const std::invalid_argument&) {
+	}
+
+	// Round trip through a stream
+	std::stringstream stream;
+	map.save(stream);
+
+	frozen_map<std::string, int, wyhash> loaded;
+	loaded.load(stream);
+
+	if (loaded.size() != map.size()) {
+		std::cerr << "Loaded map has " << loaded.size() << " pairs" << std::endl;
+		return -5;
+	}
+
+	long sum = 0;
+
+	for (const auto& pair : loaded) {
+		if (map[pair.first] != pair.second) {
+			std::cerr << "Loaded map has wrong value for " << pair.first << std::endl;
+			return -6;
+		}
+
+		sum += pair.second;
+	}
+
+	if (sum != 10000L * 9999 / 2) {
+		std::cerr << "Iteration did not visit every pair" << std::endl;
+		return -7;
+	}
+
+	// Truncated data is rejected and leaves the map empty
+	std::string data = stream.str();
+	std::stringstream truncated(data.substr(0, data.size() / 2));
+
+	try {
+		loaded.load(truncated);
+		std::cerr << "Truncated data was accepted" << std::endl;
+		return -8;
+	} catch (const std::runtime_error&) {
+	}
+
+	if (!loaded.empty() || loaded.contains("id1")) {
+		std::cerr << "Failed load left pairs behind" << std::endl;
+		return -9;
+	}
+
+	// Duplicate keys cannot be frozen
+	std::vector<std::pair<std::string, int>> duplicates = { { "a", 1 }, { "b", 2 }, { "a", 3 } };
+
+	try {
+		frozen_map<std::string, int, wyhash> bad(duplicates.begin(), duplicates.end());
+		std::cerr << "Duplicate keys were accepted" << std::endl;
+		return -10;
+	} catch (const std::invalid_argument&) {
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_frozen_ordered_map(int argc, char** argv) {
+	// Sizes around full trees, keys sharing more than the 8 byte prefix
+	for (size_t n : { 0, 1, 2, 3, 7, 8, 9, 1000, 5000 }) {
+		avl_map<std::string, int> tree;
+
+		for (size_t i = 0; i < n; ++i) {
+			tree.insert({ "shared-prefix-" + std::to_string(i * 2), static_cast<int>(i) });
+		}
+
+		frozen_ordered_map<std::string, int> map(tree.begin(), tree.end());
+		std::vector<std::string> sorted;
+
+		for (const auto& pair : tree) {
+			sorted.push_back(pair.first);
+		}
+
+		if (map.size() != n || !std::equal(sorted.begin(), sorted.end(), map.begin(),
+		                                   [](const std::string& key, const std::pair<std::string, int>& pair) {
+			                                   return key == pair.first;
+		                                   })) {
+			std::cerr << "Frozen map of " << n << " pairs iterates out of order" << std::endl;
+			return -1;
+		}
+
+		std::vector<std::string> probes = { "", "a", "shared-prefix-", "zzz" };
+
+		for (size_t i = 0; i < 2 * n + 2; ++i) {
+			probes.push_back("shared-prefix-" + std::to_string(i));
+		}
+
+		for (const std::string& probe : probes) {
+			size_t lower = std::lower_bound(sorted.begin(), sorted.end(), probe) - sorted.begin();
+			size_t upper = std::upper_bound(sorted.begin(), sorted.end(), probe) - sorted.begin();
+			bool present = lower != upper;
+
+			if (static_cast<size_t>(map.lower_bound(probe) - map.begin()) != lower ||
+			    static_cast<size_t>(map.upper_bound(probe) - map.begin()) != upper) {
+				std::cerr << "Wrong bounds for " << probe << " in " << n << " pairs" << std::endl;
+				return -2;
+			}
+
+			if (map.contains(probe) != present || (present && map[probe] != tree[probe])) {
+				std::cerr << "Wrong lookup for " << probe << " in " << n << " pairs" << std::endl;
+				return -3;
+			}
+		}
+	}
+
+	// Prefixes that tie, down to a trailing zero byte
+	std::vector<std::pair<std::string, int>> tied = {
+		{ "ab", 1 }, { std::string("ab\0", 3), 2 }, { "abcdefgh", 3 }, { "abcdefghi", 4 }, { "\xff", 5 }
+	};
+
+	frozen_ordered_map<std::string, int> tiedMap(tied.begin(), tied.end());
+
+	for (const auto& pair : tied) {
+		if (tiedMap[pair.first] != pair.second) {
+			std::cerr << "Wrong value for a key with a tied prefix" << std::endl;
+			return -4;
+		}
+	}
+
+	if (tiedMap.begin()->first != "ab" || (--tiedMap.end())->first != "\xff" || tiedMap.contains("abcdefg")) {
+		std::cerr << "Keys with tied prefixes are out of order" << std::endl;
+		return -5;
+	}
+
+	// Unsorted ranges are sorted first
+	std::vector<std::pair<int, int>> unsorted;
+
+	for (int i = 0; i < 3000; ++i) {
+		unsorted.push_back({ (i * 7919) % 3000, i });
+	}
+
+	frozen_ordered_map<int, int> numbers(unsorted.begin(), unsorted.end());
+	int expected = 0;
+
+	for (const auto& pair : numbers) {
+		if (pair.first != expected++ || unsorted[pair.second].first != pair.first) {
+			std::cerr << "Unsorted range was not sorted" << std::endl;
+			return -6;
+		}
+	}
+
+	if (numbers.lower_bound(-5) != numbers.begin() || numbers.upper_bound(2999) != numbers.end() ||
+	    numbers.find(3000) != numbers.end()) {
+		std::cerr << "Wrong bounds past the ends" << std::endl;
+		return -7;
+	}
+
+	std::vector<std::pair<int, int>> duplicates = { { 2, 1 }, { 1, 2 }, { 2, 3 } };
+
+	try {
+		frozen_ordered_map<int, int> bad(duplicates.begin(), duplicates.end());
+		std::cerr << "Duplicate keys were accepted" << std::endl;
+		return -8;
+	} catch (const std::invalid_argument&) {
+	}
+
+	return 0;
+}
@@ -0,0 +1,132 @@
+#include "test_common.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "CSV/CSVStringReader.hpp"
+#include "generator/InventoryGenerator.hpp"
+#include "inventory/Commands.hpp"
+#include "inventory/Inventory.hpp"
+
+TEST_ENTRYPOINT int test_generator_parse(int argc, char** argv) {
+	generator::GeneratorOptions options;
+	options.rows = 500;
+	options.categories = 50;
+	options.textLength = 100;
+
+	generator::InventoryGenerator gen(options);
+	std::ostringstream out;
+	gen.write(out);
+
+	CSV::CSVStringReader reader(out.str());
+	CSV::CSVData csv = reader.read();
+
+	if (csv.rows().size() != options.rows) {
+		std::cerr << "Parsed " << csv.rows().size() << " rows, expected " << options.rows << std::endl;
+		return -1;
+	}
+
+	// Quoted commas and escaped quotes must not split fields
+	size_t columns = csv.header().tokens().size();
+
+	for (const CSV::CSVTuple& row : csv.rows()) {
+		if (row.values().size() != columns) {
+			std::cerr << "Row has " << row.values().size() << " fields, expected " << columns << std::endl;
+			return -2;
+		}
+	}
+
+	inventory::Inventory inv(csv);
+
+	for (size_t row = 0; row < options.rows; ++row) {
+		const inventory::Product* product = inv.find(gen.id(row));
+
+		if (product == nullptr) {
+			std::cerr << "Generated id of row " << row << " not found" << std::endl;
+			return -3;
+		}
+
+		if (product->category != gen.categoryPath(gen.categoryOf(row))) {
+			std::cerr << "Row " << row << " has category " << product->category << std::endl;
+			return -4;
+		}
+	}
+
+	if (inv.find(gen.missingId(0)) != nullptr) {
+		std::cerr << "Missing id was found" << std::endl;
+		return -5;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_generator_deterministic(int argc, char** argv) {
+	generator::GeneratorOptions options;
+	options.rows = 100;
+
+	std::ostringstream first, second, partial;
+
+	generator::InventoryGenerator(options).write(first);
+	generator::InventoryGenerator(options).write(second);
+
+	if (first.str() != second.str()) {
+		std::cerr << "Same seed produced different output" << std::endl;
+		return -1;
+	}
+
+	// Rows are independent, generating a range matches the full output
+	generator::InventoryGenerator gen(options);
+	gen.writeHeader(partial);
+	gen.writeRows(partial, 0, 40);
+	gen.writeRows(partial, 40, 100);
+
+	if (partial.str() != first.str()) {
+		std::cerr << "Generating in ranges produced different output" << std::endl;
+		return -2;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_generator_trace(int argc, char** argv) {
+	generator::GeneratorOptions options;
+	options.rows = 300;
+	options.categories = 40;
+
+	generator::TraceOptions traceOptions;
+	traceOptions.queries = 1000;
+	traceOptions.hitRatio = 0.5;
+
+	generator::InventoryGenerator gen(options);
+	std::ostringstream csvOut, traceOut;
+	gen.write(csvOut);
+	generator::writeQueryTrace(gen, traceOptions, traceOut);
+
+	CSV::CSVStringReader reader(csvOut.str());
+	inventory::Inventory inv(reader.read());
+
+	std::istringstream trace(traceOut.str());
+	std::string line;
+	size_t queries = 0, hits = 0;
+
+	while (std::getline(trace, line)) {
+		++queries;
+
+		if (line.rfind("find ", 0) == 0) {
+			hits += inv.find(inventory::commandArgument(line, "find")) != nullptr;
+		} else if (line.rfind("listInventory ", 0) == 0) {
+			hits += inv.category(inventory::commandArgument(line, "listInventory")) != nullptr;
+		} else {
+			std::cerr << "Unexpected trace line " << line << std::endl;
+			return -1;
+		}
+	}
+
+	if (queries != traceOptions.queries || hits < 400 || hits > 600) {
+		std::cerr << queries << " queries with " << hits << " hits" << std::endl;
+		return -2;
+	}
+
+	return 0;
+}
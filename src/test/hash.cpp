@@ -0,0 +1,74 @@
+#include "test_common.h"
+
+#include <iostream>
+#include <set>
+#include <string>
+
+#include "dsa/hash.hpp"
+#include "dsa/unordered_map.hpp"
+
+using namespace dsa;
+
+TEST_ENTRYPOINT int test_wyhash(int argc, char** argv) {
+	wyhash hasher;
+	std::string key = "B07G5S6S4D";
+
+	if (hasher(key) != hasher(std::string(key)) || hasher(key) != hasher(key.c_str())) {
+		std::cerr << "Hash is not deterministic" << std::endl;
+		return -1;
+	}
+
+	// Every length path, including the empty key, gives distinct hashes
+	std::set<size_t> hashes;
+	std::string text;
+
+	for (int length = 0; length <= 200; ++length) {
+		hashes.insert(hasher(text));
+		text += static_cast<char>('a' + length % 26);
+	}
+
+	if (hashes.size() != 201) {
+		std::cerr << "Prefixes of a string collided, " << hashes.size() << " distinct hashes" << std::endl;
+		return -2;
+	}
+
+	// Flipping one bit should flip about half the bits of the hash
+	size_t flipped = 0;
+	size_t trials = 0;
+
+	for (int length : { 3, 8, 10, 16, 32, 64 }) {
+		std::string base(length, 'x');
+
+		for (int pos = 0; pos < length; ++pos) {
+			for (int bit = 0; bit < 8; ++bit) {
+				std::string changed = base;
+				changed[pos] ^= static_cast<char>(1 << bit);
+
+				flipped += __builtin_popcountll(hasher(base) ^ hasher(changed));
+				++trials;
+			}
+		}
+	}
+
+	double average = static_cast<double>(flipped) / trials;
+
+	if (average < 28.0 || average > 36.0) {
+		std::cerr << "Poor avalanche, " << average << " of 64 bits flipped on average" << std::endl;
+		return -3;
+	}
+
+	unordered_map<std::string, int, wyhash> map;
+
+	for (int i = 0; i < 1000; ++i) {
+		map.insert({ std::to_string(i), i });
+	}
+
+	for (int i = 0; i < 1000; ++i) {
+		if (map[std::to_string(i)] != i) {
+			std::cerr << "Missing key " << i << " in map using wyhash" << std::endl;
+			return -4;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,126 @@
+#include "test_common.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "inventory/Commands.hpp"
+#include "inventory/Inventory.hpp"
+#include "inventory/NameIndex.hpp"
+
+using namespace inventory;
+
+namespace {
+
+Product named(const std::string& id, const std::string& name) {
+	Product product;
+	product.id = id;
+	product.name = name;
+	product.price = 0.0;
+	return product;
+}
+
+std::vector<Product> sampleProducts() {
+	return {
+		named("0", "Wireless Bluetooth Headphones, Black"),
+		named("1", "LEGO Classic Creative Bricks"),
+		named("2", "Wire Cutters 6\" Inch"),
+		named("3", "Wireless Mouse"),
+		named("4", "Magnetic Puzzle Cube"),
+		named("5", "Headphone Stand"),
+	};
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_name_index_search(int argc, char** argv) {
+	std::vector<Product> products = sampleProducts();
+	NameIndex index;
+	index.build(products);
+
+	// An exact word ranks before words it is a prefix of
+	std::vector<size_t> wire = index.search(products, "wire", 10);
+
+	if (wire.size() < 3 || wire[0] != 2) {
+		std::cerr << "Prefix search for wire returned " << wire.size() << " products" << std::endl;
+		return -1;
+	}
+
+	// Every word must match, in any order and case
+	std::vector<size_t> both = index.search(products, "MOUSE wirel", 10);
+
+	if (both.empty() || both[0] != 3) {
+		std::cerr << "Multi-word search did not find the wireless mouse" << std::endl;
+		return -2;
+	}
+
+	// Misspelled words fall back to trigram matches
+	std::vector<size_t> typo = index.search(products, "headphnes", 10);
+
+	if (typo.empty() || typo[0] != 0) {
+		std::cerr << "Typo search did not find the headphones" << std::endl;
+		return -3;
+	}
+
+	// Short words are corrected too, here a transposition
+	std::vector<size_t> swapped = index.search(products, "lgeo bricks", 10);
+
+	if (swapped.size() != 1 || swapped[0] != 1) {
+		std::cerr << "Transposed search did not find the bricks" << std::endl;
+		return -7;
+	}
+
+	if (editDistance("headphnes", "headphones", 2) != 1 || editDistance("abc", "xyz", 1) != 2) {
+		std::cerr << "Incorrect edit distance" << std::endl;
+		return -8;
+	}
+
+	if (index.search(products, "wire", 1).size() != 1 || !index.search(products, "  ", 10).empty()) {
+		std::cerr << "Limit or empty search not respected" << std::endl;
+		return -4;
+	}
+
+	if (!index.search(products, "zzzzzz", 10).empty()) {
+		std::cerr << "Unrelated search matched" << std::endl;
+		return -5;
+	}
+
+	// Products added after the build are still found
+	products.push_back(named("6", "Puzzle Mat"));
+
+	std::vector<size_t> mat = index.search(products, "puzzle mat", 10);
+
+	if (mat.empty() || mat[0] != 6) {
+		std::cerr << "Product added after the build was not found" << std::endl;
+		return -6;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_name_index_command(int argc, char** argv) {
+	Inventory inventory;
+
+	for (Product& product : sampleProducts()) {
+		inventory.add(product);
+	}
+
+	std::ostringstream out;
+	searchCommand(inventory, "wireless limit 1", out);
+
+	if (out.str() != "0: Wireless Bluetooth Headphones, Black\n") {
+		std::cerr << "Unexpected search output: " << out.str() << std::endl;
+		return -1;
+	}
+
+	out.str("");
+	searchCommand(inventory, "qqqq", out);
+
+	if (out.str() != "No matching products\n") {
+		std::cerr << "Unexpected output for no matches: " << out.str() << std::endl;
+		return -2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,140 @@
+#include "test_common.h"
+
+#include <fcntl.h>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include "output_buffer.hpp"
+
+namespace {
+
+/**
+ * @brief Reads everything written to a pipe so far
+ */
+std::string drain(int fd) {
+	std::string data;
+	char chunk[4096];
+	ssize_t size;
+
+	while ((size = ::read(fd, chunk, sizeof(chunk))) > 0) {
+		data.append(chunk, size);
+	}
+
+	return data;
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_output_buffer(int argc, char** argv) {
+	int fds[2];
+
+	if (::pipe(fds) != 0 || ::fcntl(fds[0], F_SETFL, O_NONBLOCK) != 0) {
+		std::cerr << "Failed to create a pipe" << std::endl;
+		return -1;
+	}
+
+	std::string expected;
+
+	{
+		output_buffer buffer(fds[1], 256);
+		std::ostream out(&buffer);
+
+		// Lines are held until the buffer fills
+		for (int i = 0; i < 10; ++i) {
+			out << "line " << i << '\n';
+			expected += "line " + std::to_string(i) + '\n';
+		}
+
+		if (buffer.writes() != 0 || !drain(fds[0]).empty()) {
+			std::cerr << "Output was written before flushing" << std::endl;
+			return -2;
+		}
+
+		out << std::flush;
+
+		if (buffer.writes() != 1 || drain(fds[0]) != expected) {
+			std::cerr << "Flushing should write the lines at once" << std::endl;
+			return -3;
+		}
+
+		// Filling the buffer writes it, longer strings are written directly
+		expected.clear();
+
+		for (int i = 0; i < 100; ++i) {
+			out << "product " << i << ": a name\n";
+			expected += "product " + std::to_string(i) + ": a name\n";
+		}
+
+		std::string longLine(1000, 'x');
+		out << longLine;
+		expected += longLine;
+		out << "last";
+		expected += "last";
+
+		if (buffer.writes() > 1 + (expected.size() / 256) + 2) {
+			std::cerr << "Made " << buffer.writes() << " writes for " << expected.size() << " bytes" << std::endl;
+			return -4;
+		}
+	}
+
+	// The rest is flushed when destroyed
+	if (drain(fds[0]) != expected) {
+		std::cerr << "Output was lost or reordered" << std::endl;
+		return -5;
+	}
+
+	::close(fds[0]);
+	::close(fds[1]);
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_output_buffer_input_pending(int argc, char** argv) {
+	int fds[2];
+
+	if (::pipe(fds) != 0) {
+		std::cerr << "Failed to create a pipe" << std::endl;
+		return -1;
+	}
+
+	std::istringstream empty;
+
+	if (input_pending(empty, fds[0])) {
+		std::cerr << "Empty pipe reported as pending" << std::endl;
+		return -2;
+	}
+
+	if (::write(fds[1], "find a\n", 7) != 7 || !input_pending(empty, fds[0])) {
+		std::cerr << "Written pipe not reported as pending" << std::endl;
+		return -3;
+	}
+
+	// Characters the stream already buffered count too
+	int other[2];
+
+	if (::pipe(other) != 0) {
+		std::cerr << "Failed to create a pipe" << std::endl;
+		return -4;
+	}
+
+	std::istringstream buffered("find b\n");
+
+	if (!input_pending(buffered, other[0])) {
+		std::cerr << "Buffered stream not reported as pending" << std::endl;
+		return -5;
+	}
+
+	// At end of input reading doesn't block either
+	::close(other[1]);
+
+	if (!input_pending(empty, other[0])) {
+		std::cerr << "Closed pipe not reported as pending" << std::endl;
+		return -6;
+	}
+
+	::close(other[0]);
+	::close(fds[0]);
+	::close(fds[1]);
+	return 0;
+}
@@ -0,0 +1,195 @@
+#include "test_common.h"
+
+#include <atomic>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dsa/persistent_avl_map.hpp"
+
+using namespace dsa;
+
+namespace {
+
+/**
+ * @brief Checks a version holds exactly the reference's pairs, in order,
+ * and is within the AVL height bound
+ */
+bool matches(const persistent_avl_map<int, std::string>& map, const std::map<int, std::string>& expected) {
+	if (map.size() != expected.size()) {
+		return false;
+	}
+
+	auto pair = expected.begin();
+
+	for (const auto& actual : map) {
+		if (pair == expected.end() || actual.first != pair->first || actual.second != pair->second) {
+			return false;
+		}
+
+		++pair;
+	}
+
+	return pair == expected.end() && map.height() <= 1.45 * std::log2(expected.size() + 2);
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_persistent_avl_map(int argc, char** argv) {
+	persistent_avl_map<int, std::string> map;
+	std::map<int, std::string> expected;
+
+	// Every 1000 operations, keep the version with its expected contents
+	std::vector<persistent_avl_map<int, std::string>> versions;
+	std::vector<std::map<int, std::string>> snapshots;
+
+	for (int i = 0; i < 20000; ++i) {
+		int key = (i * 7919) % 5000;
+
+		if (i % 3 == 2) {
+			if (map.erase(key) != expected.erase(key)) {
+				std::cerr << "Erase of " << key << " disagrees" << std::endl;
+				return -1;
+			}
+		} else if (i % 5 == 0) {
+			bool inserted = expected.find(key) == expected.end();
+			expected[key] = "assigned" + std::to_string(i);
+
+			if (map.insert_or_assign({ key, "assigned" + std::to_string(i) }) != inserted) {
+				std::cerr << "Assignment to " << key << " disagrees" << std::endl;
+				return -2;
+			}
+		} else if (map.insert({ key, std::to_string(i) }) != expected.insert({ key, std::to_string(i) }).second) {
+			std::cerr << "Insert of " << key << " disagrees" << std::endl;
+			return -3;
+		}
+
+		if (i % 1000 == 0) {
+			versions.push_back(map);
+			snapshots.push_back(expected);
+		}
+	}
+
+	// Later writes left every earlier version as it was
+	for (size_t v = 0; v < versions.size(); ++v) {
+		if (!matches(versions[v], snapshots[v])) {
+			std::cerr << "Version " << v << " changed or is unbalanced" << std::endl;
+			return -4;
+		}
+	}
+
+	if (!matches(map, expected)) {
+		std::cerr << "Latest version differs or is unbalanced" << std::endl;
+		return -5;
+	}
+
+	for (int key = -1; key <= 5001; ++key) {
+		auto lower = expected.lower_bound(key);
+		auto it = map.lower_bound(key);
+
+		if ((it == map.end()) != (lower == expected.end()) || (it != map.end() && it->first != lower->first)) {
+			std::cerr << "Wrong lower bound for " << key << std::endl;
+			return -6;
+		}
+
+		if (map.contains(key) != (expected.count(key) != 0)) {
+			std::cerr << "Wrong lookup for " << key << std::endl;
+			return -7;
+		}
+	}
+
+	// A write copies only the path to its key, other pairs stay shared
+	persistent_avl_map<int, std::string> copy(map);
+
+	if (!copy.same_version(map)) {
+		std::cerr << "Copy is a different version" << std::endl;
+		return -8;
+	}
+
+	int untouched = map.begin()->first;
+	int written = (--expected.end())->first;
+	copy.insert_or_assign({ written, "changed" });
+
+	if (copy.same_version(map) || &*copy.find(untouched) != &*map.find(untouched) || map[written] == "changed") {
+		std::cerr << "Write did not copy only its path" << std::endl;
+		return -9;
+	}
+
+	try {
+		map[-1];
+		std::cerr << "Missing key found" << std::endl;
+		return -10;
+	} catch (const std::invalid_argument&) {
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_versioned_avl_map(int argc, char** argv) {
+	versioned_avl_map<int, int> map;
+
+	// Each version holds keys 0 to size - 1, every value twice its key
+	std::atomic<bool> done(false);
+	std::atomic<int> errors(0);
+	std::vector<std::thread> readers;
+
+	for (int t = 0; t < 4; ++t) {
+		readers.emplace_back([&] {
+			size_t last = 0;
+
+			while (!done.load(std::memory_order_relaxed)) {
+				persistent_avl_map<int, int> snapshot = map.snapshot();
+				int expected = 0;
+
+				for (const auto& pair : snapshot) {
+					if (pair.first != expected || pair.second != 2 * expected) {
+						errors.fetch_add(1);
+						break;
+					}
+
+					++expected;
+				}
+
+				// Versions only grow
+				if (static_cast<size_t>(expected) != snapshot.size() || snapshot.size() < last) {
+					errors.fetch_add(1);
+				}
+
+				last = snapshot.size();
+			}
+		});
+	}
+
+	for (int i = 0; i < 3000; ++i) {
+		map.update([i](persistent_avl_map<int, int>& next) {
+			next.insert({ i, -1 });
+			next.insert_or_assign({ i, 2 * i });
+		});
+	}
+
+	done.store(true);
+
+	for (std::thread& reader : readers) {
+		reader.join();
+	}
+
+	if (errors.load() != 0) {
+		std::cerr << errors.load() << " snapshots were inconsistent" << std::endl;
+		return -1;
+	}
+
+	if (map.snapshot().size() != 3000) {
+		std::cerr << "Latest version has " << map.snapshot().size() << " pairs" << std::endl;
+		return -2;
+	}
+
+	if (!map.reclaim() && !map.reclaim()) {
+		std::cerr << "Replaced versions not reclaimed without readers" << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
@@ -0,0 +1,59 @@
+#include "test_common.h"
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "profiler.hpp"
+
+TEST_ENTRYPOINT int test_profiler_stats(int argc, char** argv) {
+	std::vector<double> samples;
+
+	// 1..100 shuffled, the statistics must not depend on the order
+	for (int i = 0; i < 100; ++i) {
+		samples.push_back((i * 37) % 100 + 1);
+	}
+
+	profiler_stats stats = profiler_stats::from_samples(samples);
+
+	if (stats.samples != 100 || stats.min != 1.0 || stats.max != 100.0) {
+		std::cerr << "Incorrect count/min/max " << stats.samples << " "
+		          << stats.min << " " << stats.max << std::endl;
+		return -1;
+	}
+
+	if (stats.median != 50.5 || stats.p99 != 99.0 || stats.mean != 50.5) {
+		std::cerr << "Incorrect median/p99/mean " << stats.median << " "
+		          << stats.p99 << " " << stats.mean << std::endl;
+		return -2;
+	}
+
+	// Sample standard deviation of 1..100
+	if (std::fabs(stats.stddev - 29.011492) > 1e-5) {
+		std::cerr << "Incorrect stddev " << stats.stddev << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_profiler_run(int argc, char** argv) {
+	int calls = 0;
+
+	auto prof = make_profiler([&calls](int amount) { calls += amount; });
+	prof.warmup(3).iterations(10).run(1);
+
+	if (calls != 13) {
+		std::cerr << "Function called " << calls << " times, expected 13" << std::endl;
+		return -1;
+	}
+
+	profiler_stats stats = prof.realtime_stats();
+
+	if (stats.samples != 10 || stats.min < 0.0 || stats.min > stats.max) {
+		std::cerr << "Incorrect samples recorded: " << stats.samples << std::endl;
+		return -2;
+	}
+
+	return 0;
+}
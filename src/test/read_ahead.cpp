@@ -0,0 +1,179 @@
+#include "test_common.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unistd.h>
+
+#include "CSV/CSVFileReader.hpp"
+#include "CSV/CSVStringReader.hpp"
+#include "read_ahead.hpp"
+
+namespace {
+
+/**
+ * @brief Writes text to a new temporary file
+ *
+ * @returns The file's path, empty if it couldn't be written
+ */
+std::string writeTemporary(const std::string& text) {
+	char path[] = "/tmp/pa3_read_ahead_XXXXXX";
+	int fd = ::mkstemp(path);
+
+	if (fd < 0) {
+		return "";
+	}
+
+	::close(fd);
+
+	std::ofstream file(path, std::ios::binary);
+	file << text;
+
+	return file ? path : "";
+}
+
+/**
+ * @brief Reads a whole file block by block
+ */
+std::string readAll(read_ahead& reader, size_t blockSize, bool& sizes) {
+	std::string data;
+	const char* block = nullptr;
+	size_t size = 0;
+
+	sizes = true;
+
+	while (reader.next(block, size)) {
+		// Only the last block may be short
+		if (data.size() + size < reader.file_size() && size != blockSize) {
+			sizes = false;
+		}
+
+		data.append(block, size);
+	}
+
+	return data;
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_read_ahead(int argc, char** argv) {
+	// Sizes around the block boundaries of 4 KiB blocks
+	for (size_t length : { 0, 1, 4095, 4096, 4097, 3 * 4096 + 123, 40000 }) {
+		std::string text;
+
+		for (size_t i = 0; i < length; ++i) {
+			text += static_cast<char>('a' + (i * 7 + i / 4096) % 26);
+		}
+
+		std::string path = writeTemporary(text);
+
+		if (path.empty()) {
+			std::cerr << "Failed to write a temporary file" << std::endl;
+			return -1;
+		}
+
+		// Both with io_uring, where the kernel allows it, and with pread
+		for (bool uring : { true, false }) {
+			read_ahead reader(path, 4096, 3, uring);
+
+			if (!uring && reader.uring()) {
+				std::cerr << "io_uring used when disabled" << std::endl;
+				return -2;
+			}
+
+			bool sizes = false;
+			std::string data = readAll(reader, 4096, sizes);
+
+			if (data != text || reader.file_size() != length) {
+				std::cerr << "Read " << data.size() << " bytes of " << length << (uring ? " with" : " without")
+				          << " io_uring" << std::endl;
+				return -3;
+			}
+
+			if (!sizes) {
+				std::cerr << "Short block before the end of " << length << " bytes" << std::endl;
+				return -4;
+			}
+
+			const char* block = nullptr;
+			size_t size = 0;
+
+			if (reader.next(block, size)) {
+				std::cerr << "Block after the end of the file" << std::endl;
+				return -5;
+			}
+		}
+
+		std::remove(path.c_str());
+	}
+
+	try {
+		read_ahead reader("/nonexistent/pa3_read_ahead");
+		std::cerr << "Missing file opened" << std::endl;
+		return -6;
+	} catch (const std::runtime_error&) {
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_read_ahead_csv_lines(int argc, char** argv) {
+	// Lines longer than a block span several, the last has no line break
+	std::string text = "a,b\n";
+
+	for (int i = 0; i < 3000; ++i) {
+		text += std::to_string(i) + "," + std::string(i % 700, 'x') + "\n";
+	}
+
+	text += "last,row";
+
+	std::string path = writeTemporary(text);
+
+	if (path.empty()) {
+		std::cerr << "Failed to write a temporary file" << std::endl;
+		return -1;
+	}
+
+	// Must match reading the same text through a stream
+	CSV::CSVData fromFile = CSV::CSVFileReader(path).read();
+	CSV::CSVData fromString = CSV::CSVStringReader(text).read();
+
+	std::remove(path.c_str());
+
+	if (fromFile.rows().size() != fromString.rows().size()) {
+		std::cerr << "Read " << fromFile.rows().size() << " rows, expected " << fromString.rows().size() << std::endl;
+		return -2;
+	}
+
+	auto expected = fromString.rows().begin();
+
+	for (const CSV::CSVTuple& row : fromFile.rows()) {
+		auto value = (*expected).begin();
+
+		for (const CSV::CSVValue& cell : row) {
+			bool same = cell.type() == (*value).type() &&
+			            (cell.type() != CSV::CSVValueType::CSVString ||
+			             cell.get<std::string>() == (*value).get<std::string>());
+
+			if (!same) {
+				std::cerr << "Cell differs from reading through a stream" << std::endl;
+				return -3;
+			}
+
+			++value;
+		}
+
+		++expected;
+	}
+
+	try {
+		CSV::CSVFileReader reader("/nonexistent/pa3_read_ahead.csv");
+		std::cerr << "Missing file opened" << std::endl;
+		return -4;
+	} catch (const std::invalid_argument&) {
+	}
+
+	return 0;
+}
@@ -0,0 +1,149 @@
+#include "test_common.h"
+
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "dsa/robin_hood_map.hpp"
+
+using namespace dsa;
+
+TEST_ENTRYPOINT int test_robin_hood_map_insert_find(int argc, char** argv) {
+	robin_hood_map<int, std::string> map;
+
+	for (int i = 0; i < 1000; ++i) {
+		map.insert({ i, std::to_string(i) });
+	}
+
+	if (map.size() != 1000) {
+		std::cerr << "Incorrect size " << map.size() << ", expected 1000" << std::endl;
+		return -1;
+	}
+
+	for (int i = 0; i < 1000; ++i) {
+		if (!map.contains(i) || map[i] != std::to_string(i)) {
+			std::cerr << "Missing or incorrect value for key " << i << std::endl;
+			return -2;
+		}
+	}
+
+	for (int i = 1000; i < 2000; ++i) {
+		if (map.contains(i)) {
+			std::cerr << "Found key " << i << " that was never inserted" << std::endl;
+			return -3;
+		}
+	}
+
+	// Duplicates are not inserted, and do not replace the value
+	if (map.insert({ 5, "five" }).second || map[5] != "5") {
+		std::cerr << "Duplicate key was inserted" << std::endl;
+		return -4;
+	}
+
+	size_t iterated = 0;
+	for (auto it = map.begin(); it != map.end(); ++it) {
+		++iterated;
+	}
+
+	if (iterated != map.size()) {
+		std::cerr << "Iterated " << iterated << " pairs, expected " << map.size() << std::endl;
+		return -5;
+	}
+
+	robin_hood_map<int, std::string> copy(map);
+
+	if (copy.size() != map.size() || copy[999] != "999") {
+		std::cerr << "Copy does not match the original" << std::endl;
+		return -6;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_robin_hood_map_erase(int argc, char** argv) {
+	robin_hood_map<std::string, int> map;
+	map.max_load_factor(0.9);
+
+	for (int i = 0; i < 1000; ++i) {
+		map.insert({ "key" + std::to_string(i), i });
+	}
+
+	for (int i = 0; i < 1000; i += 2) {
+		if (map.erase("key" + std::to_string(i)) != 1) {
+			std::cerr << "Failed to erase key " << i << std::endl;
+			return -1;
+		}
+	}
+
+	for (int i = 0; i < 1000; ++i) {
+		bool expected = (i % 2 != 0);
+
+		if (map.contains("key" + std::to_string(i)) != expected) {
+			std::cerr << "Key " << i << (expected ? " missing" : " not erased") << std::endl;
+			return -2;
+		}
+	}
+
+	// Churn at a constant size, probes must not grow as the table ages
+	for (int i = 1000; i < 100000; ++i) {
+		map.insert({ "key" + std::to_string(i), i });
+		map.erase("key" + std::to_string(i - 1000));
+	}
+
+	if (map.size() != 1000) {
+		std::cerr << "Incorrect size " << map.size() << ", expected 1000" << std::endl;
+		return -3;
+	}
+
+	for (int i = 100000 - 1000; i < 100000; ++i) {
+		if (map["key" + std::to_string(i)] != i) {
+			std::cerr << "Missing key " << i << " after churn" << std::endl;
+			return -4;
+		}
+	}
+
+	// Erasing through iterators visits and removes every pair
+	size_t erased = 0;
+	for (auto it = map.begin(); it != map.end();) {
+		it = map.erase(it);
+		++erased;
+	}
+
+	if (!map.empty() || erased != 1000) {
+		std::cerr << "Erased " << erased << " pairs through iterators, "
+		<< map.size() << " remain" << std::endl;
+		return -5;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_robin_hood_map_load_factor(int argc, char** argv) {
+	robin_hood_map<int, int> map;
+	map.max_load_factor(0.9);
+
+	for (int i = 0; i < 100000; ++i) {
+		map.insert({ i * 7919, i });
+
+		if (map.load_factor() > map.max_load_factor()) {
+			std::cerr << "Load factor " << map.load_factor() << " exceeds maximum" << std::endl;
+			return -1;
+		}
+	}
+
+	// Robin Hood keeps probe distances short even near the maximum
+	if (map.max_probe_distance() > 64) {
+		std::cerr << "Probe distance " << map.max_probe_distance() << " is too long" << std::endl;
+		return -2;
+	}
+
+	for (int i = 0; i < 100000; ++i) {
+		if (map[i * 7919] != i) {
+			std::cerr << "Missing key " << i * 7919 << std::endl;
+			return -3;
+		}
+	}
+
+	return 0;
+}
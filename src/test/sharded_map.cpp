@@ -0,0 +1,203 @@
+#include "test_common.h"
+
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "dsa/hash.hpp"
+#include "dsa/sharded_map.hpp"
+#include "thread_pool.hpp"
+
+using namespace dsa;
+
+namespace {
+
+size_t hash_calls = 0;
+
+/**
+ * @brief std::hash that counts its calls
+ */
+struct counting_hash {
+	size_t operator()(int key) const {
+		++hash_calls;
+		return std::hash<int>{}(key);
+	}
+};
+
+} // namespace
+
+TEST_ENTRYPOINT int test_sharded_map_insert_find(int argc, char** argv) {
+	// A single shard has no shard bits, check it alongside several
+	for (size_t shards : { 1, 3, 16 }) {
+		sharded_map<std::string, int, wyhash> map(shards);
+
+		if (map.shard_count() != (shards == 3 ? 4u : shards)) {
+			std::cerr << "Shard count " << map.shard_count() << " for " << shards << " requested" << std::endl;
+			return -1;
+		}
+
+		for (int i = 0; i < 5000; ++i) {
+			map.insert({ "key" + std::to_string(i), i });
+		}
+
+		for (int i = 0; i < 5000; i += 2) {
+			map.erase("key" + std::to_string(i));
+		}
+
+		if (map.insert({ "key1", -1 }) || map.size() != 2500) {
+			std::cerr << "Incorrect insert or size " << map.size() << std::endl;
+			return -2;
+		}
+
+		for (int i = 0; i < 5000; ++i) {
+			auto it = map.find("key" + std::to_string(i));
+			bool present = i % 2 == 1;
+
+			if ((it != map.end()) != present || (present && it->second != i)) {
+				std::cerr << "Key " << i << (present ? " missing" : " not erased") << std::endl;
+				return -3;
+			}
+		}
+
+		// Iteration visits every pair once, whatever shard it is in
+		std::vector<int> seen(5000, 0);
+		size_t visited = 0;
+
+		for (const auto& pair : map) {
+			++seen[pair.second];
+			++visited;
+		}
+
+		for (int i = 0; i < 5000; ++i) {
+			if (seen[i] != i % 2) {
+				std::cerr << "Key " << i << " iterated " << seen[i] << " times" << std::endl;
+				return -4;
+			}
+		}
+
+		if (visited != map.size()) {
+			std::cerr << "Iterated " << visited << " pairs of " << map.size() << std::endl;
+			return -5;
+		}
+
+		sharded_map<std::string, int, wyhash> copy(map);
+		map.clear();
+
+		if (!map.empty() || map.begin() != map.end() || copy.size() != 2500 || !copy.contains("key4999")) {
+			std::cerr << "Incorrect clear or copy" << std::endl;
+			return -6;
+		}
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_sharded_map_bulk(int argc, char** argv) {
+	thread_pool pool(3);
+
+	// Every key repeats, the first index of each must win
+	const size_t count = 20000;
+	std::vector<std::string> keys;
+
+	for (size_t i = 0; i < count; ++i) {
+		keys.push_back("key" + std::to_string((i * 7919) % (count / 4)));
+	}
+
+	sharded_map<std::string, size_t, wyhash> map;
+
+	std::vector<uint8_t> inserted = map.insert_bulk(pool, count, [&keys](size_t i) -> const std::string& {
+		return keys[i];
+	}, [](size_t i) {
+		return i;
+	});
+
+	sharded_map<std::string, size_t, wyhash> expected(1);
+
+	for (size_t i = 0; i < count; ++i) {
+		if (expected.insert({ keys[i], i }) != (inserted[i] != 0)) {
+			std::cerr << "Index " << i << " inserted differently than one by one" << std::endl;
+			return -1;
+		}
+	}
+
+	if (map.size() != expected.size()) {
+		std::cerr << "Incorrect size " << map.size() << ", expected " << expected.size() << std::endl;
+		return -2;
+	}
+
+	for (const auto& pair : expected) {
+		auto it = map.find(pair.first);
+
+		if (it == map.end() || it->second != pair.second) {
+			std::cerr << "Key " << pair.first << " missing or not its first index" << std::endl;
+			return -3;
+		}
+	}
+
+	// Plain inserts from several threads at once
+	sharded_map<std::string, size_t, wyhash> shared;
+	std::vector<std::thread> writers;
+
+	for (size_t t = 0; t < 4; ++t) {
+		writers.emplace_back([&, t] {
+			for (size_t i = t; i < count; i += 4) {
+				shared.insert({ "key" + std::to_string(i), i });
+			}
+		});
+	}
+
+	for (std::thread& writer : writers) {
+		writer.join();
+	}
+
+	if (shared.size() != count) {
+		std::cerr << "Concurrent inserts kept " << shared.size() << " of " << count << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_sharded_map_spread(int argc, char** argv) {
+	// std::hash of an integer is the integer itself, its high bits zero
+	sharded_map<int, int> map(16);
+
+	for (int key = 0; key < 16000; ++key) {
+		map.insert({ key, key });
+	}
+
+	for (size_t s = 0; s < map.shard_count(); ++s) {
+		size_t size = map.shard(s).size();
+
+		// 1000 each on average
+		if (size < 500 || size > 1500) {
+			std::cerr << "Shard " << s << " holds " << size << " of 16000 small integer keys" << std::endl;
+			return -1;
+		}
+	}
+
+	for (int key = 0; key < 16000; ++key) {
+		if (map[key] != key) {
+			std::cerr << "Key " << key << " not found in its shard" << std::endl;
+			return -2;
+		}
+	}
+
+	// The shard's table reuses the hash that picked the shard
+	sharded_map<int, int, counting_hash> counted(16);
+	hash_calls = 0;
+
+	counted.insert({ 1, 1 });
+	counted.find(1);
+	counted.contains(2);
+	counted[1];
+	counted.erase(1);
+
+	if (hash_calls != 5) {
+		std::cerr << "Hashed " << hash_calls << " times for 5 operations" << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
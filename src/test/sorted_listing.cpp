@@ -0,0 +1,151 @@
+#include "test_common.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CSV/CSVStringReader.hpp"
+#include "inventory/Commands.hpp"
+#include "inventory/Inventory.hpp"
+#include "inventory/SortedListing.hpp"
+
+using namespace inventory;
+
+namespace {
+
+/**
+ * @brief Lists a category by sorting all of it
+ */
+std::vector<size_t> sortedMembers(const Inventory& inventory, size_t category, NumericColumns::Column column,
+                                  bool descending, size_t limit) {
+	const std::vector<double>& values = inventory.columns().column(column);
+	std::vector<size_t> members = inventory.categoryMembers(category);
+
+	auto missing = std::stable_partition(members.begin(), members.end(), [&](size_t pos) { return !std::isnan(values[pos]); });
+
+	std::sort(members.begin(), missing, [&](size_t a, size_t b) {
+		return descending ? (values[a] > values[b] || (values[a] == values[b] && a > b))
+		                  : (values[a] < values[b] || (values[a] == values[b] && a < b));
+	});
+
+	members.resize(std::min(limit, members.size()));
+	return members;
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_sorted_listing(int argc, char** argv) {
+	// Nearly every product is a toy, few are books
+	std::ostringstream csv;
+	std::mt19937 random(13);
+
+	csv << "Uniq Id,Product Name,Category,Selling Price,Rating\n";
+
+	for (size_t i = 0; i < 20000; ++i) {
+		csv << i << ",Product " << i << ',' << (random() % 50 == 0 ? "Books" : "Toys | Games") << ',';
+
+		// Few distinct prices so there are ties, some missing
+		if (random() % 10 != 0) {
+			csv << '$' << (random() % 200) << ".99";
+		}
+
+		csv << ',' << (random() % 5 + 1) << '\n';
+	}
+
+	CSV::CSVStringReader reader(csv.str());
+	Inventory inventory;
+	inventory.load(reader.read());
+
+	bool walked = false;
+	bool selected = false;
+
+	for (const char* name : { "Toys", "Books" }) {
+		size_t category = inventory.findCategory(name);
+
+		for (bool descending : { false, true }) {
+			for (size_t limit : { size_t(1), size_t(10), size_t(100), SortedListing::unlimited }) {
+				SortedListing listing(inventory, category, NumericColumns::price, descending, limit);
+				std::vector<size_t> listed;
+				size_t pos = 0;
+
+				while (listing.next(pos)) {
+					listed.push_back(pos);
+				}
+
+				if (listed != sortedMembers(inventory, category, NumericColumns::price, descending, limit)) {
+					std::cerr << "Incorrect listing of " << name << (descending ? " descending" : "")
+					          << " limited to " << limit << ", " << (listing.walking() ? "walking" : "selecting") << std::endl;
+					return -1;
+				}
+
+				walked |= listing.walking();
+				selected |= !listing.walking();
+			}
+		}
+	}
+
+	if (!walked || !selected) {
+		std::cerr << "Both listing strategies should have been used" << std::endl;
+		return -2;
+	}
+
+	// Adding a product drops the sort orders, listings select instead
+	Product added;
+	added.id = "added";
+	added.category = "Toys";
+	added.price = 0.5;
+	inventory.add(added);
+
+	SortedListing cheapest(inventory, inventory.findCategory("Toys"), NumericColumns::price, false, 1);
+	size_t pos = 0;
+
+	if (cheapest.walking() || !cheapest.next(pos) || inventory.product(pos).id != "added") {
+		std::cerr << "Listing after adding a product is incorrect" << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_sorted_listing_command(int argc, char** argv) {
+	CSV::CSVStringReader reader("Uniq Id,Product Name,Category,Selling Price\n"
+	                            "a,Kite,Toys,$12.99\n"
+	                            "b,Ball,Toys,\n"
+	                            "c,Drum,Toys,$25.00\n"
+	                            "d,Yoyo,Toys,$2.50\n");
+
+	Inventory inventory;
+	inventory.load(reader.read());
+
+	std::ostringstream out;
+	listInventoryCommand(inventory, "Toys order by price desc limit 2", out);
+
+	if (out.str() != "c: Drum\na: Kite\n") {
+		std::cerr << "Unexpected ordered listing: " << out.str() << std::endl;
+		return -1;
+	}
+
+	out.str("");
+	listInventoryCommand(inventory, "Toys order by price", out);
+
+	if (out.str() != "d: Yoyo\na: Kite\nc: Drum\nb: Ball\n") {
+		std::cerr << "Unexpected ascending listing: " << out.str() << std::endl;
+		return -2;
+	}
+
+	out.str("");
+	listInventoryCommand(inventory, "Toys limit 1", out);
+	listInventoryCommand(inventory, "Toys order by colour", out);
+	listInventoryCommand(inventory, "Games order by price", out);
+
+	if (out.str() != "a: Kite\nInvalid order, expected \"order by <column> [asc|desc]\"\nInvalid Category\n") {
+		std::cerr << "Unexpected listing output: " << out.str() << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+#include "test_common.h"
+
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "stats.hpp"
+
+TEST_ENTRYPOINT int test_stats_threads(int argc, char** argv) {
+	if (!stats::enabled()) {
+		return 0;
+	}
+
+	stats::snapshot before = stats::collect();
+
+	std::vector<std::thread> threads;
+
+	// Threads have exited before collecting, their totals must be retained
+	for (int t = 0; t < 4; ++t) {
+		threads.emplace_back([] {
+			for (uint64_t i = 0; i < 1000; ++i) {
+				stats::record(stats::hash_probe_length, i % 8);
+			}
+			stats::increment(stats::rehash_count, 2);
+		});
+	}
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+
+	stats::snapshot after = stats::collect();
+
+	const stats::histogram_snapshot& hist = after.histograms[stats::hash_probe_length];
+	const stats::histogram_snapshot& hist_before = before.histograms[stats::hash_probe_length];
+
+	if (hist.count - hist_before.count != 4000) {
+		std::cerr << "Recorded " << hist.count - hist_before.count << " values, expected 4000" << std::endl;
+		return -1;
+	}
+
+	if (hist.sum - hist_before.sum != 4 * 125 * 28) {
+		std::cerr << "Incorrect sum " << hist.sum - hist_before.sum << std::endl;
+		return -2;
+	}
+
+	if (after.counters[stats::rehash_count] - before.counters[stats::rehash_count] != 8) {
+		std::cerr << "Incorrect counter total" << std::endl;
+		return -3;
+	}
+
+	if (hist.max < 7 || hist.percentile(100.0) < 7) {
+		std::cerr << "Incorrect max " << hist.max << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
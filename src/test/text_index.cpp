@@ -0,0 +1,214 @@
+#include "test_common.h"
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "CSV/CSVStringReader.hpp"
+#include "inventory/Commands.hpp"
+#include "inventory/Inventory.hpp"
+#include "inventory/TextIndex.hpp"
+
+using namespace inventory;
+
+namespace {
+
+const char* vocabulary[] = { "usb", "cable", "charger", "wireless", "battery", "case", "red", "soft", "kids", "toy" };
+const size_t vocabularySize = sizeof(vocabulary) / sizeof(vocabulary[0]);
+
+/**
+ * @brief Random documents, each with a few of the vocabulary words
+ *
+ * Rare words are dropped in at increasing rates so that the lists range
+ * from a handful of documents to many blocks.
+ */
+std::vector<std::string> randomDocuments(size_t count, unsigned seed) {
+	std::mt19937 random(seed);
+	std::vector<std::string> documents(count);
+
+	for (std::string& document : documents) {
+		for (size_t w = 0; w < vocabularySize; ++w) {
+			// Word w appears in roughly 1 in (1 + w * w) documents
+			if (random() % (1 + w * w) == 0) {
+				size_t times = 1 + random() % 3;
+
+				for (size_t t = 0; t < times; ++t) {
+					document += vocabulary[w];
+					document += (random() % 2) ? ", " : " ";
+				}
+			}
+		}
+	}
+
+	return documents;
+}
+
+bool containsWord(const std::string& document, const std::string& word) {
+	std::string::size_type pos = 0;
+
+	while ((pos = document.find(word, pos)) != std::string::npos) {
+		bool begins = (pos == 0 || !isalnum(static_cast<unsigned char>(document[pos - 1])));
+		size_t end = pos + word.size();
+		bool ends = (end == document.size() || !isalnum(static_cast<unsigned char>(document[end])));
+
+		if (begins && ends) {
+			return true;
+		}
+
+		pos = end;
+	}
+
+	return false;
+}
+
+} // namespace
+
+TEST_ENTRYPOINT int test_text_index_queries(int argc, char** argv) {
+	std::vector<std::string> documents = randomDocuments(5000, 7);
+	TextIndex index;
+	index.build(documents, 1);
+
+	// Each query as alternatives of required words, checked against a scan
+	std::vector<std::vector<std::vector<std::string>>> queries = {
+		{ { "usb" } },
+		{ { "usb", "cable" } },
+		{ { "cable", "kids" } },
+		{ { "case", "soft", "toy" } },
+		{ { "toy" }, { "kids" } },
+		{ { "cable", "toy" }, { "charger", "red" } },
+	};
+
+	for (const auto& query : queries) {
+		std::string text;
+		std::vector<size_t> expected;
+
+		for (const auto& clause : query) {
+			text += text.empty() ? "" : " OR ";
+
+			for (const std::string& word : clause) {
+				text += word + " ";
+			}
+		}
+
+		for (size_t doc = 0; doc < documents.size(); ++doc) {
+			for (const auto& clause : query) {
+				if (std::all_of(clause.begin(), clause.end(), [&](const std::string& word) { return containsWord(documents[doc], word); })) {
+					expected.push_back(doc);
+					break;
+				}
+			}
+		}
+
+		std::vector<size_t> found = index.search(text, documents.size());
+		std::sort(found.begin(), found.end());
+
+		if (found != expected) {
+			std::cerr << "Query \"" << text << "\" found " << found.size() << " documents, expected "
+			          << expected.size() << std::endl;
+			return -1;
+		}
+	}
+
+	if (!index.search("usb zebra", 10).empty() || !index.search("", 10).empty()) {
+		std::cerr << "Query with an unknown word matched" << std::endl;
+		return -2;
+	}
+
+	if (index.search("usb", 3).size() != 3) {
+		std::cerr << "Limit not respected" << std::endl;
+		return -3;
+	}
+
+	// The lists are compressed well below the text
+	if (index.indexBytes() * 2 > index.textBytes()) {
+		std::cerr << "Index of " << index.indexBytes() << " bytes for " << index.textBytes()
+		          << " bytes of text" << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_text_index_ranking(int argc, char** argv) {
+	std::vector<std::string> documents = {
+		"a red ball",
+		"red red red shoes",
+		"a blue ball",
+		"red, Ball and a red kite",
+		"",
+	};
+
+	TextIndex index;
+	index.build(documents);
+
+	// More occurrences rank higher, ties by position
+	std::vector<size_t> red = index.search("RED", 10);
+
+	if (red != std::vector<size_t>({ 1, 3, 0 })) {
+		std::cerr << "Unexpected ranking for red" << std::endl;
+		return -1;
+	}
+
+	// Rarer words weigh more, so blue ranks above ball
+	std::vector<size_t> either = index.search("ball OR blue", 10);
+
+	if (either.size() != 3 || either[0] != 2) {
+		std::cerr << "Unexpected ranking for ball OR blue" << std::endl;
+		return -2;
+	}
+
+	// Building on several threads gives the same index
+	std::vector<std::string> many = randomDocuments(3000, 11);
+	TextIndex serial;
+	TextIndex parallel;
+
+	serial.build(many, 1);
+	parallel.build(many, 4);
+
+	if (serial.indexBytes() != parallel.indexBytes() || serial.termCount() != parallel.termCount()
+	    || serial.search("cable OR kids red", 100) != parallel.search("cable OR kids red", 100)) {
+		std::cerr << "Parallel build differs from the serial build" << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_text_index_command(int argc, char** argv) {
+	CSV::CSVStringReader reader("Uniq Id,Product Name,About Product,Product Description\n"
+	                            "a,Kite,\"A red kite for kids\",\n"
+	                            "b,Ball,\"Soft ball\",\"Red and blue, for kids\"\n"
+	                            "c,Cable,USB cable,\n");
+
+	Inventory inventory;
+	inventory.load(reader.read());
+
+	std::ostringstream out;
+	searchTextCommand(inventory, "kids red limit 1", out);
+
+	if (out.str() != "a: Kite\n") {
+		std::cerr << "Unexpected searchText output: " << out.str() << std::endl;
+		return -1;
+	}
+
+	out.str("");
+	searchTextCommand(inventory, "blue OR usb", out);
+
+	if (out.str() != "b: Ball\nc: Cable\n" && out.str() != "c: Cable\nb: Ball\n") {
+		std::cerr << "Unexpected searchText output: " << out.str() << std::endl;
+		return -2;
+	}
+
+	out.str("");
+	searchTextCommand(inventory, "kite usb", out);
+
+	if (out.str() != "No matching products\n") {
+		std::cerr << "Unexpected output for no matches: " << out.str() << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
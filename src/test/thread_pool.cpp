@@ -0,0 +1,169 @@
+#include "test_common.h"
+
+#include <atomic>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+#include "thread_pool.hpp"
+
+TEST_ENTRYPOINT int test_thread_pool_parallel_for(int argc, char** argv) {
+	// Without workers the waiting thread runs everything
+	for (size_t workers : { 0, 1, 3 }) {
+		thread_pool pool(workers);
+
+		std::vector<std::atomic<int>> visits(10007);
+
+		for (std::atomic<int>& visit : visits) {
+			visit = 0;
+		}
+
+		std::vector<size_t> chunkBegins(16, SIZE_MAX);
+
+		pool.parallel_for(0, visits.size(), 16, [&](size_t chunk, size_t begin, size_t end) {
+			chunkBegins[chunk] = begin;
+
+			for (size_t i = begin; i < end; ++i) {
+				++visits[i];
+			}
+		});
+
+		for (size_t i = 0; i < visits.size(); ++i) {
+			if (visits[i] != 1) {
+				std::cerr << "Index " << i << " visited " << visits[i] << " times with " << workers << " workers" << std::endl;
+				return -1;
+			}
+		}
+
+		for (size_t c = 1; c < chunkBegins.size(); ++c) {
+			if (chunkBegins[c] <= chunkBegins[c - 1]) {
+				std::cerr << "Chunks are not in index order" << std::endl;
+				return -2;
+			}
+		}
+
+		// Reduced in chunk order, so concatenation keeps the order too
+		std::vector<size_t> order = pool.parallel_reduce(0, 1000, 7, std::vector<size_t>(),
+			[](size_t begin, size_t end) {
+				std::vector<size_t> indexes(end - begin);
+				std::iota(indexes.begin(), indexes.end(), begin);
+				return indexes;
+			},
+			[](std::vector<size_t> total, std::vector<size_t> chunk) {
+				total.insert(total.end(), chunk.begin(), chunk.end());
+				return total;
+			});
+
+		for (size_t i = 0; i < order.size(); ++i) {
+			if (order[i] != i) {
+				std::cerr << "parallel_reduce reduced out of order" << std::endl;
+				return -3;
+			}
+		}
+
+		if (order.size() != 1000 || pool.chunk_count(5, 8, 0) > 3) {
+			std::cerr << "Unexpected chunking" << std::endl;
+			return -4;
+		}
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_thread_pool_nested(int argc, char** argv) {
+	for (size_t workers : { 0, 2 }) {
+		thread_pool pool(workers);
+		std::atomic<size_t> total(0);
+
+		// Every outer chunk waits for an inner parallel_for, more than there
+		// are threads, which only works if waiting threads run tasks
+		pool.parallel_for(0, 8, 8, [&](size_t, size_t, size_t) {
+			pool.parallel_for(0, 1000, 4, [&](size_t, size_t begin, size_t end) {
+				total += end - begin;
+			});
+		});
+
+		if (total != 8000) {
+			std::cerr << "Nested loops covered " << total << " indexes, expected 8000" << std::endl;
+			return -1;
+		}
+
+		// Fork-join with a group of different tasks
+		task_group group(pool);
+		std::atomic<int> ran(0);
+
+		for (int i = 0; i < 5; ++i) {
+			group.run([&] {
+				task_group inner(pool);
+				inner.run([&] { ++ran; });
+				inner.wait();
+			});
+		}
+
+		group.wait();
+
+		if (ran != 5) {
+			std::cerr << "Group ran " << ran << " tasks, expected 5" << std::endl;
+			return -2;
+		}
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_thread_pool_cancel(int argc, char** argv) {
+	thread_pool pool(0);
+
+	// Nothing runs before waiting without workers, cancelled tasks never do
+	task_group group(pool);
+	std::atomic<int> ran(0);
+
+	for (int i = 0; i < 10; ++i) {
+		group.run([&] { ++ran; });
+	}
+
+	group.cancel();
+	group.wait();
+
+	if (ran != 0 || !group.cancelled()) {
+		std::cerr << "Cancelled tasks ran" << std::endl;
+		return -1;
+	}
+
+	// An exception cancels the rest of the loop and reaches the caller
+	std::atomic<int> chunks(0);
+
+	try {
+		pool.parallel_for(0, 100, 100, [&](size_t chunk, size_t, size_t) {
+			++chunks;
+
+			if (chunk == 1) {
+				throw std::runtime_error("chunk failed");
+			}
+		});
+
+		std::cerr << "Exception was not rethrown" << std::endl;
+		return -2;
+	} catch (const std::runtime_error&) {
+	}
+
+	if (chunks == 100) {
+		std::cerr << "Chunks after the exception were not skipped" << std::endl;
+		return -3;
+	}
+
+	// The pool is still usable afterwards
+	std::atomic<size_t> total(0);
+
+	thread_pool::shared().parallel_for(0, 100, 0, [&](size_t, size_t begin, size_t end) {
+		total += end - begin;
+	});
+
+	if (total != 100) {
+		std::cerr << "Shared pool covered " << total << " indexes, expected 100" << std::endl;
+		return -4;
+	}
+
+	return 0;
+}
@@ -40,3 +40,221 @@ TEST_ENTRYPOINT int test_unordered_map_insert_find(int argc, char** argv) {
 	return 0;
 }
 
+
+TEST_ENTRYPOINT int test_unordered_map_rehash(int argc, char** argv) {
+	unordered_map<int, int> map;
+
+	// Enough pairs to force several rehashes
+	for (int i = 0; i < 1000; ++i) {
+		map.insert({ i, i * 2 });
+	}
+
+	if (map.size() != 1000) {
+		std::cerr << "Incorrect size " << map.size() << ", expected 1000" << std::endl;
+		return -1;
+	}
+
+	for (int i = 0; i < 1000; ++i) {
+		if (!map.contains(i) || map[i] != i * 2) {
+			std::cerr << "Missing or incorrect value for key " << i << std::endl;
+			return -2;
+		}
+	}
+
+	size_t iterated = 0;
+	for (auto it = map.begin(); it != map.end(); ++it) {
+		++iterated;
+	}
+
+	if (iterated != map.size()) {
+		std::cerr << "Iterated " << iterated << " pairs, expected " << map.size() << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_unordered_map_erase(int argc, char** argv) {
+	unordered_map<int, std::string> map;
+
+	for (int i = 0; i < 100; ++i) {
+		map.insert({ i, std::to_string(i) });
+	}
+
+	for (int i = 0; i < 100; i += 2) {
+		if (map.erase(i) != 1) {
+			std::cerr << "Failed to erase key " << i << std::endl;
+			return -1;
+		}
+	}
+
+	for (int i = 0; i < 100; ++i) {
+		bool expected = (i % 2 != 0);
+
+		if (map.contains(i) != expected) {
+			std::cerr << "Key " << i << (expected ? " missing" : " not erased") << std::endl;
+			return -2;
+		}
+	}
+
+	// Reinserting over sentinels must not duplicate keys still in the map
+	for (int i = 0; i < 100; ++i) {
+		map.insert({ i, std::to_string(i) });
+	}
+
+	if (map.size() != 100) {
+		std::cerr << "Incorrect size " << map.size() << ", expected 100" << std::endl;
+		return -3;
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_unordered_map_incremental(int argc, char** argv) {
+	unordered_map<int, int> map;
+	map.incremental_rehash(true);
+
+	bool migrated = false;
+
+	for (int i = 0; i < 5000; ++i) {
+		map.insert({ i, i * 2 });
+
+		// Erase and reinsert while both tables are in use
+		if (i % 7 == 0) {
+			map.erase(i / 2);
+			map.insert({ i / 2, i });
+			map.erase(i / 2);
+		}
+
+		if (!map.migrating()) {
+			continue;
+		}
+
+		migrated = true;
+
+		// Pairs must be visible whichever table they are in
+		size_t iterated = 0;
+		for (const auto& pair : map) {
+			if (!map.contains(pair.first)) {
+				std::cerr << "Iterated key " << pair.first << " not found" << std::endl;
+				return -1;
+			}
+			++iterated;
+		}
+
+		if (iterated != map.size()) {
+			std::cerr << "Iterated " << iterated << " pairs, expected " << map.size() << std::endl;
+			return -2;
+		}
+	}
+
+	if (!migrated) {
+		std::cerr << "Growing never used an incremental rehash" << std::endl;
+		return -3;
+	}
+
+	const unordered_map<int, int> copy(map);
+
+	for (int i = 0; i < 5000; ++i) {
+		bool erased = false;
+		for (int j = i; j < 5000; ++j) {
+			if (j % 7 == 0 && j / 2 == i) {
+				erased = true;
+			}
+		}
+
+		if (copy.contains(i) == erased || (!erased && copy[i] != i * 2)) {
+			std::cerr << "Missing or incorrect value for key " << i << std::endl;
+			return -4;
+		}
+	}
+
+	return 0;
+}
+
+TEST_ENTRYPOINT int test_unordered_map_many(int argc, char** argv) {
+	unordered_map<int, int> map;
+	map.incremental_rehash(true);
+
+	std::vector<int> keys;
+	for (int i = 0; i < 3000; ++i) {
+		keys.push_back(i);
+	}
+
+	// Every key in order, odd keys are never inserted
+	auto check = [&](int inserted) {
+		const unordered_map<int, int>& view = map;
+		std::vector<unordered_map<int, int>::const_iterator> found = view.find_many(keys.data(), keys.size());
+		std::vector<uint8_t> contained = map.contains_many(keys.data(), keys.size());
+
+		for (int key : keys) {
+			bool present = key % 2 == 0 && key / 2 < inserted;
+
+			if ((found[key] != view.end()) != present || (contained[key] != 0) != present) {
+				std::cerr << "Key " << key << (present ? " missing" : " found") << std::endl;
+				return false;
+			}
+
+			if (present && found[key]->second != key / 2) {
+				std::cerr << "Incorrect value for key " << key << std::endl;
+				return false;
+			}
+		}
+
+		return true;
+	};
+
+	bool checkedMigrating = false;
+
+	for (int i = 0; i < 2000; ++i) {
+		map.insert({ i * 2, i });
+
+		// Keys may be in either table
+		if (map.migrating() && !checkedMigrating) {
+			checkedMigrating = true;
+
+			if (!check(i + 1)) {
+				return -1;
+			}
+		}
+	}
+
+	map.incremental_rehash(false);
+
+	if (!checkedMigrating || !check(2000)) {
+		std::cerr << "Lookups failed or never ran mid-migration" << std::endl;
+		return -2;
+	}
+
+	// Values found through the mutable overload can be updated
+	std::vector<unordered_map<int, int>::iterator> found = map.find_many(keys.data(), 10);
+	found[4]->second = -1;
+
+	if (map[4] != -1) {
+		std::cerr << "Update through find_many not visible" << std::endl;
+		return -3;
+	}
+
+	// Every odd key is absent, and each present key is listed twice
+	std::vector<int> erasing;
+	for (int i = 0; i < 1000; ++i) {
+		erasing.push_back(i);
+		erasing.push_back(i);
+	}
+
+	if (map.erase_many(erasing.data(), erasing.size()) != 500 || map.size() != 1500) {
+		std::cerr << "Incorrect erase count or size " << map.size() << std::endl;
+		return -4;
+	}
+
+	for (int key : keys) {
+		bool present = key % 2 == 0 && key >= 1000 && key < 4000;
+
+		if (map.contains(key) != present) {
+			std::cerr << "Key " << key << (present ? " erased" : " not erased") << std::endl;
+			return -5;
+		}
+	}
+
+	return 0;
+}